@@ -0,0 +1,231 @@
+/**
+  ******************************************************************************
+  * @file    sd_cache.c
+  * @brief   SD 卡磁區快取 (write-through LRU)，說明見 sd_cache.h
+  ******************************************************************************
+  */
+
+#include <string.h>
+#include "sd_cache.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define SD_CACHE_SECTOR_SIZE  512U
+
+static SD_CacheStats_TypeDef cacheStats;
+
+#if SD_CACHE_SECTORS > 0
+
+typedef struct
+{
+  DWORD sector;
+  uint32_t stamp;     // 最近使用時間，數值越小越久未用
+  uint8_t valid;
+} SD_CacheEntry_TypeDef;
+
+/* 各類別在 cacheEntry[] 中佔用的範圍 */
+static const uint8_t classBase[SD_CACHE_CLASS_COUNT + 1] =
+{
+  0,
+  SD_CACHE_FAT_SECTORS,
+  SD_CACHE_FAT_SECTORS + SD_CACHE_DIR_SECTORS,
+  SD_CACHE_SECTORS
+};
+
+static SD_CacheEntry_TypeDef cacheEntry[SD_CACHE_SECTORS];
+static uint32_t cacheData[SD_CACHE_SECTORS][SD_CACHE_SECTOR_SIZE / 4];
+static uint32_t cacheClock = 0;
+
+static const BYTE *fsWin = NULL;
+static DWORD fatStart = 0;
+static DWORD fatEnd = 0;      // 第一份 FAT 結尾
+static DWORD mirrorEnd = 0;   // 備份 FAT 結尾，備份只寫不讀，不快取
+
+/* 不快取的磁區以 SD_CACHE_CLASS_COUNT 表示 */
+static SD_CacheClass_TypeDef classify(const BYTE *buff, DWORD sector)
+{
+  if (fsWin == NULL || buff != fsWin)
+  {
+    return SD_CACHE_DATA;
+  }
+  if (sector >= fatStart && sector < fatEnd)
+  {
+    return SD_CACHE_FAT;
+  }
+  if (sector >= fatEnd && sector < mirrorEnd)
+  {
+    return SD_CACHE_CLASS_COUNT;
+  }
+  return SD_CACHE_DIR;
+}
+
+static bool has_budget(SD_CacheClass_TypeDef cls)
+{
+  return cls < SD_CACHE_CLASS_COUNT && classBase[cls] != classBase[cls + 1];
+}
+
+static int find(DWORD sector)
+{
+  for (int i = 0; i < SD_CACHE_SECTORS; i++)
+  {
+    if (cacheEntry[i].valid && cacheEntry[i].sector == sector)
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/**
+  * @brief  在類別範圍內挑選空位，沒有空位時取最久未用者
+  */
+static int victim(SD_CacheClass_TypeDef cls)
+{
+  int pick = -1;
+
+  for (int i = classBase[cls]; i < classBase[cls + 1]; i++)
+  {
+    if (!cacheEntry[i].valid)
+    {
+      return i;
+    }
+    if (pick < 0 || (int32_t)(cacheEntry[i].stamp - cacheEntry[pick].stamp) < 0)
+    {
+      pick = i;
+    }
+  }
+  if (pick >= 0)
+  {
+    cacheStats.evictions++;
+  }
+  return pick;
+}
+
+static void store(int i, const BYTE *buff, DWORD sector)
+{
+  memcpy(cacheData[i], buff, SD_CACHE_SECTOR_SIZE);
+  cacheEntry[i].sector = sector;
+  cacheEntry[i].stamp = ++cacheClock;
+  cacheEntry[i].valid = 1;
+}
+
+void SD_Cache_Attach(const FATFS *fs)
+{
+  SD_Cache_Invalidate();
+  if (fs == NULL || fs->fs_type == 0)
+  {
+    fsWin = NULL;
+    return;
+  }
+  fsWin = fs->win.d8;
+  fatStart = fs->fatbase;
+  fatEnd = fs->fatbase + fs->fsize;
+  mirrorEnd = fs->fatbase + fs->fsize * fs->n_fats;
+}
+
+void SD_Cache_Invalidate(void)
+{
+  memset(cacheEntry, 0, sizeof(cacheEntry));
+}
+
+bool SD_Cache_Read(BYTE *buff, DWORD sector)
+{
+  SD_CacheClass_TypeDef cls = classify(buff, sector);
+  int i;
+
+  if (!has_budget(cls))
+  {
+    return false; // 此類別沒有配額，不計入統計
+  }
+  i = find(sector);
+  if (i < 0)
+  {
+    cacheStats.misses[cls]++;
+    return false;
+  }
+  memcpy(buff, cacheData[i], SD_CACHE_SECTOR_SIZE);
+  cacheEntry[i].stamp = ++cacheClock;
+  cacheStats.hits[cls]++;
+  return true;
+}
+
+void SD_Cache_Fill(const BYTE *buff, DWORD sector, UINT count)
+{
+  SD_CacheClass_TypeDef cls;
+  int i;
+
+  if (count != 1)
+  {
+    return;
+  }
+  cls = classify(buff, sector);
+  if (!has_budget(cls))
+  {
+    return;
+  }
+  i = find(sector);
+  if (i < 0)
+  {
+    i = victim(cls);
+  }
+  if (i >= 0)
+  {
+    store(i, buff, sector);
+  }
+}
+
+void SD_Cache_Update(const BYTE *buff, DWORD sector, UINT count)
+{
+  for (UINT n = 0; n < count; n++)
+  {
+    int i = find(sector + n);
+    if (i >= 0)
+    {
+      store(i, buff + n * SD_CACHE_SECTOR_SIZE, sector + n);
+      cacheStats.writeUpdates++;
+    }
+  }
+
+  // FAT 與目錄磁區寫回後常會再被讀取 (例如配置下一個叢集)
+  if (count == 1 && classify(buff, sector) < SD_CACHE_DATA && find(sector) < 0)
+  {
+    SD_Cache_Fill(buff, sector, 1);
+  }
+}
+
+void SD_Cache_Drop(DWORD sector, UINT count)
+{
+  for (UINT n = 0; n < count; n++)
+  {
+    int i = find(sector + n);
+    if (i >= 0)
+    {
+      cacheEntry[i].valid = 0;
+    }
+  }
+}
+
+#else /* SD_CACHE_SECTORS == 0 */
+
+void SD_Cache_Attach(const FATFS *fs) { (void)fs; }
+void SD_Cache_Invalidate(void) {}
+bool SD_Cache_Read(BYTE *buff, DWORD sector) { (void)buff; (void)sector; return false; }
+void SD_Cache_Fill(const BYTE *buff, DWORD sector, UINT count) { (void)buff; (void)sector; (void)count; }
+void SD_Cache_Update(const BYTE *buff, DWORD sector, UINT count) { (void)buff; (void)sector; (void)count; }
+void SD_Cache_Drop(DWORD sector, UINT count) { (void)sector; (void)count; }
+
+#endif /* SD_CACHE_SECTORS > 0 */
+
+void SD_Cache_GetStats(SD_CacheStats_TypeDef *stats)
+{
+  taskENTER_CRITICAL();
+  *stats = cacheStats;
+  taskEXIT_CRITICAL();
+}
+
+void SD_Cache_ResetStats(void)
+{
+  taskENTER_CRITICAL();
+  memset(&cacheStats, 0, sizeof(cacheStats));
+  taskEXIT_CRITICAL();
+}
@@ -0,0 +1,86 @@
+/**
+  ******************************************************************************
+  * @file    sd_cache.h
+  * @brief   SD 卡磁區快取 (write-through LRU)，位於 FatFs 與 SD_Driver 之間
+  *
+  *          FatFs 只有一個 512 bytes 的視窗 (FATFS.win)，f_lseek、配置叢集
+  *          與 f_readdir 會反覆讀取相同的 FAT 與目錄磁區，每次都是一次完整的
+  *          SD 命令往返。此快取保留最近使用的磁區：
+  *
+  *          - FAT、目錄、資料磁區各有獨立的配額，互不排擠
+  *          - 分類依據：讀入 FATFS.win 且位於 FAT 區者為 FAT，
+  *            其餘讀入 win 者為目錄，讀入其他緩衝區者為資料
+  *          - write-through：寫入一律先寫到卡片，成功後更新快取內容，
+  *            斷電不會遺失資料
+  *          - 只快取單磁區讀寫，多磁區傳輸直接交給驅動 (仍會更新已快取的磁區)
+  *
+  *          所有函式由 sd_diskio 在 FatFs 卷冊鎖內呼叫，不另外上鎖。
+  ******************************************************************************
+  */
+
+#ifndef __SD_CACHE_H
+#define __SD_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ff.h"
+
+/* 各類磁區配額 (每個磁區佔 512 bytes RAM)，全部設為 0 即關閉快取 */
+#define SD_CACHE_FAT_SECTORS   2
+#define SD_CACHE_DIR_SECTORS   2
+#define SD_CACHE_DATA_SECTORS  0
+
+#define SD_CACHE_SECTORS  (SD_CACHE_FAT_SECTORS + SD_CACHE_DIR_SECTORS + SD_CACHE_DATA_SECTORS)
+
+typedef enum
+{
+  SD_CACHE_FAT = 0,
+  SD_CACHE_DIR,
+  SD_CACHE_DATA,
+  SD_CACHE_CLASS_COUNT
+} SD_CacheClass_TypeDef;
+
+typedef struct
+{
+  uint32_t hits[SD_CACHE_CLASS_COUNT];
+  uint32_t misses[SD_CACHE_CLASS_COUNT];
+  uint32_t writeUpdates;   // 寫入時同步更新的已快取磁區數
+  uint32_t evictions;
+} SD_CacheStats_TypeDef;
+
+/**
+  * @brief  指定已掛載的檔案系統，用來辨識 FAT 區與 win 緩衝區
+  * @note   掛載前所有讀取皆視為資料磁區
+  */
+void SD_Cache_Attach(const FATFS *fs);
+
+/**
+  * @brief  捨棄所有快取內容 (卡片重新初始化或更換時)
+  */
+void SD_Cache_Invalidate(void);
+
+/**
+  * @brief  查詢單一磁區，命中時複製到 buff
+  * @retval true 表示命中
+  */
+bool SD_Cache_Read(BYTE *buff, DWORD sector);
+
+/**
+  * @brief  讀取成功後存入快取 (只處理單磁區)
+  */
+void SD_Cache_Fill(const BYTE *buff, DWORD sector, UINT count);
+
+/**
+  * @brief  寫入卡片成功後更新快取；win 的單磁區寫入同時存入快取
+  */
+void SD_Cache_Update(const BYTE *buff, DWORD sector, UINT count);
+
+/**
+  * @brief  寫入失敗時捨棄範圍內的快取 (卡片內容不確定)
+  */
+void SD_Cache_Drop(DWORD sector, UINT count);
+
+void SD_Cache_GetStats(SD_CacheStats_TypeDef *stats);
+void SD_Cache_ResetStats(void);
+
+#endif /* __SD_CACHE_H */
@@ -49,13 +49,37 @@
 #include "ff_gen_drv.h"
 #include "stm32f1xx_hal.h"
 #include "bsp_sdio_sdcard.h"
+#include "sd_diskio.h"
+#include "sd_cache.h"
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "task.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
+#define SD_DMA_TIMEOUT_MS      1000  // 單次 DMA 傳輸完成等待上限
+#define SD_READY_TIMEOUT_MS    1000  // 傳輸前等待卡片就緒上限
+#define SD_PROGRAM_TIMEOUT_MS  5000  // 寫入後等待卡片燒錄完成上限 (規範允許 500ms+)
+#define SD_BLOCK_SIZE          512U
+
 /* Private variables ---------------------------------------------------------*/
 /* Disk status */
 static volatile DSTATUS Stat = STA_NOINIT;
 
+/* DMA 完成通知 */
+static StaticSemaphore_t sdDoneSemBuf;
+static SemaphoreHandle_t sdDoneSem = NULL;
+static volatile uint8_t sdXferError = 0;
+static volatile bool sdDmaEnabled = SD_USE_DMA;
+
+/* 循序寫入預告剩餘磁區數，0 表示未預告 */
+static volatile uint32_t sdSeqWriteRemain = 0;
+
+/* 使用者緩衝區未對齊 4 bytes 時 (DMA 以 word 傳輸) 逐磁區經此轉送 */
+static uint32_t sdBounce[SD_BLOCK_SIZE / 4];
+
+static SD_IoStats_TypeDef sdStats;
+
 /* Private function prototypes -----------------------------------------------*/
 DSTATUS SD_initialize (BYTE);
 DSTATUS SD_status (BYTE);
@@ -67,7 +91,7 @@ DRESULT SD_read (BYTE, BYTE*, DWORD, UINT);
   DRESULT SD_ioctl (BYTE, BYTE, void*);
 #endif  /* _USE_IOCTL == 1 */
   
-const Diskio_drvTypeDef  SD_Driver =
+Diskio_drvTypeDef  SD_Driver =
 {
   SD_initialize,
   SD_status,
@@ -92,6 +116,16 @@ DSTATUS SD_initialize(BYTE lun)
 {
   Stat = STA_NOINIT;
   
+  /* 靜態信號量可在 RTOS 啟動前建立 */
+  if (sdDoneSem == NULL)
+  {
+    sdDoneSem = xSemaphoreCreateBinaryStatic(&sdDoneSemBuf);
+    vQueueAddToRegistry(sdDoneSem, "sdDone");
+  }
+  
+  /* 卡片可能已更換，快取內容不再可信 */
+  SD_Cache_Invalidate();
+  
   /* Configure the uSD device */
   if(BSP_SD_Init() == MSD_OK)
   {
@@ -118,40 +152,231 @@ DSTATUS SD_status(BYTE lun)
   return Stat;
 }
 
+static inline bool sd_rtos_running(void)
+{
+  return xTaskGetSchedulerState() == taskSCHEDULER_RUNNING;
+}
+
+static inline uint32_t sd_cycles(void)
+{
+  return DWT->CYCCNT;
+}
+
 /**
-  * @brief  Reads Sector(s)
-  * @param  lun : not used
-  * @param  *buff: Data buffer to store read data
-  * @param  sector: Sector address (LBA)
-  * @param  count: Number of sectors to read (1..128)
-  * @retval DRESULT: Operation result
+  * @brief  等待卡片回到 transfer 狀態 (寫入燒錄中會保持 busy)
+  * @param  yield: true 時以 vTaskDelay 讓出 CPU，false 時忙等
+  * @retval true 表示卡片就緒
   */
-DRESULT SD_read(BYTE lun, BYTE *buff, DWORD sector, UINT count)
+static bool sd_wait_ready(uint32_t timeoutMs, bool yield)
 {
+  uint32_t startTick = HAL_GetTick();
+
+  while(BSP_SD_GetCardState() != MSD_OK)
+  {
+    if ((HAL_GetTick() - startTick) > timeoutMs)
+    {
+      return false;
+    }
+    if (yield)
+    {
+      vTaskDelay(1);
+    }
+  }
+  return true;
+}
+
+/**
+  * @brief  循序寫入預告期間，多磁區寫入前以 ACMD23 告知本次區塊數
+  * @note   只送出本次實際要寫的數量，多報會讓卡片抹除本次之後的磁區；
+  *         ACMD23 失敗不影響後續 CMD25，僅少了預先抹除
+  */
+static void sd_pre_erase(UINT count)
+{
+  uint32_t remain = sdSeqWriteRemain;
+
+  if (remain == 0 || count < 2)
+  {
+    return;
+  }
+  if (BSP_SD_SetWriteEraseCount(count) == MSD_OK)
+  {
+    sdStats.preErases++;
+  }
+  if (remain != SD_SEQ_WRITE_OPEN)
+  {
+    sdSeqWriteRemain = (remain > count) ? remain - count : 0;
+  }
+}
+
+/**
+  * @brief  輪詢模式讀寫 (RTOS 啟動前或關閉 DMA 時使用)，整段期間 CPU 皆被佔用
+  */
+static DRESULT sd_polling_transfer(bool write, BYTE *buff, DWORD sector, UINT count)
+{
+  uint32_t start = sd_cycles();
+  uint8_t state;
   DRESULT res = RES_ERROR;
-  uint32_t startTick;
 
-  // 設定讀取超時為 1000ms，給予 SD 卡足夠的反應時間
-  const uint32_t READ_TIMEOUT_MS = 20000;
+  if (write)
+  {
+    // 寫入前先確保 SD 卡就緒
+    if (!sd_wait_ready(SD_READY_TIMEOUT_MS, false))
+    {
+      return RES_NOTRDY;
+    }
+    sd_pre_erase(count);
+    state = BSP_SD_WriteBlocks((uint32_t*)buff, (uint32_t)(sector), count, SD_DATATIMEOUT);
+    sdStats.writeCmds++;
+  }
+  else
+  {
+    state = BSP_SD_ReadBlocks((uint32_t*)buff, (uint32_t)(sector), count, SD_DATATIMEOUT);
+    sdStats.readCmds++;
+  }
+
+  if (state == MSD_OK && sd_wait_ready(write ? SD_PROGRAM_TIMEOUT_MS : SD_READY_TIMEOUT_MS, false))
+  {
+    res = RES_OK;
+  }
 
-  if(BSP_SD_ReadBlocks((uint32_t*)buff,
-                       (uint32_t) (sector),
-                       count, SD_DATATIMEOUT) == MSD_OK)
+  sdStats.pollOps++;
+  sdStats.busyCycles += sd_cycles() - start;
+  if (res == RES_OK)
   {
-    startTick = HAL_GetTick();
+    sdStats.pollSectors += count;
+  }
+  return res;
+}
 
-    // 等待 SD 卡狀態回到 Ready
-    while(BSP_SD_GetCardState() != MSD_OK)
+/**
+  * @brief  DMA 模式讀寫，等待期間任務阻塞在信號量上，CPU 可供其他任務使用
+  * @note   buff 須對齊 4 bytes
+  */
+static DRESULT sd_dma_transfer(bool write, BYTE *buff, DWORD sector, UINT count)
+{
+  uint32_t start;
+  uint8_t state;
+
+  if (!sd_wait_ready(SD_READY_TIMEOUT_MS, true))
+  {
+    return RES_NOTRDY;
+  }
+
+  // 清除前次逾時後遲到的通知
+  xSemaphoreTake(sdDoneSem, 0);
+  sdXferError = 0;
+
+  start = sd_cycles();
+  if (write)
+  {
+    sd_pre_erase(count);
+    state = BSP_SD_WriteBlocks_DMA((uint32_t*)buff, (uint32_t)(sector), count);
+    sdStats.writeCmds++;
+  }
+  else
+  {
+    state = BSP_SD_ReadBlocks_DMA((uint32_t*)buff, (uint32_t)(sector), count);
+    sdStats.readCmds++;
+  }
+  if (state != MSD_OK)
+  {
+    sdStats.errors++;
+    HAL_SD_Abort(&uSdHandle);
+    return RES_ERROR;
+  }
+
+  if (xSemaphoreTake(sdDoneSem, pdMS_TO_TICKS(SD_DMA_TIMEOUT_MS)) != pdTRUE)
+  {
+    sdStats.timeouts++;
+    HAL_SD_Abort(&uSdHandle);
+    return RES_ERROR;
+  }
+  if (sdXferError)
+  {
+    sdStats.errors++;
+    HAL_SD_Abort(&uSdHandle);
+    return RES_ERROR;
+  }
+
+  // 寫入後卡片仍在燒錄，讓出 CPU 等待
+  if (!sd_wait_ready(write ? SD_PROGRAM_TIMEOUT_MS : SD_READY_TIMEOUT_MS, true))
+  {
+    sdStats.timeouts++;
+    return RES_ERROR;
+  }
+
+  sdStats.dmaOps++;
+  sdStats.dmaSectors += count;
+  sdStats.freedCycles += sd_cycles() - start;
+  return RES_OK;
+}
+
+static DRESULT sd_transfer(bool write, BYTE *buff, DWORD sector, UINT count)
+{
+  DRESULT res = RES_OK;
+
+  if (!sdDmaEnabled || sdDoneSem == NULL || !sd_rtos_running())
+  {
+    res = sd_polling_transfer(write, buff, sector, count);
+  }
+  else if (((uintptr_t)buff & 3U) == 0U)
+  {
+    res = sd_dma_transfer(write, buff, sector, count);
+  }
+  else
+  {
+    // 未對齊的緩衝區逐磁區經 bounce buffer 轉送
+    for (UINT i = 0; i < count && res == RES_OK; i++)
     {
-      // 使用系統時鐘檢查是否超時，而非依賴 CPU 迴圈次數
-      if ((HAL_GetTick() - startTick) > READ_TIMEOUT_MS)
+      BYTE *p = buff + i * SD_BLOCK_SIZE;
+      if (write)
       {
-        return RES_ERROR;
+        memcpy(sdBounce, p, SD_BLOCK_SIZE);
       }
+      res = sd_dma_transfer(write, (BYTE*)sdBounce, sector + i, 1);
+      if (!write && res == RES_OK)
+      {
+        memcpy(p, sdBounce, SD_BLOCK_SIZE);
+      }
+      sdStats.bounceSectors++;
+    }
+  }
+
+  if (res == RES_OK)
+  {
+    if (write)
+    {
+      sdStats.writeSectors += count;
+    }
+    else
+    {
+      sdStats.readSectors += count;
     }
-    res = RES_OK;
   }
-  
+  return res;
+}
+
+/**
+  * @brief  Reads Sector(s)
+  * @param  lun : not used
+  * @param  *buff: Data buffer to store read data
+  * @param  sector: Sector address (LBA)
+  * @param  count: Number of sectors to read (1..128)
+  * @retval DRESULT: Operation result
+  */
+DRESULT SD_read(BYTE lun, BYTE *buff, DWORD sector, UINT count)
+{
+  DRESULT res;
+
+  if (count == 1 && SD_Cache_Read(buff, sector))
+  {
+    return RES_OK;
+  }
+  res = sd_transfer(false, buff, sector, count);
+  if (res == RES_OK)
+  {
+    SD_Cache_Fill(buff, sector, count);
+  }
   return res;
 }
 
@@ -167,52 +392,36 @@ DRESULT SD_read(BYTE lun, BYTE *buff, DWORD sector, UINT count)
 DRESULT SD_write(BYTE lun, const BYTE *buff, DWORD sector, UINT count)
 {
   DRESULT res = RES_ERROR;
-  uint32_t startTick;
-  uint8_t retryCount = 0;
   const uint8_t MAX_WRITE_RETRIES = 3;
 
-  // 建議將超時設定為 5000ms，SD 卡規範允許寫入最長延遲可達 500ms+
-  const uint32_t WRITE_TIMEOUT_MS = 5000;
-
-  // 寫入前先確保 SD 卡就緒
-  startTick = HAL_GetTick();
-  while(BSP_SD_GetCardState() != MSD_OK)
+  for (uint8_t retryCount = 0; retryCount < MAX_WRITE_RETRIES; retryCount++)
   {
-    if ((HAL_GetTick() - startTick) > 1000)
+    res = sd_transfer(true, (BYTE*)buff, sector, count);
+    if (res == RES_OK)
     {
-      return RES_NOTRDY;
+      break;
     }
-  }
 
-  for (retryCount = 0; retryCount < MAX_WRITE_RETRIES; retryCount++)
-  {
-    if(BSP_SD_WriteBlocks((uint32_t*)buff,
-                          (uint32_t)(sector),
-                          count, SD_DATATIMEOUT) == MSD_OK)
+    // 重試前延遲
+    if (sd_rtos_running())
     {
-      startTick = HAL_GetTick();
-
-      // 等待 SD 卡寫入完成
-      while(BSP_SD_GetCardState() != MSD_OK)
-      {
-        // 檢查是否超時
-        if ((HAL_GetTick() - startTick) > WRITE_TIMEOUT_MS)
-        {
-          break; // 超時，嘗試重試
-        }
-      }
-      
-      if (BSP_SD_GetCardState() == MSD_OK)
-      {
-        res = RES_OK;
-        break;
-      }
+      vTaskDelay(pdMS_TO_TICKS(10 * (retryCount + 1)));
+    }
+    else
+    {
+      HAL_Delay(10 * (retryCount + 1));
     }
-    
-    // 重試前延遲
-    HAL_Delay(10 * (retryCount + 1));
   }
   
+  // write-through：卡片寫入成功才更新快取，失敗時卡片內容不確定
+  if (res == RES_OK)
+  {
+    SD_Cache_Update(buff, sector, count);
+  }
+  else
+  {
+    SD_Cache_Drop(sector, count);
+  }
   return res;
 }
 #endif /* _USE_WRITE == 1 */
@@ -260,6 +469,12 @@ DRESULT SD_ioctl(BYTE lun, BYTE cmd, void *buff)
     res = RES_OK;
     break;
   
+  /* 循序寫入預告 (DWORD)，見 SD_CTRL_SEQ_WRITE_HINT */
+  case SD_CTRL_SEQ_WRITE_HINT :
+    sdSeqWriteRemain = *(DWORD*)buff;
+    res = RES_OK;
+    break;
+  
   default:
     res = RES_PARERR;
   }
@@ -268,5 +483,63 @@ DRESULT SD_ioctl(BYTE lun, BYTE cmd, void *buff)
 }
 #endif /* _USE_IOCTL == 1 */
   
+/**
+  * @brief  DMA 讀取完成 (DMA2 channel 4 中斷)
+  */
+void BSP_SD_ReadCpltCallback(void)
+{
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+  xSemaphoreGiveFromISR(sdDoneSem, &xHigherPriorityTaskWoken);
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/**
+  * @brief  DMA 寫入完成 (SDIO DATAEND 中斷)
+  */
+void BSP_SD_WriteCpltCallback(void)
+{
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+  xSemaphoreGiveFromISR(sdDoneSem, &xHigherPriorityTaskWoken);
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/**
+  * @brief  資料傳輸錯誤 (SDIO 或 DMA 中斷)
+  */
+void BSP_SD_ErrorCallback(void)
+{
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+  sdXferError = 1;
+  xSemaphoreGiveFromISR(sdDoneSem, &xHigherPriorityTaskWoken);
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+void SD_GetIoStats(SD_IoStats_TypeDef *stats)
+{
+  taskENTER_CRITICAL();
+  *stats = sdStats;
+  taskEXIT_CRITICAL();
+}
+
+void SD_ResetIoStats(void)
+{
+  taskENTER_CRITICAL();
+  memset(&sdStats, 0, sizeof(sdStats));
+  taskEXIT_CRITICAL();
+}
+
+void SD_SetDmaEnabled(bool enable)
+{
+  sdDmaEnabled = enable;
+}
+
+bool SD_IsDmaEnabled(void)
+{
+  return sdDmaEnabled;
+}
+
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
 
@@ -50,11 +50,46 @@
 
 
 /* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "ff_gen_drv.h"
+
 /* Exported types ------------------------------------------------------------*/
+/* 讀寫統計，週期數以 DWT 計算 (DWT 由 Estop_Init 啟用) */
+typedef struct {
+  uint32_t readSectors;
+  uint32_t writeSectors;
+  uint32_t dmaOps;         // DMA 傳輸次數
+  uint32_t pollOps;        // 輪詢傳輸次數
+  uint32_t dmaSectors;
+  uint32_t pollSectors;
+  uint32_t bounceSectors;  // 經 bounce buffer 轉送的磁區數
+  uint32_t readCmds;       // 讀取命令數 (CMD17/CMD18)，readSectors / readCmds 為平均每次磁區數
+  uint32_t writeCmds;      // 寫入命令數 (CMD24/CMD25)
+  uint32_t preErases;      // 多磁區寫入前送出 ACMD23 的次數
+  uint32_t timeouts;
+  uint32_t errors;
+  uint64_t busyCycles;     // 輪詢模式佔用 CPU 的週期數
+  uint64_t freedCycles;    // DMA 模式等待期間讓出的週期數
+} SD_IoStats_TypeDef;
+
 /* Exported constants --------------------------------------------------------*/
+#define SD_USE_DMA  1  /* 1: RTOS 啟動後以 DMA + 信號量完成讀寫；0: 一律輪詢 */
+
+/* 自訂 disk_ioctl 命令：預告接下來的循序寫入 (DWORD*，磁區數)
+   期間每次多磁區寫入前以 ACMD23 告知卡片該次的區塊數，讓卡片預先抹除；
+   0 結束預告，SD_SEQ_WRITE_OPEN 表示長度未知，直到以 0 結束 */
+#define SD_CTRL_SEQ_WRITE_HINT  0x80
+#define SD_SEQ_WRITE_OPEN       0xFFFFFFFFUL
+
 /* Exported functions ------------------------------------------------------- */
 extern Diskio_drvTypeDef  SD_Driver;
 
+void SD_GetIoStats(SD_IoStats_TypeDef *stats);
+void SD_ResetIoStats(void);
+void SD_SetDmaEnabled(bool enable);
+bool SD_IsDmaEnabled(void);
+
 #endif /* __SD_DISKIO_H */
 
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -1034,6 +1034,9 @@ FRESULT remove_chain (
 				fs->free_clust++;
 				fs->fsi_flag |= 1;
 			}
+#if _USE_FREE_HOOK
+			ff_free_changed(fs, clst, 1);		/* Notify free cluster accounting */
+#endif
 #if _USE_TRIM
 			if (ecl + 1 == nxt) {	/* Is next cluster contiguous? */
 				ecl = nxt;
@@ -1105,6 +1108,9 @@ DWORD create_chain (	/* 0:No free cluster, 1:Internal error, 0xFFFFFFFF:Disk err
 			fs->free_clust--;
 			fs->fsi_flag |= 1;
 		}
+#if _USE_FREE_HOOK
+		ff_free_changed(fs, ncl, -1);	/* Notify free cluster accounting */
+#endif
 	} else {
 		ncl = (res == FR_DISK_ERR) ? 0xFFFFFFFF : 1;
 	}
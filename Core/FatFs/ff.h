@@ -288,6 +288,11 @@ void ff_memfree (void* mblock);			/* Free memory block */
 #endif
 #endif
 
+/* Free cluster accounting hook (called with the volume locked) */
+#if _USE_FREE_HOOK
+void ff_free_changed (FATFS* fs, DWORD clst, int delta);	/* A cluster was allocated (-1) or freed (+1) */
+#endif
+
 /* Sync functions */
 #if _FS_REENTRANT
 int ff_cre_syncobj (BYTE vol, _SYNC_t* sobj);	/* Create a sync object */
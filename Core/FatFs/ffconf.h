@@ -9,6 +9,8 @@
 / Additional user header to be used  
 /-----------------------------------------------------------------------------*/
 #include "stm32f1xx_hal.h"
+#include "FreeRTOS.h"
+#include "semphr.h"
 
 /*-----------------------------------------------------------------------------/
 / Functions and Buffer Configurations
@@ -203,7 +205,7 @@
 /  disk_ioctl() function. */
 
 
-#define _FS_NOFSINFO            0
+#define _FS_NOFSINFO            1      /* 其他裝置留下的 FSINFO 不可信，開機後由 storage.c 於背景掃描 */
 /* If you need to know correct free space on the FAT32 volume, set bit 0 of this
 /  option, and f_getfree() function at first time after volume mount will force
 /  a full FAT scan. Bit 1 controls the use of last allocated cluster number.
@@ -215,6 +217,13 @@
 */
 
 
+#define _USE_FREE_HOOK          1
+/* The _USE_FREE_HOOK option calls ff_free_changed() whenever a cluster is
+/  allocated or freed, regardless of whether free_clust is valid yet. It lets
+/  a background FAT scan account for changes made while it is running.
+/  (0:Disable or 1:Enable) */
+
+
 
 /*---------------------------------------------------------------------------/
 / System Configurations
@@ -234,7 +243,7 @@
 /  These options have no effect at read-only configuration (_FS_READONLY == 1). */
 
 
-#define	_FS_LOCK                2
+#define	_FS_LOCK                3  /* 上傳檔、列印檔與檔案目錄索引 (fileCatalog.c)；SD 測試與上傳、列印互斥 (sd_bench.c)，不另佔位置 */
 /* The _FS_LOCK option switches file lock feature to control duplicated file open
 /  and illegal operation to open objects. This option must be 0 when _FS_READONLY
 /  is 1.
@@ -246,9 +255,9 @@
 /      lock feature is independent of re-entrancy. */
 
 
-#define _FS_REENTRANT           0
-#define _FS_TIMEOUT             1000
-#define	_SYNC_t                 0
+#define _FS_REENTRANT           1
+#define _FS_TIMEOUT             5000    /* ticks (1 ms)，需涵蓋 SD 卡寫入燒錄的最長等待 */
+#define	_SYNC_t                 SemaphoreHandle_t
 /* The _FS_REENTRANT option switches the re-entrancy (thread safe) of the FatFs
 /  module itself. Note that regardless of this option, file access to different
 /  volume is always re-entrant and volume control functions, f_mount(), f_mkfs()
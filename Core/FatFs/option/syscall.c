@@ -0,0 +1,197 @@
+/*------------------------------------------------------------------------*/
+/* Sample code of OS dependent controls for FatFs                         */
+/* (C)ChaN, 2014                                                          */
+/*   Portions COPYRIGHT 2017 STMicroelectronics                           */
+/*   FreeRTOS static mutex version with contention counters               */
+/*------------------------------------------------------------------------*/
+
+#include <string.h>
+#include "ff.h"
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "task.h"
+#include "option/syscall.h"
+
+
+#if _FS_REENTRANT
+/*-----------------------------------------------------------------------*/
+/* Static sync objects, one per volume                                   */
+/*-----------------------------------------------------------------------*/
+
+static StaticSemaphore_t volMutexBuf[_VOLUMES];
+static SemaphoreHandle_t volMutex[_VOLUMES];
+static FF_LockStats_TypeDef lockStats[_VOLUMES];
+
+/* RTOS 啟動前只有 main() 在執行，不需要也不能阻塞在 mutex 上 */
+static int sched_running (void)
+{
+	return xTaskGetSchedulerState() == taskSCHEDULER_RUNNING;
+}
+
+static FF_LockStats_TypeDef* stats_of (_SYNC_t sobj)
+{
+	for (BYTE vol = 0; vol < _VOLUMES; vol++) {
+		if (volMutex[vol] == sobj) return &lockStats[vol];
+	}
+	return NULL;
+}
+
+
+/*------------------------------------------------------------------------*/
+/* Create a Synchronization Object                                        */
+/*------------------------------------------------------------------------*/
+/* This function is called in f_mount() function to create a new
+/  synchronization object, such as semaphore and mutex. When a 0 is returned,
+/  the f_mount() function fails with FR_INT_ERR.
+/  卸載後重新掛載時沿用同一個靜態 mutex。
+*/
+
+int ff_cre_syncobj (	/* 1:Function succeeded, 0:Could not create the sync object */
+	BYTE vol,			/* Corresponding volume (logical drive number) */
+	_SYNC_t *sobj		/* Pointer to return the created sync object */
+)
+{
+	if (vol >= _VOLUMES) return 0;
+
+	if (volMutex[vol] == NULL) {
+		volMutex[vol] = xSemaphoreCreateMutexStatic(&volMutexBuf[vol]);
+		vQueueAddToRegistry(volMutex[vol], "fatfsVol");
+	}
+	*sobj = volMutex[vol];
+
+	return (int)(*sobj != NULL);
+}
+
+
+/*------------------------------------------------------------------------*/
+/* Delete a Synchronization Object                                        */
+/*------------------------------------------------------------------------*/
+/* This function is called in f_mount() function to delete a synchronization
+/  object that created with ff_cre_syncobj() function. When a 0 is returned,
+/  the f_mount() function fails with FR_INT_ERR.
+/  靜態 mutex 不刪除，留給下次掛載。
+*/
+
+int ff_del_syncobj (	/* 1:Function succeeded, 0:Could not delete due to any error */
+	_SYNC_t sobj		/* Sync object tied to the logical drive to be deleted */
+)
+{
+	return (int)(sobj != NULL);
+}
+
+
+/*------------------------------------------------------------------------*/
+/* Request Grant to Access the Volume                                     */
+/*------------------------------------------------------------------------*/
+/* This function is called on entering file functions to lock the volume.
+/  When a 0 is returned, the file function fails with FR_TIMEOUT.
+*/
+
+int ff_req_grant (	/* 1:Got a grant to access the volume, 0:Could not get a grant */
+	_SYNC_t sobj	/* Sync object to wait */
+)
+{
+	FF_LockStats_TypeDef *st;
+	TickType_t start;
+	TickType_t waited;
+
+	if (!sched_running()) return 1;
+
+	/* 先嘗試不等待取得，失敗才計入爭用 */
+	if (xSemaphoreTake(sobj, 0) == pdTRUE) {
+		st = stats_of(sobj);
+		if (st) st->grants++;
+		return 1;
+	}
+
+	start = xTaskGetTickCount();
+	if (xSemaphoreTake(sobj, _FS_TIMEOUT) != pdTRUE) {
+		st = stats_of(sobj);
+		if (st) {
+			st->contended++;
+			st->timeouts++;
+		}
+		return 0;
+	}
+
+	/* 以下統計在持有 mutex 時更新，不會與其他任務衝突 */
+	waited = xTaskGetTickCount() - start;
+	st = stats_of(sobj);
+	if (st) {
+		st->grants++;
+		st->contended++;
+		st->totalWaitMs += waited * portTICK_PERIOD_MS;
+		if (waited * portTICK_PERIOD_MS > st->maxWaitMs) {
+			st->maxWaitMs = waited * portTICK_PERIOD_MS;
+		}
+	}
+	return 1;
+}
+
+
+/*------------------------------------------------------------------------*/
+/* Release Grant to Access the Volume                                     */
+/*------------------------------------------------------------------------*/
+/* This function is called on leaving file functions to unlock the volume.
+*/
+
+void ff_rel_grant (
+	_SYNC_t sobj	/* Sync object to be signaled */
+)
+{
+	if (!sched_running()) return;
+
+	xSemaphoreGive(sobj);
+}
+
+
+void FF_GetLockStats(BYTE vol, FF_LockStats_TypeDef *stats)
+{
+	if (vol >= _VOLUMES) {
+		memset(stats, 0, sizeof(*stats));
+		return;
+	}
+	taskENTER_CRITICAL();
+	*stats = lockStats[vol];
+	taskEXIT_CRITICAL();
+}
+
+void FF_ResetLockStats(void)
+{
+	taskENTER_CRITICAL();
+	memset(lockStats, 0, sizeof(lockStats));
+	taskEXIT_CRITICAL();
+}
+
+#endif /* _FS_REENTRANT */
+
+
+
+
+#if _USE_LFN == 3	/* LFN with a working buffer on the heap */
+/*------------------------------------------------------------------------*/
+/* Allocate a memory block                                                */
+/*------------------------------------------------------------------------*/
+/* If a NULL is returned, the file function fails with FR_NOT_ENOUGH_CORE.
+*/
+
+void* ff_memalloc (	/* Returns pointer to the allocated memory block */
+	UINT msize		/* Number of bytes to allocate */
+)
+{
+	return pvPortMalloc(msize);	/* Allocate a new memory block from the FreeRTOS heap */
+}
+
+
+/*------------------------------------------------------------------------*/
+/* Free a memory block                                                    */
+/*------------------------------------------------------------------------*/
+
+void ff_memfree (
+	void* mblock	/* Pointer to the memory block to free */
+)
+{
+	vPortFree(mblock);	/* Return the memory block to the FreeRTOS heap */
+}
+
+#endif
@@ -0,0 +1,26 @@
+/*------------------------------------------------------------------------*/
+/* FatFs re-entrancy support for FreeRTOS                                 */
+/*------------------------------------------------------------------------*/
+/* 每個卷冊一個 FreeRTOS mutex (具優先權繼承)，ff.c 在每次 API 呼叫時
+/  透過 ff_req_grant()/ff_rel_grant() 取得與歸還；RTOS 啟動前不上鎖。
+/  另記錄爭用次數，供判斷多任務同時存取 SD 卡的頻率。
+/------------------------------------------------------------------------*/
+
+#ifndef _FF_SYSCALL_H_
+#define _FF_SYSCALL_H_
+
+#include <stdint.h>
+#include "ff.h"
+
+typedef struct {
+	uint32_t grants;        // 成功取得次數
+	uint32_t contended;     // 取得時已被其他任務持有的次數
+	uint32_t timeouts;      // 等待超過 _FS_TIMEOUT (回傳 FR_TIMEOUT) 的次數
+	uint32_t totalWaitMs;   // 爭用時累計等待時間
+	uint32_t maxWaitMs;     // 單次最長等待時間
+} FF_LockStats_TypeDef;
+
+void FF_GetLockStats(BYTE vol, FF_LockStats_TypeDef *stats);
+void FF_ResetLockStats(void);
+
+#endif /* _FF_SYSCALL_H_ */
@@ -71,7 +71,7 @@ void xPortSysTickHandler(void);
 #define configUSE_TRACE_FACILITY                 1
 #define configUSE_16_BIT_TICKS                   0
 #define configUSE_MUTEXES                        1
-#define configQUEUE_REGISTRY_SIZE                8
+#define configQUEUE_REGISTRY_SIZE                12
 #define configUSE_RECURSIVE_MUTEXES              1
 #define configUSE_COUNTING_SEMAPHORES            1
 #define configUSE_PORT_OPTIMISED_TASK_SELECTION  0
@@ -150,6 +150,33 @@ standard names. */
 
 /* USER CODE BEGIN Defines */
 #define  configCHECK_FOR_STACK_OVERFLOW   2
+/* 事件追蹤 hook (traceQUEUE_xxx 等)，TRACE_ENABLE 為 0 時不定義任何 hook */
+#if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
+#include "trace.h"
+#include "taskStats.h"
+
+/* 執行期統計以 DWT 週期計數器為時基，見 taskStats.h */
+#define configGENERATE_RUN_TIME_STATS            1
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() TaskStats_TimerInit()
+#define portGET_RUN_TIME_COUNTER_VALUE()         TASKSTATS_CYCLE_COUNTER
+
+/* 任務建立/刪除/切入：uxTaskNumber 低 8 位元為統計槽位、次 8 位元為事件追蹤編號，
+ * 兩者都在刪除時釋放重用 (uxTCBNumber 只增不減，反覆建立的任務會用完編號) */
+#define TASKNUM_STATS_SLOT(n)                    ((uint32_t) (n) & 0xFFU)
+#define TASKNUM_TRACE_ID(n)                      (((uint32_t) (n) >> 8) & 0xFFU)
+#define traceTASK_CREATE(pxNewTCB)               do {                                  \
+	(pxNewTCB)->uxTaskNumber = TaskStats_TaskCreate() |                                  \
+	                           ((uint32_t) TRACE_TASK_CREATE((pxNewTCB)->pcTaskName) << 8); \
+} while (0)
+#define traceTASK_DELETE(pxTCB)                  do {                                  \
+	TaskStats_TaskDelete(TASKNUM_STATS_SLOT((pxTCB)->uxTaskNumber));                     \
+	TRACE_TASK_DELETE(TASKNUM_TRACE_ID((pxTCB)->uxTaskNumber));                          \
+} while (0)
+#define traceTASK_SWITCHED_IN()                  do {                                  \
+	TaskStats_TaskSwitchedIn(TASKNUM_STATS_SLOT(pxCurrentTCB->uxTaskNumber));            \
+	TRACE_TASK_SWITCHED_IN(TASKNUM_TRACE_ID(pxCurrentTCB->uxTaskNumber));                \
+} while (0)
+#endif
 /* Section where parameter definitions can be added (for instance, to override default ones in FreeRTOS.h) */
 /* USER CODE END Defines */
 
@@ -0,0 +1,77 @@
+/**
+ * @file    boot.h
+ * @brief   開機流程協調
+ *
+ *          原本開機為單一序列 (SD 匯流排重置 → 掛載 → 開機動畫 → HX711 穩定與歸零 →
+ *          目錄索引)，總和數秒後才能連線。改為將各步驟拆成工作，依相依關係
+ *          由少數幾個工作者任務並行執行；完成的步驟設定事件群組中對應的 bit，
+ *          其他任務可等待所需步驟而不必等整個開機流程。
+ *
+ *          GUI 由常駐的 GUI 任務自行初始化，以 Boot_StepBegin/Boot_StepDone 回報。
+ *          每個步驟的開始與結束時間 (開機後 ms) 記錄於時間軸，可由 cReqBoot 查詢。
+ */
+
+#ifndef _BOOT_H_
+#define _BOOT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cmdHandler.h"
+
+#define BOOT_WORKERS             2      // 並行工作者數 (含呼叫 Boot_Run 的任務)
+
+typedef enum {
+	BOOT_STEP_LINK = 0, // ESP32 鏈路、檔案佇列、緊急停止、遙測
+	BOOT_STEP_SD,       // SD 匯流排重置、連線訓練與掛載
+	BOOT_STEP_HX711,    // 秤重模組穩定與歸零
+	BOOT_STEP_CATALOG,  // 檔案目錄索引與剩餘空間統計 (相依 SD)
+	BOOT_STEP_GUI,      // emWin 初始化與第一個畫面
+	BOOT_STEP_COUNT
+} BootStep_TypeDef;
+
+#define BOOT_BIT(step)           (1UL << (step))
+/* 可接受命令與列印所需的步驟；秤重只影響耗材重量，不列入 */
+#define BOOT_READY_MASK          (BOOT_BIT(BOOT_STEP_LINK) | BOOT_BIT(BOOT_STEP_SD) | \
+                                  BOOT_BIT(BOOT_STEP_CATALOG) | BOOT_BIT(BOOT_STEP_GUI))
+
+/**
+ * @brief 建立事件群組，須在其他任務使用 Boot_* 之前 (RTOS 啟動前) 呼叫
+ */
+void Boot_Init(void);
+
+/**
+ * @brief 建立其餘工作者並由呼叫的任務一起執行工作表
+ * @note  呼叫端取不到工作即返回，其他工作者可能仍在執行 SD 或目錄索引；
+ *        時間軸於最後一個步驟完成時輸出。需要特定步驟者以 Boot_WaitSteps
+ *        或 Boot_StorageReady 判斷，不可以 Boot_Run 返回為準。
+ */
+void Boot_Run(void);
+
+void Boot_StepBegin(BootStep_TypeDef step);
+void Boot_StepDone(BootStep_TypeDef step);
+
+bool Boot_IsDone(BootStep_TypeDef step);
+
+/**
+ * @brief SD 卡已掛載且目錄索引已載入
+ * @note  鏈路比 SD 早就緒，存取檔案的命令須先檢查，未就緒時回覆忙碌
+ */
+bool Boot_StorageReady(void);
+
+/**
+ * @brief 等待 mask 中的步驟全部完成
+ * @return 逾時前完成
+ */
+bool Boot_WaitSteps(uint32_t mask, uint32_t timeoutMs);
+
+/**
+ * @brief 已完成的步驟數，供開機畫面顯示進度
+ */
+uint8_t Boot_DoneCount(void);
+
+/**
+ * @brief 命令：回報開機時間軸 cReqBoot
+ */
+void GetBootHandler(const char *args, size_t len, ResStruct_t *_resStruct);
+
+#endif /* _BOOT_H_ */
@@ -5,17 +5,12 @@
 #include <stdbool.h>
 #include <stddef.h>
 
-#define MAX_CMD_COUNT 20	//最大命令數量
 #define MAX_CMD_LEN   40	//單條命令字元數
 #define RESBUF_SIZE   10
 
 //建立或執行命令時錯誤種類枚舉
 typedef enum {
 	CMD_OK = 0, //正常
-	QTY_OVER, //超過命令數量限制
-	NAME_ERR, //命令命名錯誤
-	CALBCK_ERR, //回調函數無效
-	REPEAT_ERR, //命令名稱重複
 	CMD_ERR, //命領無效
 	EXC_ERR //執行錯誤
 } CmdHandlerStat_t;
@@ -32,47 +27,67 @@ typedef struct {
 
 
 /*  回調函數原型定義  */
-typedef void (*CommandCallback)(const char *args, ResStruct_t *_resStruct);
+/*  args 指向命令本身 (不保證以 '\0' 結尾)，len 為命令長度  */
+typedef void (*CommandCallback)(const char *args, size_t len, ResStruct_t *_resStruct);
 
-/**
- *@brief 註冊命令
- * @param cmdName    命令名稱 最常不可超過MAX_CMD_LEN
- * @param callback   實際執行命令的callback func
- * @return           命令註冊狀態
- */
-CmdHandlerStat_t register_command(const char *cmdName, CommandCallback callback);
+/*  命令表項目，命令表由 tools/gen_cmd_table.py 依 cmdList.h 的 CMD_TABLE 產生  */
+typedef struct {
+	const char *cmdName;
+	uint8_t nameLen;
+	CommandCallback callback;
+} Command_Typedef;
 
 /**
  *@brief 執行命令，放在命令處理線程裡
- *		 解析完命令後呼叫實際callback func執行
- * @param cmd		 命令 用空格分割參數
+ *		 以 '<' 之前的命令名稱查雜湊表 (O(1))，找到後呼叫實際callback func執行
+ * @param cmd		 命令 參數以 <> 包住，不需以 '\0' 結尾
+ * @param len		 命令長度
  * @param _resStruct 回傳參數結構體
- * @return			 命令執行狀態
+ * @return			 命令執行狀態，未知命令回傳 CMD_ERR
  */
-CmdHandlerStat_t execute_command(const char *cmd, ResStruct_t *_resStruct);
+CmdHandlerStat_t execute_command(const char *cmd, size_t len, ResStruct_t *_resStruct);
 
 /**
  * @brief 判斷命令是否需要返回值
  * @param cmd
+ * @param len
  * @return
  */
-bool isReqCmd(const char *cmd);
+bool isReqCmd(const char *cmd, size_t len);
 
 /**
  * @brief 判斷是否為合法指令，只檢查命令本身而不檢查參數
  * @param cmd
+ * @param len
  * @return CmdHandlerStat
  */
-CmdHandlerStat_t isValidCmd(const char *cmd);
+CmdHandlerStat_t isValidCmd(const char *cmd, size_t len);
+
+/**
+ * 取得命令中 <> 內參數的位置，不複製資料
+ * @param input: 輸入命令
+ * @param len: 命令長度
+ * @param param: 輸出，指向 input 內的參數起點
+ * @param paramLen: 輸出，參數長度
+ * @return: true 表示成功，false 表示失敗
+ */
+bool get_parameter(const char *input, size_t len, const char **param, size_t *paramLen);
+
+/**
+ * 直接於命令中解析 <> 內的十進位無號整數
+ * @return: true 表示成功，false 表示格式錯誤 (含空白、非數字與超出 uint32_t)
+ */
+bool get_uint_parameter(const char *input, size_t len, uint32_t *value);
 
 /**
- * 從命令字串中提取 <> 內的參數
- * @param input: 輸入命令字串
+ * 從命令中複製 <> 內的參數 (需要 '\0' 結尾字串時使用，例如檔名)
+ * @param input: 輸入命令
+ * @param len: 命令長度
  * @param output: 輸出參數緩衝區
  * @param max_len: 緩衝區最大長度
  * @return: true 表示成功，false 表示失敗
  */
-bool extract_parameter(const char *input, char *output, size_t max_len);
+bool extract_parameter(const char *input, size_t len, char *output, size_t max_len);
 
 #ifdef DEBUG
 void print_all_cmd(void); //印出所有已註冊命令
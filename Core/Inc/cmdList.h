@@ -13,6 +13,11 @@
  * - 若使用查詢命令，系統在相關資料準備完成後，會直接回傳對應參數值。
  * - 例如：向系統發送 `cReqBedTemp`，則系統回傳 `30`，代表熱床溫度為 30 度。
  * - 所有查詢結果均不附帶換行字元 ('\n')。
+ *
+ * 命令表規範：
+ * - 可被執行的命令必須列在 CMD_TABLE 中，編譯時由 tools/gen_cmd_table.py
+ *   產生完美雜湊表 (cmdTable.h)，以 '<' 之前的完整命令名稱精確比對。
+ * - 命令名稱重複會在編譯期報錯，命令之間不再有前綴歧義。
  */
 
 #ifndef INC_COMMAND_LIST_H_
@@ -21,7 +26,7 @@
 /*            命令            */
 #define CMD_WIFI_STATUS         (const char*)"cWifiStatus"        //wifi狀態設定
 #define CMD_CLIENT_STATUS       (const char*)"cClintStatus"       //網頁連接狀況
-#define CMD_Start_Transmisson   (const char*)"cStartTransmission" //開始傳送(檔案)
+#define CMD_Start_Transmisson   (const char*)"cStartTransmission" //開始傳送(檔案)，可附檔案大小 <size> 事先檢查空間
 #define CMD_Transmisson_Over    (const char*)"cTransmissionOver"  //傳送完畢(檔案)
 #define CMD_SET_FILENAME        (const char*)"cSetFilename"       //設置檔名
 #define CMD_Start_To_Print      (const char*)"cStartToPrint"      //開始列印
@@ -39,6 +44,68 @@
 #define CMD_GetFilament_Weight  (const char*)"cReqFilamentWeight" //請求耗材重量
 #define CMD_Emergency_Stop      (const char*)"cEmergencyStop"     //緊急停止
 #define CMD_GET_ALL_FILES       (const char*)"cGetAllFiles"       //獲取SD卡所有檔案
+#define CMD_Get_Status          (const char*)"cReqStatus"         //請求狀態快照 (二進位，見 PC_StatusRecord_TypeDef)
+#define CMD_Set_Telemetry       (const char*)"cSetTelemetry"      //設定遙測推送參數
+#define CMD_Get_Estop_Latency   (const char*)"cReqEstopLatency"   //請求緊急停止延遲 (us)
+#define CMD_List_Files          (const char*)"cListFiles"         //分頁獲取SD卡檔案清單 (見 fileList.h)
+#define CMD_Delete_File         (const char*)"cDeleteFile"        //刪除SD卡檔案
+#define CMD_Rebuild_Catalog     (const char*)"cRebuildCatalog"    //重建檔案目錄索引
+#define CMD_Get_Sd_Stats        (const char*)"cReqSdStats"        //請求SD卡讀寫統計
+#define CMD_Set_Sd_Dma          (const char*)"cSetSdDma"          //切換SD卡DMA模式
+#define CMD_Get_Fs_Lock         (const char*)"cReqFsLock"         //請求檔案系統鎖爭用統計
+#define CMD_Get_Sd_Cache        (const char*)"cReqSdCache"        //請求SD磁區快取命中統計
+#define CMD_Seek_Print          (const char*)"cSeekPrint"         //列印中移動到檔案位置
+#define CMD_Get_Storage         (const char*)"cReqStorage"        //請求SD卡容量與剩餘空間
+#define CMD_Get_Sd_Link         (const char*)"cReqSdLink"         //請求SDIO匯流排協商結果
+#define CMD_Sd_Bench            (const char*)"cSdBench"           //執行SD卡效能與健康檢測 (非同步)
+#define CMD_Get_Boot            (const char*)"cReqBoot"           //請求開機時間軸
+#define CMD_Get_Uart_Tx         (const char*)"cReqUartTx"         //請求UART發送緩衝區統計
+#define CMD_Set_Log_Level       (const char*)"cSetLogLevel"       //設定/查詢各模組日誌等級
+#define CMD_Trace               (const char*)"cTrace"             //事件追蹤控制與輸出
+#define CMD_Get_Task_Stats      (const char*)"cReqTaskStats"      //請求各任務CPU使用率與堆疊統計
+#define CMD_Get_Heap            (const char*)"cReqHeap"           //請求堆積使用與碎片化統計
+
+
+/*            命令表 (命令名稱, 回調函數)            */
+#define CMD_TABLE(X) \
+	X(CMD_WIFI_STATUS,         WifiStatusHandler)        \
+	X(CMD_CLIENT_STATUS,       WebStatusHandler)         \
+	X(CMD_Start_Transmisson,   StartTransmissionHandler) \
+	X(CMD_Transmisson_Over,    TransmissionOverHandler)  \
+	X(CMD_SET_FILENAME,        SetFileNameHandler)       \
+	X(CMD_Start_To_Print,      StartToPrintHandler)      \
+	X(CMD_Pause_Printing,      PausePrintingHandler)     \
+	X(CMD_Stop_printing,       StopPrintingHandler)      \
+	X(CMD_Go_Home,             GoHomeHandler)            \
+	X(CMD_Get_Remainning_time, GetRemainingTimeHandler)  \
+	X(CMD_Get_Progress,        GetProgressHandler)       \
+	X(CMD_Get_Nozzle_Temp,     GetNozzleTempHandler)     \
+	X(CMD_Get_Bed_Temp,        GetBedTempHandler)        \
+	X(CMD_Set_Nozzle_Temp,     SetNozzleTempHandler)     \
+	X(CMD_Set_Bed_Temp,        SetBedTempHandler)        \
+	X(CMD_GetFilament_Weight,  GetFilamentWeightHandler) \
+	X(CMD_Emergency_Stop,      EmergencyStopHandler)     \
+	X(CMD_GET_ALL_FILES,       GetAllFilesHandler)       \
+	X(CMD_Get_Status,          GetStatusHandler)         \
+	X(CMD_Set_Telemetry,       SetTelemetryHandler)      \
+	X(CMD_Get_Estop_Latency,   GetEstopLatencyHandler)   \
+	X(CMD_List_Files,          ListFilesHandler)         \
+	X(CMD_Delete_File,         DeleteFileHandler)        \
+	X(CMD_Rebuild_Catalog,     RebuildCatalogHandler)    \
+	X(CMD_Get_Sd_Stats,        GetSdStatsHandler)        \
+	X(CMD_Set_Sd_Dma,          SetSdDmaHandler)          \
+	X(CMD_Get_Fs_Lock,         GetFsLockHandler)         \
+	X(CMD_Get_Sd_Cache,        GetSdCacheHandler)        \
+	X(CMD_Seek_Print,          SeekPrintHandler)         \
+	X(CMD_Get_Storage,         GetStorageHandler)        \
+	X(CMD_Get_Sd_Link,         GetSdLinkHandler)         \
+	X(CMD_Sd_Bench,            SdBenchHandler)           \
+	X(CMD_Get_Boot,            GetBootHandler)           \
+	X(CMD_Get_Uart_Tx,         GetUartTxHandler)         \
+	X(CMD_Set_Log_Level,       SetLogLevelHandler)       \
+	X(CMD_Trace,               TraceHandler)             \
+	X(CMD_Get_Task_Stats,      GetTaskStatsHandler)      \
+	X(CMD_Get_Heap,            GetHeapStatsHandler)
 
 
 /*            錯誤碼            */
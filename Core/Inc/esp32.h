@@ -32,15 +32,11 @@ extern char ip[15];
 extern bool isWebConnected;
 
 /**
- * @brief 初始化 ESP32 模組，註冊回調函數，並等待直到esp32回報初始化完成
+ * @brief 初始化 ESP32 模組，註冊命令通道並啟動鏈路層接收
+ * @note  命令回調由 cmdList.h 的 CMD_TABLE 於編譯期綁定
  */
 void ESP32_Init(void);
 
-/**
- * @brief 註冊回調函數
- */
-void ESP32_RegCallback(void);
-
 /**
  * @brief 傳回目前 ESP32 狀態
  */
@@ -51,6 +47,24 @@ ESP32_STATE_TypeDef ESP32_GetState(void);
  */
 void ESP32_SetState(ESP32_STATE_TypeDef state);
 
+/**
+ * @brief 由本地 (UI) 送出命令，命令字串會複製到暫存槽後排入命令佇列
+ * @return false 表示暫存槽已滿、佇列已滿或命令過長
+ */
+bool ESP32_PostCommand(const char *cmd);
+
+/**
+ * @brief 開始一個非同步工作，立即經回應通道送出 "job:<id>\n"
+ * @return 工作編號 (不為 0)
+ */
+uint16_t ESP32_JobStart(void);
+
+/**
+ * @brief 經事件通道送出完成事件 "done:<id>:ok|err[:<detail>]\n"
+ * @param jobId 為 0 時不送出
+ */
+void ESP32_JobComplete(uint16_t jobId, bool success, const char *detail);
+
 /**
  * @brief 解析UART資料，DMA中斷觸發
  */
@@ -63,26 +77,26 @@ void ESP32_CmdHandler_Task(void *argument);
 /**
  * @brief 命令 : 處理esp32 wifi狀態
  */
-void WifiStatusHandler(const char *args, ResStruct_t *_resStruct);
+void WifiStatusHandler(const char *args, size_t len, ResStruct_t *_resStruct);
 
 /**
  * @brief 命令 : 處理網頁連接狀態
  */
-void WebStatusHandler(const char *args, ResStruct_t *_resStruct);
+void WebStatusHandler(const char *args, size_t len, ResStruct_t *_resStruct);
 
 /**
  * @brief 命令 : 準備接收dcode
  */
-void StartTransmissionHandler(const char *args, ResStruct_t *_resStruct);
+void StartTransmissionHandler(const char *args, size_t len, ResStruct_t *_resStruct);
 
 /**
- * @brief 命令：傳輸結束（command 觸發器）
+ * @brief 命令：傳輸結束（command 觸發器），非同步，驗證結果以完成事件回報
  */
-void TransmissionOverHandler(const char *args, ResStruct_t *_resStruct);
+void TransmissionOverHandler(const char *args, size_t len, ResStruct_t *_resStruct);
 
 /**
- * @brief 命令： 設定檔名
+ * @brief 命令： 設定檔名並建立接收任務，非同步，開檔結果以完成事件回報
  */
-void SetFileNameHandler(const char *args, ResStruct_t *_resStruct);
+void SetFileNameHandler(const char *args, size_t len, ResStruct_t *_resStruct);
 
 #endif /* _ESP32_H_ */
@@ -0,0 +1,55 @@
+/**
+ * @file    estop.h
+ * @brief   緊急停止快速通道
+ *
+ *          緊急停止不經過命令佇列：鏈路層在 USART2 中斷內辨識
+ *          LINK_CH_ESTOP 封包 (或命令通道中的 cEmergencyStop)，
+ *          直接喚醒最高優先權的緊急停止任務。該任務等 USART3 正在
+ *          傳送的 G-code 行送完，在行邊界插隊寫入 M112 (UART_SendUrgent)，
+ *          不會讓印表機執行被截斷的指令，之後的 G-code 照常排隊送出。
+ *
+ *          延遲以 DWT 週期計數器量測，起點為中斷內辨識到封包，
+ *          終點為最後一個 M112 位元組寫入 USART3 DR。包含等待傳輸中的
+ *          一行送完，250000 bps 下每個位元組 40 us。
+ *          (不含 USART2 IDLE 偵測本身的 1 個字元時間)
+ */
+
+#ifndef _ESTOP_H_
+#define _ESTOP_H_
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "cmdHandler.h"
+
+typedef struct {
+	uint32_t count;       // 觸發次數
+	uint32_t lastCycles;  // 最近一次延遲 (CPU 週期)
+	uint32_t maxCycles;   // 最差延遲 (CPU 週期)
+} EstopStats_TypeDef;
+
+/**
+ * @brief 啟用 DWT 週期計數器、建立緊急停止任務並註冊鏈路通道
+ */
+void Estop_Init(void);
+
+/**
+ * @brief (ISR) 觸發緊急停止
+ */
+void Estop_TriggerFromISR(BaseType_t *pxHigherPriorityTaskWoken);
+
+/**
+ * @brief (任務) 觸發緊急停止
+ */
+void Estop_Trigger(void);
+
+/**
+ * @brief 取得延遲統計
+ */
+void Estop_GetStats(EstopStats_TypeDef *stats);
+
+/**
+ * @brief 命令：請求緊急停止延遲 (us)，回傳 "EstopLatency:<last>,<max>\n"
+ */
+void GetEstopLatencyHandler(const char *args, size_t len, ResStruct_t *_resStruct);
+
+#endif /* _ESTOP_H_ */
@@ -0,0 +1,143 @@
+/**
+ * @file    fileCatalog.h
+ * @brief   SD 卡檔案目錄索引 (catalog)
+ *
+ *          根目錄中每個 G-code 檔案的資訊 (檔名、大小、雜湊、
+ *          預估列印時間、耗材長度、層數) 存放於 SD 卡上的索引檔，
+ *          以固定長度紀錄排列：
+ *
+ *          | CatalogHeader_TypeDef | 紀錄 0 | 紀錄 1 | ... |
+ *
+ *          RAM 中只保留檔名雜湊表 (約 1 KB)，查詢時依雜湊定位紀錄位置，
+ *          只讀取該筆紀錄；清單則依紀錄位置順序讀取，不需走訪目錄。
+ *
+ *          - 上傳完成、刪除檔案時增量更新紀錄
+ *          - 開機時以根目錄特徵值 (檔案數與各檔 SFN/大小/時間) 比對索引檔，
+ *            不一致 (卡片在其他裝置上被修改) 時才重建
+ *
+ *          另以 seekmap.idx 保存最近一次列印檔的 fast-seek 叢集對照表 (CLMT)，
+ *          再次列印同一檔案時不需重新走訪 FAT 鏈。
+ */
+
+#ifndef _FILE_CATALOG_H_
+#define _FILE_CATALOG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ff.h"
+#include "cmdHandler.h"
+
+#define CATALOG_FILE_NAME        "catalog.idx"
+#define CATALOG_MAGIC            0x54414350UL  // "PCAT"
+#define CATALOG_VERSION          1      // 紀錄格式異動時遞增，舊索引檔會被重建
+#define CATALOG_MAX_FILES        128    // 紀錄位置上限
+#define CATALOG_HASH_BUCKETS     256    // 雜湊表大小，須為 2 的冪次且大於 CATALOG_MAX_FILES
+#define CATALOG_HEADER_SCAN      512    // 解析 G-code 檔頭的讀取長度
+#define CATALOG_LOCK_TIMEOUT_MS  1000
+#define CATALOG_UNKNOWN          0xFFFFFFFFUL  // 檔頭沒有該欄位
+#define CATALOG_SEEKMAP_FILE     "seekmap.idx"
+#define CATALOG_SEEKMAP_MAGIC    0x50414D50UL  // "PMAP"
+
+typedef struct {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t recordSize;
+	uint32_t signature;     // 根目錄特徵值
+	uint16_t fileCount;
+	uint16_t slotCount;     // 已使用過的紀錄位置數 (含已刪除的空位)
+} CatalogHeader_TypeDef;
+
+typedef struct {
+	uint8_t used;
+	uint8_t hasHash;        // sha256 是否有效 (經上傳驗證)
+	uint16_t fdate;
+	uint16_t ftime;
+	uint16_t reserved;
+	uint32_t entrySig;      // 此檔案對根目錄特徵值的貢獻
+	uint32_t size;
+	uint32_t printSeconds;  // 預估列印時間 (秒)
+	uint32_t filamentMm;    // 耗材長度 (mm)
+	uint32_t layers;        // 層數
+	uint8_t sha256[32];
+	char name[_MAX_LFN + 1];
+} CatalogRecord_TypeDef;
+
+/**
+ * @brief fast-seek 對照表的檔頭，同時作為比對鍵：任一欄位不同即視為失效
+ */
+typedef struct {
+	uint32_t magic;
+	uint32_t sclust;        // 檔案起始叢集
+	uint32_t size;
+	uint16_t fdate;
+	uint16_t ftime;
+	uint32_t words;         // 對照表長度 (DWORD 數，即 CLMT 第一個元素)
+} CatalogSeekMap_TypeDef;
+
+/**
+ * @brief 載入索引，與根目錄不一致時重建
+ * @note  須在 SD 卡掛載後、RTOS 啟動後呼叫
+ */
+void Catalog_Init(void);
+
+/**
+ * @brief 從 G-code 檔頭解析預估時間、耗材長度與層數，
+ *        找不到的欄位設為 CATALOG_UNKNOWN
+ * @return 至少找到一個欄位
+ */
+bool Catalog_ParseHeader(const char *header, CatalogRecord_TypeDef *rec);
+
+/**
+ * @brief 新增或更新一個檔案的紀錄 (上傳完成後呼叫)
+ * @param sha256Hex 已驗證的雜湊十六進位字串，NULL 表示未知
+ */
+bool Catalog_AddFile(const char *name, const char *sha256Hex);
+
+/**
+ * @brief 刪除 SD 卡上的檔案及其紀錄
+ * @return f_unlink 的結果；檔案已刪除但索引檔更新失敗時回傳該寫入錯誤，
+ *         索引標記為待重建，於下一次存取時重新走訪目錄
+ */
+FRESULT Catalog_DeleteFile(const char *name);
+
+/**
+ * @brief 以檔名查詢紀錄
+ */
+bool Catalog_Lookup(const char *name, CatalogRecord_TypeDef *rec);
+
+/**
+ * @brief 逐筆走訪紀錄的回調函式，回傳 false 停止走訪
+ */
+typedef bool (*CatalogVisitor)(uint32_t slot, const CatalogRecord_TypeDef *rec, void *ctx);
+
+/**
+ * @brief 從位置 slot 起依序走訪有效紀錄 (索引檔只開啟一次)
+ * @return 下次接續的位置，已走訪到最後一筆時回傳 -1，索引無法讀取時回傳 -2
+ */
+int32_t Catalog_ForEach(uint32_t slot, CatalogVisitor visit, void *ctx);
+
+/**
+ * @brief 讀取已保存的 fast-seek 對照表
+ * @param key  magic 以外欄位須填入目前檔案的資訊，words 不需填
+ * @param tbl  成功時填入完整 CLMT，可直接設為 FIL.cltbl
+ * @return 已保存的對照表屬於同一檔案且長度不超過 maxWords
+ */
+bool Catalog_LoadSeekMap(const CatalogSeekMap_TypeDef *key, DWORD *tbl, UINT maxWords);
+
+/**
+ * @brief 保存 fast-seek 對照表 (覆寫前一個檔案的對照表)
+ * @param tbl 已由 f_lseek(CREATE_LINKMAP) 建立的 CLMT
+ */
+bool Catalog_SaveSeekMap(const CatalogSeekMap_TypeDef *key, const DWORD *tbl);
+
+/**
+ * @brief 命令：刪除檔案 cDeleteFile<name>
+ */
+void DeleteFileHandler(const char *args, size_t len, ResStruct_t *_resStruct);
+
+/**
+ * @brief 命令：強制重建索引 cRebuildCatalog
+ */
+void RebuildCatalogHandler(const char *args, size_t len, ResStruct_t *_resStruct);
+
+#endif /* _FILE_CATALOG_H_ */
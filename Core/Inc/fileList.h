@@ -0,0 +1,38 @@
+/**
+ * @file    fileList.h
+ * @brief   SD 卡檔案清單分頁串流
+ *
+ *          清單內容來自檔案目錄索引 (見 fileCatalog.h)，不走訪目錄。
+ *          清單以分頁送出，每頁為若干條目加上一行頁尾摘要，
+ *          多行會合併在同一個回應封包中 (LINK_CH_RSP)：
+ *
+ *          <name>\t<size>\t<YYYY-MM-DD HH:MM>\t<print s>\t<filament mm>\t<layers>\n
+ *          ...
+ *          files:<cursor>:<count>:<next>\n
+ *
+ *          cursor 為索引紀錄位置，next 為下一頁的 cursor，清單結束時為 -1。
+ *          未知的數值欄位以 "-" 表示。檔名可包含空白，欄位以 Tab 分隔。
+ *          索引尚未載入 (開機中) 時回覆 files:booting，讀取失敗時回覆 files:err。
+ */
+
+#ifndef _FILE_LIST_H_
+#define _FILE_LIST_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cmdHandler.h"
+
+#define FILE_LIST_PAGE_SIZE      16     // 每頁最多條目數
+
+/**
+ * @brief 從 cursor 開始送出一頁清單
+ * @return 下一頁的 cursor，清單結束或失敗時回傳 -1
+ */
+int32_t FileList_SendPage(uint32_t cursor);
+
+/**
+ * @brief 命令：分頁讀取檔案清單 cListFiles<cursor>，省略參數時從頭開始
+ */
+void ListFilesHandler(const char *args, size_t len, ResStruct_t *_resStruct);
+
+#endif /* _FILE_LIST_H_ */
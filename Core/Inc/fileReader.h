@@ -0,0 +1,83 @@
+/**
+ * @file    fileReader.h
+ * @brief   循序讀取用的大緩衝區檔案讀取器
+ *
+ *          _FS_TINY 0 時每個 FIL 只有 512 B 磁區緩衝區，f_gets 每讀完一個
+ *          磁區就送出一次 SD 命令。讀取器改以呼叫者提供的緩衝區 (4 位元組
+ *          對齊、長度為磁區的整數倍) 整塊讀取：檔案位置對齊磁區時 f_read
+ *          直接以多磁區讀取 (CMD18) 寫入緩衝區，不經 FIL 視窗。
+ *
+ *          緩衝區內容一律從 size 的整數倍位置開始讀取，size 能整除叢集大小時
+ *          每次補充都在同一叢集內，只需一個命令。
+ *
+ *          讀取器持有檔案位置：使用期間不可直接對同一 FIL 呼叫 f_read/f_lseek，
+ *          須改用 FileReader_Seek。
+ */
+
+#ifndef _FILE_READER_H_
+#define _FILE_READER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ff.h"
+
+#define FILE_READER_BUF_SIZE     4096   // 建議緩衝區長度 (8 個磁區)
+
+typedef struct {
+	FIL *fp;
+	BYTE *buf;
+	UINT size;           // 緩衝區長度
+	UINT len;            // 緩衝區內的有效位元組數
+	UINT pos;            // 下一個要取出的位元組
+	DWORD base;          // buf[0] 對應的檔案位置
+	FRESULT err;
+} FileReader_TypeDef;
+
+/**
+ * @brief 綁定已開啟的檔案與緩衝區，從目前檔案位置開始讀取
+ * @param buf  4 位元組對齊 (SD DMA 以 word 傳輸，未對齊時驅動改走 bounce buffer)
+ * @param size 磁區 (512 B) 的整數倍
+ */
+void FileReader_Init(FileReader_TypeDef *r, FIL *fp, void *buf, UINT size);
+
+/**
+ * @brief 讀取一行，行為同 f_gets：含換行字元，超過 size - 1 時截斷，
+ *        剩下的部分於下次呼叫取得 (_USE_STRFUNC 2 時去除 '\r')
+ * @return line，已無資料或讀取錯誤時回傳 NULL
+ */
+char *FileReader_GetLine(FileReader_TypeDef *r, char *line, UINT size);
+
+/**
+ * @brief 複製之後的最多 n 個位元組但不取出，只看緩衝區內已有的資料
+ *        (緩衝區已讀完時先補充)
+ * @return 實際複製的位元組數
+ */
+UINT FileReader_Peek(FileReader_TypeDef *r, void *dst, UINT n);
+
+/**
+ * @brief 取出緩衝區內剩餘的全部資料 (不複製)，緩衝區已讀完時先補充
+ * @return 位元組數，檔尾或錯誤時為 0
+ */
+UINT FileReader_Chunk(FileReader_TypeDef *r, const BYTE **data);
+
+/**
+ * @brief 移動到檔案位置 ofs，位置仍在緩衝區內時不需讀卡
+ */
+FRESULT FileReader_Seek(FileReader_TypeDef *r, DWORD ofs);
+
+/**
+ * @brief 下一個要取出的位元組的檔案位置 (對應 f_tell)
+ */
+static inline DWORD FileReader_Tell(const FileReader_TypeDef *r) {
+	return r->base + r->pos;
+}
+
+static inline bool FileReader_Eof(const FileReader_TypeDef *r) {
+	return r->pos >= r->len && FileReader_Tell(r) >= f_size(r->fp);
+}
+
+static inline FRESULT FileReader_Error(const FileReader_TypeDef *r) {
+	return r->err;
+}
+
+#endif /* _FILE_READER_H_ */
@@ -14,8 +14,10 @@
 #define SHA256_HASH_SIZE         70
 
 typedef struct {
-	TaskHandle_t ownerTaskHandle;
-	char* hashResult;
+	uint16_t openJobId;                    // 開檔完成事件 (SetFilename)
+	uint16_t overJobId;                    // 驗證完成事件 (TransmissionOver)，0 表示尚未收到
+	char expectedHash[SHA256_HASH_SIZE];   // ESP32 提供的雜湊值
+	char hashResult[SHA256_HASH_SIZE];     // 接收端計算的雜湊值
 } GcodeTaskArgs_t;
 
 
@@ -41,11 +43,9 @@ void Gcode_RxHandler_Task(void *argument);
 void FileTask_Init(void);
 
 /**
- * @brief 計算檔案sha256哈希值
- * @param hashOutput
- * @return
+ * @brief 傳回本次 (或最近一次) 上傳已寫入 SD 卡的位元組數
  */
-void calFileHash(char* hashOutput);
+uint32_t FileTask_GetUploadedBytes(void);
 
 
 #endif //FILETASK_H
@@ -0,0 +1,45 @@
+/**
+ * @file    heapStats.h
+ * @brief   FreeRTOS 堆積 (heap_4) 使用追蹤：呼叫點統計、大小分布、碎片化與工作循環洩漏比對
+ *
+ *          以連結器 --wrap=pvPortMalloc,--wrap=vPortFree 攔截所有配置 (見 CMakeLists.txt)：
+ *          - 呼叫點以「呼叫 pvPortMalloc 的返回位址 + 當時執行的任務」區分，
+ *            位址可用 arm-none-eabi-addr2line -e <韌體.elf> 對應到原始碼行。
+ *            任務堆疊與 TCB 的呼叫點在 tasks.c，由建立它的任務區分。
+ *          - 存活區塊記錄在固定大小的表中 (位址、大小、呼叫點)，不改變配置大小。
+ *          - 配置大小以 2 的冪次分組累計次數。
+ *          - 碎片化比例 = 1 - 最大可用區塊 / 可用總量 (heap_4 的 vPortGetHeapStats)。
+ *
+ *          每次開始上傳或列印前呼叫 HeapStats_JobMark：與上一次標記時的各呼叫點
+ *          存活數比較，增加者以警告輸出並保留供 cReqHeap 查詢。前一個工作的任務
+ *          已結束時兩次標記應相等，持續增加即為洩漏。上傳與列印可以重疊，
+ *          仍有工作任務存活時其 TCB、堆疊等配置必然存在，此時只重設基準不比對。
+ */
+
+#ifndef _HEAP_STATS_H_
+#define _HEAP_STATS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cmdHandler.h"
+
+#define HEAPSTATS_MAX_LIVE       64     // 追蹤的存活區塊數，超過的配置計入 untracked
+#define HEAPSTATS_MAX_SITES      24     // 呼叫點數，超過的併入第 0 項 (other)
+#define HEAPSTATS_TASK_LEN       8      // 呼叫點記錄的任務名稱長度
+#define HEAPSTATS_HIST_BINS      10     // <=16, <=32, ... <=4096, >4096 位元組
+#define HEAPSTATS_MAX_LEAKS      8      // 保留的洩漏比對結果數
+
+/**
+ * @brief 工作循環標記：與上一次標記比對各呼叫點的存活區塊並記錄增加者
+ * @param job     工作名稱 (字串常值)，顯示於報告
+ * @param compare 沒有其他工作任務存活；false 時只重設基準，保留上一次的比對結果
+ */
+void HeapStats_JobMark(const char *job, bool compare);
+
+/**
+ * @brief 命令：cReqHeap 回報堆積摘要、大小分布、各呼叫點與最近一次洩漏比對；
+ *        cReqHeap<mark> 立即做一次標記
+ */
+void GetHeapStatsHandler(const char *args, size_t len, ResStruct_t *_resStruct);
+
+#endif /* _HEAP_STATS_H_ */
@@ -0,0 +1,117 @@
+/**
+ * @file    link.h
+ * @brief   ESP32 <-> STM32 UART 多工封包鏈路層
+ *
+ *          所有 ESP32 與 STM32 間的資料 (命令、回應、檔案、遙測、日誌)
+ *          皆以封包形式在同一條 UART 上傳輸，由通道編號區分：
+ *
+ *          | SOF0 | SOF1 | CH | LEN_L | LEN_H | PAYLOAD ... | CRC_L | CRC_H |
+ *
+ *          - SOF  : 固定 0xA5 0x5A，用於失步後重新同步
+ *          - CH   : 邏輯通道 (LinkChannel_TypeDef)
+ *          - LEN  : PAYLOAD 長度 (little-endian)
+ *          - CRC  : CRC-16/CCITT-FALSE，涵蓋 CH、LEN 與 PAYLOAD
+ *
+ *          接收端在 USART2 IDLE 中斷內直接於 DMA 緩衝區上解析，
+ *          每個封包以 LinkFrame_TypeDef 描述 (指向緩衝區內的 PAYLOAD)
+ *          交給該通道的處理函式，不做任何資料複製。
+ *          處理函式若保留封包，緩衝區的參考計數加一，
+ *          用完後呼叫 Link_ReleaseFrame() 歸還。
+ */
+
+#ifndef _LINK_H_
+#define _LINK_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "FreeRTOS.h"
+#include "usart.h"
+
+#define LINK_SOF0                0xA5
+#define LINK_SOF1                0x5A
+#define LINK_HDR_SIZE            5      // SOF0 + SOF1 + CH + LEN(2)
+#define LINK_CRC_SIZE            2
+#define LINK_OVERHEAD            (LINK_HDR_SIZE + LINK_CRC_SIZE)
+#define LINK_MAX_RX_PAYLOAD      (UART_RX_BUFFER_SIZE - LINK_OVERHEAD)
+#define LINK_MAX_TX_PAYLOAD      (UART_TX_BUFFER_SIZE - 1 - LINK_OVERHEAD)
+
+typedef enum {
+	LINK_CH_CMD = 0, // ESP32 -> STM32 命令字串
+	LINK_CH_RSP,     // STM32 -> ESP32 命令回應
+	LINK_CH_FILE,    // ESP32 -> STM32 上傳檔案資料
+	LINK_CH_TELEM,   // STM32 -> ESP32 遙測資料
+	LINK_CH_LOG,     // 雙向日誌
+	LINK_CH_ESTOP,   // ESP32 -> STM32 緊急停止，於中斷內直接處理 (見 estop.h)
+	LINK_CH_EVENT,   // STM32 -> ESP32 非同步工作完成事件
+	LINK_CH_COUNT
+} LinkChannel_TypeDef;
+
+typedef struct {
+	uartRxBuf_TypeDef *buf; // 封包所在的接收緩衝區，NULL 表示不屬於任何緩衝區
+	const uint8_t *data;    // 指向緩衝區內的 PAYLOAD
+	uint16_t len;
+	uint8_t ch;
+} LinkFrame_TypeDef;
+
+typedef struct {
+	uint32_t rxFrames;      // 成功解析的封包數
+	uint32_t rxCrcErr;      // CRC 錯誤
+	uint32_t rxHdrErr;      // 通道或長度非法
+	uint32_t rxDropped;     // 無處理函式或處理函式拒收
+	uint32_t rxOverflow;    // 單一封包超過緩衝區而被丟棄
+	uint32_t rxPaused;      // 緩衝區池耗盡而暫停接收的次數
+	uint32_t txFrames;
+	uint32_t txErr;
+} LinkStats_TypeDef;
+
+/**
+ * @brief 通道處理函式，於 USART2 中斷內被呼叫
+ * @return true  保留封包，稍後須呼叫 Link_ReleaseFrame()
+ *         false 不保留，函式返回後 PAYLOAD 即失效
+ */
+typedef bool (*LinkRxHandler)(const LinkFrame_TypeDef *frame, BaseType_t *pxHigherPriorityTaskWoken);
+
+extern LinkStats_TypeDef linkStats;
+
+/**
+ * @brief 初始化緩衝區池並啟動 USART2 DMA + IDLE 接收
+ */
+void Link_Init(void);
+
+/**
+ * @brief 註冊通道處理函式，須於 Link_Init() 之前或通道尚無流量時呼叫
+ */
+void Link_SetRxHandler(LinkChannel_TypeDef ch, LinkRxHandler handler);
+
+/**
+ * @brief USART2 IDLE 中斷處理：解析並分派已收到的封包
+ */
+void Link_RxIdleCallback(void);
+
+/**
+ * @brief USART2 錯誤中斷處理：丟棄半包並重新啟動接收
+ */
+void Link_RxErrorCallback(void);
+
+/**
+ * @brief (ISR) 在處理函式內為同一封包再加一個參考，
+ *        供一個封包拆成多個描述分別交給消費者時使用
+ */
+void Link_RetainFrameFromISR(const LinkFrame_TypeDef *frame);
+
+/**
+ * @brief 歸還處理函式所保留的封包
+ */
+void Link_ReleaseFrame(const LinkFrame_TypeDef *frame);
+
+/**
+ * @brief 封裝並以 DMA 傳送一個封包 (執行緒安全)
+ */
+HAL_StatusTypeDef Link_Send(LinkChannel_TypeDef ch, const void *data, uint16_t len);
+
+/**
+ * @brief Link_Send 的字串包裝函式
+ */
+HAL_StatusTypeDef Link_SendString(LinkChannel_TypeDef ch, const char *str);
+
+#endif /* _LINK_H_ */
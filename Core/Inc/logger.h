@@ -0,0 +1,132 @@
+/**
+ * @file    logger.h
+ * @brief   分級日誌前端 (錯誤/警告/資訊/除錯)，輸出走 token 化日誌 (tlog.h)
+ *
+ *          每個原始檔在 include 前指定所屬模組，可另外指定編譯期等級上限：
+ *
+ *            #define LOG_MODULE  FILETASK          // LOG_MODULE_TABLE 中的名稱
+ *            #define LOG_LEVEL   LOG_LEVEL_DEBUG   // 可省略，預設 LOG_BUILD_LEVEL
+ *            #include "logger.h"
+ *
+ *          也可由 CMake 針對單一檔案定義 LOG_LEVEL 提高該模組的詳細程度。
+ *          高於 LOG_LEVEL 的呼叫整個移除 (參數不求值、不產生程式碼與格式字串)；
+ *          其餘呼叫於執行期再與該模組的等級比較，等級可由 cSetLogLevel 調整。
+ *
+ *          DEBUG 建置預設保留全部等級，其他建置只保留警告與錯誤。
+ */
+
+#ifndef _LOGGER_H_
+#define _LOGGER_H_
+
+#include <stdint.h>
+#include "tlog.h"
+#include "cmdHandler.h"
+
+#define LOG_LEVEL_OFF            0
+#define LOG_LEVEL_ERROR          1
+#define LOG_LEVEL_WARN           2
+#define LOG_LEVEL_INFO           3
+#define LOG_LEVEL_DEBUG          4
+
+#ifndef LOG_BUILD_LEVEL
+#ifdef DEBUG
+#define LOG_BUILD_LEVEL          LOG_LEVEL_DEBUG
+#else
+#define LOG_BUILD_LEVEL          LOG_LEVEL_WARN
+#endif
+#endif
+
+#define LOG_RUNTIME_DEFAULT      LOG_LEVEL_INFO   // 開機時各模組的執行期等級
+
+/* 模組名稱：代號與 cSetLogLevel 使用的名稱 (代號會被巨集展開，不可與 CMSIS 周邊名稱如 SDIO 相同) */
+#define LOG_MODULE_TABLE(X)      \
+	X(MAIN,      "main")         \
+	X(BOOT,      "boot")         \
+	X(RTOS,      "rtos")         \
+	X(USART,     "usart")        \
+	X(LINK,      "link")         \
+	X(ESP32,     "esp32")        \
+	X(CMD,       "cmd")          \
+	X(FILETASK,  "filetask")     \
+	X(FILELIST,  "filelist")     \
+	X(CATALOG,   "catalog")      \
+	X(STORAGE,   "storage")      \
+	X(PRINTER,   "printer")      \
+	X(TELEMETRY, "telemetry")    \
+	X(ESTOP,     "estop")        \
+	X(SDCARD,    "sdcard")       \
+	X(FATFS,     "fatfs")        \
+	X(HX711,     "hx711")        \
+	X(LCD,       "lcd")          \
+	X(UI,        "ui")
+
+#define LOG_MOD_ENUM_(id, name)  LOG_MOD_##id,
+typedef enum {
+	LOG_MODULE_TABLE(LOG_MOD_ENUM_)
+	LOG_MOD_COUNT
+} LogModule_TypeDef;
+#undef LOG_MOD_ENUM_
+
+extern volatile uint8_t logLevels[LOG_MOD_COUNT];
+
+/**
+ * @brief 命令：設定或查詢執行期等級 cSetLogLevel<模組=等級>，模組可為 all，
+ *        等級為 0-4 或 off/error/warn/info/debug；不帶參數時只回報目前等級
+ */
+void SetLogLevelHandler(const char *args, size_t len, ResStruct_t *_resStruct);
+
+/* 只用於讓編譯器檢查格式與參數，不會被呼叫 */
+static inline void __attribute__((format(printf, 1, 2))) log_check_(const char *fmt, ...) {
+	(void) fmt;
+}
+
+#define LOG_ENABLED_(lvl)        ((lvl) <= logLevels[TLOG_CAT(LOG_MOD_, LOG_MODULE)])
+#define LOG_EMIT_(lvl, fmt, ...) do {                                                \
+	if (0) {                                                                         \
+		log_check_(fmt, ##__VA_ARGS__);                                              \
+	}                                                                                \
+	if (LOG_ENABLED_(lvl)) {                                                         \
+		TLOG(fmt, ##__VA_ARGS__);                                                    \
+	}                                                                                \
+} while (0)
+#define LOG_DROP_(fmt, ...)      do {                                                \
+	if (0) {                                                                         \
+		log_check_(fmt, ##__VA_ARGS__);                                              \
+	}                                                                                \
+} while (0)
+
+#endif /* _LOGGER_H_ */
+
+/* 以下依各原始檔的 LOG_MODULE / LOG_LEVEL 定義，不受 include guard 限制 */
+#ifndef LOG_MODULE
+#error "define LOG_MODULE before including logger.h"
+#endif
+#ifndef LOG_LEVEL
+#define LOG_LEVEL                LOG_BUILD_LEVEL
+#endif
+
+#undef LOG_E
+#undef LOG_W
+#undef LOG_I
+#undef LOG_D
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_E(fmt, ...)          LOG_EMIT_(LOG_LEVEL_ERROR, "E " fmt, ##__VA_ARGS__)
+#else
+#define LOG_E(fmt, ...)          LOG_DROP_(fmt, ##__VA_ARGS__)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_W(fmt, ...)          LOG_EMIT_(LOG_LEVEL_WARN, "W " fmt, ##__VA_ARGS__)
+#else
+#define LOG_W(fmt, ...)          LOG_DROP_(fmt, ##__VA_ARGS__)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_I(fmt, ...)          LOG_EMIT_(LOG_LEVEL_INFO, "I " fmt, ##__VA_ARGS__)
+#else
+#define LOG_I(fmt, ...)          LOG_DROP_(fmt, ##__VA_ARGS__)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_D(fmt, ...)          LOG_EMIT_(LOG_LEVEL_DEBUG, "D " fmt, ##__VA_ARGS__)
+#else
+#define LOG_D(fmt, ...)          LOG_DROP_(fmt, ##__VA_ARGS__)
+#endif
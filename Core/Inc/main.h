@@ -53,6 +53,7 @@ extern "C" {
 void Error_Handler(void);
 
 /* USER CODE BEGIN EFP */
+void Sanitize_SD_Bus(void);
 
 /* USER CODE END EFP */
 
@@ -35,6 +35,34 @@ typedef enum {
 	PC_ERROR
 } PC_Status_TypeDef;
 
+/*--------狀態快照 (cReqStatus 回應)---------*/
+#define PC_STATUS_TAG        'S'  // 與文字回應區分
+#define PC_STATUS_VERSION    1    // 欄位異動時遞增，ESP32 依版本解析
+
+#define PC_STATUS_FLAG_UPLOADING  (1U << 0)
+#define PC_STATUS_FLAG_PAUSED     (1U << 1)
+#define PC_STATUS_FLAG_WEB        (1U << 2)
+
+/**
+ * @brief 狀態快照，以 little-endian 原樣經回應通道送出
+ * @note  只能在結尾新增欄位，並遞增 PC_STATUS_VERSION
+ */
+typedef struct __attribute__((packed)) {
+	uint8_t tag;            // PC_STATUS_TAG
+	uint8_t version;        // PC_STATUS_VERSION
+	uint8_t pcState;        // PC_Status_TypeDef
+	uint8_t espState;       // ESP32_STATE_TypeDef
+	uint8_t flags;          // PC_STATUS_FLAG_xxx
+	uint8_t nozzleTemp;
+	uint8_t bedTemp;
+	uint8_t progress;       // 列印進度 (%)
+	uint16_t filamentWeight;
+	uint8_t remainHours;
+	uint8_t remainMinutes;
+	uint8_t remainSeconds;
+	uint32_t uploadBytes;   // 目前上傳已寫入位元組數
+} PC_StatusRecord_TypeDef;
+
 // 用於 UART3 中斷回調
 extern SemaphoreHandle_t printerRxSemaphore;
 extern volatile bool printerOkReceived;
@@ -44,11 +72,6 @@ extern volatile uint16_t printerRxLen;
 
 void PC_init(void);
 
-/**
- * @brief 註冊回調函數
- */
-void PC_RegCallback(void);
-
 void PC_Print_Task(void *argument);
 
 PC_Status_TypeDef PC_GetState(void);
@@ -63,6 +86,17 @@ void PC_SetState(PC_Status_TypeDef state);
  */
 void PC_Param_Polling(void);
 
+/**
+ * @brief 填寫狀態快照
+ */
+void PC_GetStatusRecord(PC_StatusRecord_TypeDef *record);
+
+/**
+ * @brief M112 送出後的後續處理：停止列印任務、關閉加熱器
+ * @note  由緊急停止任務呼叫 (見 estop.h)
+ */
+void PC_OnEmergencyStop(void);
+
 /**
  * @brief 查詢印表機溫度 (在背景任務中呼叫，會阻塞)
  */
@@ -80,67 +114,78 @@ void PC_QueryFilamentWeight(void);
 /**
  * @brief 開始列印命令的處理函式
  */
-void StartToPrintHandler(const char *args, ResStruct_t *_resStruct);
+void StartToPrintHandler(const char *args, size_t len, ResStruct_t *_resStruct);
 
 /**
  * @brief 暫停列印命令的處理函式
  */
-void PausePrintingHandler(const char *args, ResStruct_t *_resStruct);
+void PausePrintingHandler(const char *args, size_t len, ResStruct_t *_resStruct);
 
 /**
  * @brief 停止列印命令的處理函式
  */
-void StopPrintingHandler(const char *args, ResStruct_t *_resStruct);
+void StopPrintingHandler(const char *args, size_t len, ResStruct_t *_resStruct);
 
 /**
  * @brief 回到原點命令的處理函式
  */
-void GoHomeHandler(const char *args, ResStruct_t *_resStruct);
+void GoHomeHandler(const char *args, size_t len, ResStruct_t *_resStruct);
 
 /**
  * @brief 請求剩餘列印時間命令的處理函式
  */
-void GetRemainingTimeHandler(const char *args, ResStruct_t *_resStruct);
+void GetRemainingTimeHandler(const char *args, size_t len, ResStruct_t *_resStruct);
 
 /**
  * @brief 請求列印進度命令的處理函式
  */
-void GetProgressHandler(const char *args, ResStruct_t *_resStruct);
+void GetProgressHandler(const char *args, size_t len, ResStruct_t *_resStruct);
 
 /**
  * @brief 請求噴嘴溫度命令的處理函式
  */
-void GetNozzleTempHandler(const char *args, ResStruct_t *_resStruct);
+void GetNozzleTempHandler(const char *args, size_t len, ResStruct_t *_resStruct);
 
 /**
  * @brief 請求熱床溫度命令的處理函式
  */
-void GetBedTempHandler(const char *args, ResStruct_t *_resStruct);
+void GetBedTempHandler(const char *args, size_t len, ResStruct_t *_resStruct);
 
 /**
  * @brief 設置噴嘴溫度命令的處理函式
  */
-void SetNozzleTempHandler(const char *args, ResStruct_t *_resStruct);
+void SetNozzleTempHandler(const char *args, size_t len, ResStruct_t *_resStruct);
 
 /**
  * @brief 設置熱床溫度命令的處理函式
  */
-void SetBedTempHandler(const char *args, ResStruct_t *_resStruct);
+void SetBedTempHandler(const char *args, size_t len, ResStruct_t *_resStruct);
 
 /**
  * @brief 請求耗材重量命令的處理函式
  */
-void GetFilamentWeightHandler(const char *args, ResStruct_t *_resStruct);
+void GetFilamentWeightHandler(const char *args, size_t len, ResStruct_t *_resStruct);
 
 /**
  * @brief 緊急停止命令的處理函式
  */
-void EmergencyStopHandler(const char *args, ResStruct_t *_resStruct);
+void EmergencyStopHandler(const char *args, size_t len, ResStruct_t *_resStruct);
 
 /**
  * @brief 獲取SD卡所有檔案命令的處理函式
  */
-void GetAllFilesHandler(const char *args, ResStruct_t *_resStruct);
+void GetAllFilesHandler(const char *args, size_t len, ResStruct_t *_resStruct);
+
+/**
+ * @brief 請求狀態快照命令的處理函式，以單一封包回傳 PC_StatusRecord_TypeDef
+ */
+void GetStatusHandler(const char *args, size_t len, ResStruct_t *_resStruct);
+
+/**
+ * @brief 列印中移動到檔案位置 cSeekPrint<offset> (續印、跳層、預覽拖曳)
+ * @note  從 offset 所在行的下一行開始送出；已建立 fast-seek 對照表時為常數時間
+ */
+void SeekPrintHandler(const char *args, size_t len, ResStruct_t *_resStruct);
 
 
 #ifdef __cplusplus
@@ -0,0 +1,53 @@
+/**
+ * @file    storage.h
+ * @brief   SD 卡剩餘空間統計
+ *
+ *          大容量 FAT32 卡的 FSINFO 不可信 (_FS_NOFSINFO)，f_getfree 需掃描
+ *          整個 FAT (32 GB 卡約 8192 個磁區)，期間佔住卷冊鎖達數秒。
+ *          改為開機後由低優先權任務分批掃描，每批只短暫持有卷冊鎖；
+ *          掃描期間已掃過區域的配置與釋放由 ff_free_changed() 記錄，
+ *          完成後寫入 FATFS.free_clust，之後由 FatFs 自行增減。
+ */
+
+#ifndef _STORAGE_H_
+#define _STORAGE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cmdHandler.h"
+
+#define STORAGE_SCAN_BATCH       4      // 每次持有卷冊鎖讀取的 FAT 磁區數
+#define STORAGE_RESERVE_CLUSTERS 1      // 上傳前預留給目錄成長的叢集數
+
+typedef enum {
+	STORAGE_FITS = 0,
+	STORAGE_NO_SPACE,
+	STORAGE_UNKNOWN      // 尚未統計完成
+} StorageFit_TypeDef;
+
+typedef struct {
+	bool ready;          // 剩餘空間已統計完成
+	uint32_t totalKB;
+	uint32_t freeKB;
+	uint32_t clusterKB;
+	uint32_t scanMs;     // 背景掃描耗時
+} StorageInfo_TypeDef;
+
+/**
+ * @brief 建立背景掃描任務，須在檔案系統掛載、RTOS 啟動後呼叫
+ */
+void Storage_Init(void);
+
+void Storage_GetInfo(StorageInfo_TypeDef *info);
+
+/**
+ * @brief 判斷寫入 bytes 位元組的新檔案是否放得下
+ */
+StorageFit_TypeDef Storage_CheckFits(uint32_t bytes);
+
+/**
+ * @brief 命令：回報容量與剩餘空間 cReqStorage
+ */
+void GetStorageHandler(const char *args, size_t len, ResStruct_t *_resStruct);
+
+#endif /* _STORAGE_H_ */
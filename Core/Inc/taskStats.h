@@ -0,0 +1,71 @@
+/**
+ * @file    taskStats.h
+ * @brief   各任務 CPU 使用率、堆疊高水位與切換次數 (滑動視窗)
+ *
+ *          FreeRTOS 執行期統計以 DWT 週期計數器為時基 (1 個核心時脈一單位)，
+ *          預設任務每 TASKSTATS_PERIOD_MS 取樣一次，以最近 TASKSTATS_WINDOW 次取樣的
+ *          差值計算視窗內的 CPU 百分比與切換次數。計數器為 32 位元約 60 秒溢位，
+ *          差值取模計算，視窗須小於一次溢位。
+ *
+ *          切換次數由 traceTASK_SWITCHED_IN 依任務的統計槽位累加，槽位在任務建立時
+ *          配置並存入 TCB 的 uxTaskNumber 低 8 位元 (見 FreeRTOSConfig.h)，刪除時釋放。
+ *
+ *          本檔會被 FreeRTOSConfig.h 引入，不可 include FreeRTOS 標頭。
+ */
+
+#ifndef _TASK_STATS_H_
+#define _TASK_STATS_H_
+
+#include <stdint.h>
+#include "cmdHandler.h"
+
+#define TASKSTATS_MAX_TASKS      16     // 統計槽位數，超過的任務不列入 (槽位 0 保留)
+#define TASKSTATS_PERIOD_MS      1000
+#define TASKSTATS_WINDOW         5      // 視窗取樣數，視窗長度 = PERIOD * WINDOW
+#define TASKSTATS_NAME_LEN       16     // 同 configMAX_TASK_NAME_LEN
+
+/* DWT_CYCCNT，FreeRTOS 核心原始檔未引入 CMSIS 標頭，直接以位址讀取 */
+#define TASKSTATS_CYCLE_COUNTER  (*(volatile uint32_t *) 0xE0001004UL)
+
+typedef struct {
+	char name[TASKSTATS_NAME_LEN];
+	uint16_t cpuPermille;    // 視窗內 CPU 使用率 (千分比)
+	uint16_t stackFree;      // 堆疊高水位 (歷來最少剩餘，位元組)
+	uint32_t switches;       // 視窗內被切入的次數
+	uint8_t priority;
+	char state;              // R 執行 / r 就緒 / B 阻塞 / S 暫停 / D 刪除中
+} TaskStatsEntry_TypeDef;
+
+typedef struct {
+	uint32_t windowMs;       // 實際視窗長度 (開機初期不足 TASKSTATS_WINDOW 次取樣)
+	uint32_t switches;       // 視窗內總切換次數
+	uint8_t count;
+	TaskStatsEntry_TypeDef task[TASKSTATS_MAX_TASKS];
+} TaskStats_TypeDef;
+
+/**
+ * @brief 啟用 DWT 週期計數器，由 portCONFIGURE_TIMER_FOR_RUN_TIME_STATS 呼叫
+ */
+void TaskStats_TimerInit(void);
+
+/* FreeRTOS hook 使用，於核心臨界區或 PendSV 中呼叫 */
+uint32_t TaskStats_TaskCreate(void);
+void TaskStats_TaskDelete(uint32_t slot);
+void TaskStats_TaskSwitchedIn(uint32_t slot);
+
+/**
+ * @brief 取樣並更新統計結果，由預設任務每 TASKSTATS_PERIOD_MS 呼叫一次
+ */
+void TaskStats_Sample(void);
+
+/**
+ * @brief 複製最近一次的統計結果 (依 CPU 使用率由高到低排序)
+ */
+void TaskStats_Get(TaskStats_TypeDef *out);
+
+/**
+ * @brief 命令：回報各任務統計 cReqTaskStats，第一行為摘要，之後每個任務一行
+ */
+void GetTaskStatsHandler(const char *args, size_t len, ResStruct_t *_resStruct);
+
+#endif /* _TASK_STATS_H_ */
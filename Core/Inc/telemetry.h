@@ -0,0 +1,70 @@
+/**
+ * @file    telemetry.h
+ * @brief   主動推送遙測資料給 ESP32 (差量編碼)
+ *
+ *          遙測任務定期取樣狀態快照 (PC_StatusRecord_TypeDef)，
+ *          與上次送出的值比較，只有超過門檻的欄位才會被送出；
+ *          超過心跳間隔未送出任何資料時，送出包含全部欄位的完整封包。
+ *
+ *          遙測通道 (LINK_CH_TELEM) 封包內容：
+ *
+ *          | SEQ (1) | MASK (2, LE) | 依 bit 順序排列的欄位 ... |
+ *
+ *          MASK 的 bit 與 TelemetryField_TypeDef 對應，欄位寬度與
+ *          PC_StatusRecord_TypeDef 中對應成員相同 (little-endian)。
+ */
+
+#ifndef _TELEMETRY_H_
+#define _TELEMETRY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cmdHandler.h"
+
+/*            預設值 (可由 cSetTelemetry 於執行期調整)            */
+#define TELEM_SAMPLE_PERIOD_MS   200    // 取樣週期
+#define TELEM_HEARTBEAT_MS       5000   // 最長未送出間隔，到期送出完整封包
+#define TELEM_TEMP_DELTA         1      // 溫度門檻 (°C)
+#define TELEM_WEIGHT_DELTA       2      // 耗材重量門檻 (g)
+#define TELEM_UPLOAD_DELTA       4096   // 上傳位元組門檻
+
+typedef enum {
+	TELEM_FIELD_PC_STATE = 0,
+	TELEM_FIELD_ESP_STATE,
+	TELEM_FIELD_FLAGS,
+	TELEM_FIELD_NOZZLE_TEMP,
+	TELEM_FIELD_BED_TEMP,
+	TELEM_FIELD_PROGRESS,
+	TELEM_FIELD_FILAMENT_WEIGHT,
+	TELEM_FIELD_REMAINING_TIME, // 時、分、秒共 3 bytes
+	TELEM_FIELD_UPLOAD_BYTES,
+	TELEM_FIELD_COUNT
+} TelemetryField_TypeDef;
+
+#define TELEM_MASK_ALL           ((uint16_t) ((1U << TELEM_FIELD_COUNT) - 1U))
+
+typedef struct {
+	bool enabled;
+	uint16_t heartbeatMs;
+	uint8_t tempDelta;
+	uint8_t weightDelta;
+} TelemetryConfig_TypeDef;
+
+/**
+ * @brief 建立遙測任務 (靜態記憶體)
+ */
+void Telemetry_Init(void);
+
+/**
+ * @brief 下次取樣時強制送出完整封包 (例如網頁重新連線)
+ */
+void Telemetry_RequestKeyframe(void);
+
+/**
+ * @brief 命令：設定遙測參數
+ * @note  格式 cSetTelemetry<enable,heartbeat_ms,temp_delta,weight_delta>，
+ *        可省略後面的欄位，省略者維持原值。
+ */
+void SetTelemetryHandler(const char *args, size_t len, ResStruct_t *_resStruct);
+
+#endif /* _TELEMETRY_H_ */
@@ -0,0 +1,111 @@
+/**
+ * @file    tlog.h
+ * @brief   Token 化二進位日誌
+ *
+ *          printf 日誌在 MCU 上格式化，並把補齊過的模組字串與整段文字送上 UART1。
+ *          TLOG 改為只送出訊息 id 與原始參數，格式字串留給主機端解碼：
+ *
+ *          - 每個呼叫點的 "檔名\x1f行號\x1f格式" 字串放在 .logfmt 區段。
+ *            該區段在連結描述檔中為 INFO (不配置記憶體、不佔 flash)，
+ *            字串在區段中的位移即為訊息 id。
+ *          - 參數依 C 型別 (_Generic) 以 1 位元組標籤加原始位元組編碼，
+ *            字串參數複製內容 (最多 TLOG_STR_MAX 位元組)，不保留指標。
+ *          - 整個訊框以一次寫入放入 UART1 發送環形緩衝區後立即返回。
+ *
+ *          訊框格式 (小端序)：
+ *            SYNC(0x1E) | id(2) | tick ms(4) | len(1) | 參數(len)
+ *          len 的最高位元表示參數被截斷。與一般 printf 文字混在同一串流中，
+ *          由 tools/logdecode.py 以建置時產生的 id 表 (<韌體>.logfmt.json) 解碼。
+ *
+ *          參數最多 TLOG_MAX_ARGS 個；支援整數 (含 enum/bool)、64 位元整數、
+ *          float/double (以 float 傳送)、字串與 void 指標，其他指標須先轉型。
+ *          應用程式碼一般透過 logger.h 的分級巨集 (LOG_E/W/I/D) 使用。
+ */
+
+#ifndef _TLOG_H_
+#define _TLOG_H_
+
+#include <stdint.h>
+
+#define TLOG_SYNC                0x1E   // ASCII RS，一般日誌文字不會出現
+#define TLOG_HDR_SIZE            8
+#define TLOG_MAX_PAYLOAD         112    // 參數區上限 (len 為 7 位元)
+#define TLOG_STR_MAX             64     // 單一字串參數最多複製的位元組數
+#define TLOG_MAX_ARGS            8
+#define TLOG_LEN_TRUNCATED       0x80
+
+/* 參數標籤，須與 tools/logdecode.py 一致 */
+#define TLOG_TAG_U32             'i'
+#define TLOG_TAG_U64             'q'
+#define TLOG_TAG_F32             'f'
+#define TLOG_TAG_STR             's'
+#define TLOG_TAG_PTR             'p'
+
+typedef struct {
+	uint8_t len;         // buf 已使用的位元組數 (含標頭)
+	uint8_t truncated;
+	uint8_t buf[TLOG_HDR_SIZE + TLOG_MAX_PAYLOAD];
+} TLogFrame_TypeDef;
+
+void TLog_Begin(TLogFrame_TypeDef *f, uint16_t id);
+void TLog_PutU32(TLogFrame_TypeDef *f, uint32_t v);
+void TLog_PutU64(TLogFrame_TypeDef *f, uint64_t v);
+void TLog_PutF32(TLogFrame_TypeDef *f, double v);
+void TLog_PutStr(TLogFrame_TypeDef *f, const char *s);
+void TLog_PutPtr(TLogFrame_TypeDef *f, const void *p);
+
+/**
+ * @brief 送出訊框：排程器運行時寫入 UART1 環形緩衝區 (滿時丟棄)，
+ *        啟動前以阻塞方式傳送，與 _write 相同
+ */
+void TLog_End(TLogFrame_TypeDef *f);
+
+#ifdef __FILE_NAME__
+#define TLOG_FILE                __FILE_NAME__
+#else
+#define TLOG_FILE                __FILE__
+#endif
+
+#define TLOG_STR_(x)             #x
+#define TLOG_STR(x)              TLOG_STR_(x)
+#define TLOG_CAT_(a, b)          a##b
+#define TLOG_CAT(a, b)           TLOG_CAT_(a, b)
+
+#define TLOG_PUT(f, x) _Generic((x),                               \
+	float: TLog_PutF32,                                            \
+	double: TLog_PutF32,                                           \
+	char *: TLog_PutStr,                                           \
+	const char *: TLog_PutStr,                                     \
+	void *: TLog_PutPtr,                                           \
+	const void *: TLog_PutPtr,                                     \
+	long long: TLog_PutU64,                                        \
+	unsigned long long: TLog_PutU64,                               \
+	default: TLog_PutU32)(f, x)
+
+#define TLOG_NARGS(...)          TLOG_NARGS_(0, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define TLOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, n, ...) n
+
+#define TLOG_EACH_0(f)
+#define TLOG_EACH_1(f, a)        TLOG_PUT(f, a);
+#define TLOG_EACH_2(f, a, ...)   TLOG_PUT(f, a); TLOG_EACH_1(f, __VA_ARGS__)
+#define TLOG_EACH_3(f, a, ...)   TLOG_PUT(f, a); TLOG_EACH_2(f, __VA_ARGS__)
+#define TLOG_EACH_4(f, a, ...)   TLOG_PUT(f, a); TLOG_EACH_3(f, __VA_ARGS__)
+#define TLOG_EACH_5(f, a, ...)   TLOG_PUT(f, a); TLOG_EACH_4(f, __VA_ARGS__)
+#define TLOG_EACH_6(f, a, ...)   TLOG_PUT(f, a); TLOG_EACH_5(f, __VA_ARGS__)
+#define TLOG_EACH_7(f, a, ...)   TLOG_PUT(f, a); TLOG_EACH_6(f, __VA_ARGS__)
+#define TLOG_EACH_8(f, a, ...)   TLOG_PUT(f, a); TLOG_EACH_7(f, __VA_ARGS__)
+#define TLOG_EACH(f, ...)        TLOG_CAT(TLOG_EACH_, TLOG_NARGS(__VA_ARGS__))(f, ##__VA_ARGS__)
+
+/**
+ * @brief 送出一則 token 化日誌，用法同 printf (fmt 須為字串常值)
+ */
+#define TLOG(fmt, ...) do {                                                                  \
+	static const char tlogFmt_[] __attribute__((section(".logfmt"), used)) =                 \
+		TLOG_FILE "\x1f" TLOG_STR(__LINE__) "\x1f" fmt;                                      \
+	TLogFrame_TypeDef tlogFrame_;                                                            \
+	TLog_Begin(&tlogFrame_, (uint16_t) (uintptr_t) tlogFmt_);                                \
+	TLOG_EACH(&tlogFrame_, ##__VA_ARGS__)                                                    \
+	TLog_End(&tlogFrame_);                                                                   \
+} while (0)
+
+#endif /* _TLOG_H_ */
@@ -0,0 +1,166 @@
+/**
+ * @file    trace.h
+ * @brief   以 DWT 週期計數器打時間戳的事件追蹤 (RAM 環形緩衝區)
+ *
+ *          記錄內容：
+ *          - 任務切換與任務建立 (FreeRTOS trace hook，見 FreeRTOSConfig.h)
+ *          - 佇列/信號量/互斥鎖的傳送、接收、阻塞與失敗 (同上)
+ *          - USART2、USART3 與 DMA 通道中斷的進入/離開 (TRACE_ISR_ENTER/EXIT)
+ *          - 使用者區段 (TRACE_SPAN_BEGIN/END)，例如 G-code 傳送、f_write、sha256
+ *
+ *          緩衝區滿時覆寫最舊的事件，停止後以 cTrace<dump> 經除錯 UART 輸出文字，
+ *          再由 tools/trace2perfetto.py 轉為 Chrome/Perfetto 可開啟的 JSON。
+ *          DWT 計數器約 60 秒溢位一次，tick hook 每 TRACE_TICK_MARK_MASK+1 個 tick
+ *          插入一筆標記，保證相鄰事件間隔小於一次溢位，主機端可據此還原時間。
+ *
+ *          TRACE_ENABLE 為 0 時所有巨集與 hook 皆為空，不佔 RAM。
+ *          本檔會被 FreeRTOSConfig.h 引入，不可 include FreeRTOS 標頭。
+ */
+
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "cmdHandler.h"
+
+#ifndef TRACE_ENABLE
+#ifdef DEBUG
+#define TRACE_ENABLE             1
+#else
+#define TRACE_ENABLE             0
+#endif
+#endif
+
+#define TRACE_RING_SIZE          512    // 事件數，須為 2 的冪次 (每筆 8 位元組)
+#define TRACE_MAX_TASKS          24     // 同時存在的任務編號數，超過的任務共用編號 0 (不記名稱)
+#define TRACE_MAX_OBJECTS        32     // 追蹤的佇列/信號量數，超過的不記錄
+#define TRACE_TASK_NAME_LEN      12
+#define TRACE_TICK_MARK_MASK     0x3FFFU  // 約 16 秒一筆標記 (1 kHz tick)
+
+/* 事件種類，須與 tools/trace2perfetto.py 一致 */
+typedef enum {
+	TRACE_EV_TASK_IN = 1,        // id = 任務編號
+	TRACE_EV_ISR_ENTER,          // id = TRACE_IRQ_xxx
+	TRACE_EV_ISR_EXIT,
+	TRACE_EV_QUEUE_SEND,         // id = 物件編號，arg = 操作前的項目數
+	TRACE_EV_QUEUE_RECV,
+	TRACE_EV_QUEUE_SEND_FAIL,
+	TRACE_EV_QUEUE_RECV_FAIL,
+	TRACE_EV_QUEUE_BLOCK_SEND,
+	TRACE_EV_QUEUE_BLOCK_RECV,
+	TRACE_EV_SPAN_BEGIN,         // id = TRACE_SPAN_xxx，arg = 呼叫端自訂 (如長度)
+	TRACE_EV_SPAN_END,
+	TRACE_EV_TICK_MARK,          // arg = tick 低 16 位元
+} TraceEvent_TypeDef;
+
+/* 追蹤的中斷：代號與顯示名稱 */
+#define TRACE_IRQ_TABLE(X)                   \
+	X(USART2,   "USART2 (ESP32)")            \
+	X(USART3,   "USART3 (printer)")          \
+	X(DMA1_CH2, "DMA1_CH2 (USART3 TX)")      \
+	X(DMA1_CH3, "DMA1_CH3 (USART3 RX)")      \
+	X(DMA1_CH4, "DMA1_CH4 (USART1 TX)")      \
+	X(DMA1_CH5, "DMA1_CH5 (USART1 RX)")      \
+	X(DMA1_CH6, "DMA1_CH6 (USART2 RX)")      \
+	X(DMA1_CH7, "DMA1_CH7 (USART2 TX)")
+
+/* 使用者區段：代號與顯示名稱 */
+#define TRACE_SPAN_TABLE(X)                  \
+	X(GCODE_SEND, "gcode send")              \
+	X(F_WRITE,    "f_write")                 \
+	X(SHA256,     "sha256")
+
+#define TRACE_IRQ_ENUM_(id, name)  TRACE_IRQ_##id,
+typedef enum {
+	TRACE_IRQ_TABLE(TRACE_IRQ_ENUM_)
+	TRACE_IRQ_COUNT
+} TraceIrq_TypeDef;
+#undef TRACE_IRQ_ENUM_
+
+#define TRACE_SPAN_ENUM_(id, name) TRACE_SPAN_##id,
+typedef enum {
+	TRACE_SPAN_TABLE(TRACE_SPAN_ENUM_)
+	TRACE_SPAN_COUNT
+} TraceSpan_TypeDef;
+#undef TRACE_SPAN_ENUM_
+
+/**
+ * @brief 命令：cTrace<start|stop|dump>，start 清空並開始記錄，stop 凍結緩衝區，
+ *        dump 凍結後經除錯 UART 輸出全部事件；不帶參數時只回報狀態
+ */
+void TraceHandler(const char *args, size_t len, ResStruct_t *_resStruct);
+
+#if TRACE_ENABLE
+
+/**
+ * @brief 啟用 DWT 計數器並開始記錄，於 main 最前段呼叫
+ */
+void Trace_Init(void);
+
+/**
+ * @brief 記錄一筆事件 (任務、中斷皆可呼叫)
+ */
+void Trace_Record(uint8_t type, uint8_t id, uint16_t arg);
+
+/* FreeRTOS hook 使用 */
+
+/**
+ * @brief 配置任務編號並記錄名稱；編號於刪除時釋放，輪流配置以延後重用
+ * @return 任務編號，沒有空位時回傳 0
+ */
+uint8_t Trace_TaskCreate(const char *name);
+void Trace_TaskDelete(uint32_t number);
+void Trace_TaskSwitchedIn(uint32_t number);
+uint8_t Trace_ObjectCreate(uint8_t queueType);
+void Trace_ObjectName(uint32_t number, const char *name);
+
+#define TRACE_ISR_ENTER(irq)           Trace_Record(TRACE_EV_ISR_ENTER, (irq), 0)
+#define TRACE_ISR_EXIT(irq)            Trace_Record(TRACE_EV_ISR_EXIT, (irq), 0)
+#define TRACE_SPAN_BEGIN(span, arg)    Trace_Record(TRACE_EV_SPAN_BEGIN, (span), (uint16_t) (arg))
+#define TRACE_SPAN_END(span)           Trace_Record(TRACE_EV_SPAN_END, (span), 0)
+
+/* 未配置編號 (超過 TRACE_MAX_OBJECTS) 的物件不記錄 */
+#define TRACE_QUEUE_EVENT_(type, q)    do {                                      \
+	if ((q)->uxQueueNumber != 0) {                                               \
+		Trace_Record((type), (uint8_t) (q)->uxQueueNumber,                       \
+		             (uint16_t) (q)->uxMessagesWaiting);                         \
+	}                                                                            \
+} while (0)
+
+/* 任務建立/切換 hook 與執行期統計共用，於 FreeRTOSConfig.h 組合 */
+#define TRACE_TASK_CREATE(name)                    Trace_TaskCreate(name)
+#define TRACE_TASK_DELETE(number)                  Trace_TaskDelete(number)
+#define TRACE_TASK_SWITCHED_IN(number)             Trace_TaskSwitchedIn(number)
+#define traceTASK_INCREMENT_TICK(xTickCount)       do {                                        \
+	if (((xTickCount) & TRACE_TICK_MARK_MASK) == 0) {                                         \
+		Trace_Record(TRACE_EV_TICK_MARK, 0, (uint16_t) (xTickCount));                         \
+	}                                                                                          \
+} while (0)
+#define traceQUEUE_CREATE(pxNewQueue)              ((pxNewQueue)->uxQueueNumber = Trace_ObjectCreate((pxNewQueue)->ucQueueType))
+#define traceQUEUE_REGISTRY_ADD(xQueue, pcName)    Trace_ObjectName((xQueue)->uxQueueNumber, (pcName))
+#define traceQUEUE_SEND(pxQueue)                   TRACE_QUEUE_EVENT_(TRACE_EV_QUEUE_SEND, pxQueue)
+#define traceQUEUE_SEND_FROM_ISR(pxQueue)          TRACE_QUEUE_EVENT_(TRACE_EV_QUEUE_SEND, pxQueue)
+#define traceQUEUE_SEND_FAILED(pxQueue)            TRACE_QUEUE_EVENT_(TRACE_EV_QUEUE_SEND_FAIL, pxQueue)
+#define traceQUEUE_SEND_FROM_ISR_FAILED(pxQueue)   TRACE_QUEUE_EVENT_(TRACE_EV_QUEUE_SEND_FAIL, pxQueue)
+#define traceQUEUE_RECEIVE(pxQueue)                TRACE_QUEUE_EVENT_(TRACE_EV_QUEUE_RECV, pxQueue)
+#define traceQUEUE_RECEIVE_FROM_ISR(pxQueue)       TRACE_QUEUE_EVENT_(TRACE_EV_QUEUE_RECV, pxQueue)
+#define traceQUEUE_RECEIVE_FAILED(pxQueue)         TRACE_QUEUE_EVENT_(TRACE_EV_QUEUE_RECV_FAIL, pxQueue)
+#define traceQUEUE_RECEIVE_FROM_ISR_FAILED(pxQueue) TRACE_QUEUE_EVENT_(TRACE_EV_QUEUE_RECV_FAIL, pxQueue)
+#define traceBLOCKING_ON_QUEUE_SEND(pxQueue)       TRACE_QUEUE_EVENT_(TRACE_EV_QUEUE_BLOCK_SEND, pxQueue)
+#define traceBLOCKING_ON_QUEUE_RECEIVE(pxQueue)    TRACE_QUEUE_EVENT_(TRACE_EV_QUEUE_BLOCK_RECV, pxQueue)
+
+#else
+
+#define Trace_Init()                   ((void) 0)
+#define TRACE_TASK_CREATE(name)        0U
+#define TRACE_TASK_DELETE(number)      ((void) 0)
+#define TRACE_TASK_SWITCHED_IN(number) ((void) 0)
+#define TRACE_ISR_ENTER(irq)           ((void) 0)
+#define TRACE_ISR_EXIT(irq)            ((void) 0)
+#define TRACE_SPAN_BEGIN(span, arg)    ((void) 0)
+#define TRACE_SPAN_END(span)           ((void) 0)
+
+#endif /* TRACE_ENABLE */
+
+#endif /* _TRACE_H_ */
@@ -44,6 +44,11 @@ extern DMA_HandleTypeDef hdma_usart3_rx;
 #define PRINTER_USART_BPS           250000
 #define UART_RX_BUFFER_SIZE			2048
 #define RX_BUFFER_POOL_SIZE         6
+#define UART_TX_BUFFER_SIZE         320     // 鏈路層單一訊框上限，須容納單筆長檔名清單條目 (見 fileList.h)
+#define UART1_TX_RING_SIZE          1024    // 除錯輸出發送環形緩衝區 (2 的次方)
+#define UART2_TX_RING_SIZE          2048    // ESP32 鏈路發送環形緩衝區，檔案清單會連續送出多個訊框
+#define UART3_TX_RING_SIZE          512     // 印表機 G-code 發送環形緩衝區
+#define UART_URGENT_TIMEOUT_MS      50      // UART_SendUrgent 等待行邊界與送出的上限
 
 
 void MX_USART1_UART_Init(void);
@@ -56,33 +61,75 @@ void MX_USART3_UART_Init(void);
 typedef struct {
 	char data[UART_RX_BUFFER_SIZE] __attribute__((aligned(4)));
 	uint16_t len;
+	volatile uint8_t refCnt; // 接收端與仍持有封包的消費者數量 (見 link.h)
 } __attribute__((packed)) uartRxBuf_TypeDef;
 
+typedef struct {
+	const void *data;
+	size_t len;
+} UartTxPart_TypeDef;
+
+typedef struct {
+	uint16_t size;
+	uint16_t used;        // 尚未送出的位元組數 (含正在複製中的保留空間)
+	uint16_t highWater;   // used 的最大值
+	uint32_t writes;
+	uint32_t dropWrites;  // 空間不足而丟棄的寫入次數
+	uint32_t dropBytes;
+	uint32_t dmaCount;    // DMA 傳輸次數 (writes / dmaCount 為平均合併筆數)
+	uint32_t dmaErrors;
+} UartTxStats_TypeDef;
+
 // extern uartRxBuf_TypeDef uartRxBuf;
-extern uartRxBuf_TypeDef *pCurrentRxBuf;
 extern QueueHandle_t xFreeBufferQueue;
-extern volatile bool uartRxPaused;
 
 /**
- * @brief (公共 API) 執行緒安全的非阻塞(Non-Blocking) DMA 傳輸字串
- * @note  這是 _UART_SendBuffer_DMA_NonBlocking 的字串包裝函式。
+ * @brief (公共 API) 無鎖非阻塞(Non-Blocking) DMA 傳輸字串，任務與中斷皆可呼叫
+ * @note  資料複製進該 UART 的發送環形緩衝區後立即返回，空間不足時整筆丟棄。
+ * @retval HAL_BUSY 空間不足
  */
 HAL_StatusTypeDef UART_SendString_DMA(UART_HandleTypeDef *huart, const char *str);
 
 /**
- * @brief 初始化Uart同步機制
+ * @brief (公共 API) 將多段資料合併為單次 DMA 傳輸
+ * @note  各段在環形緩衝區中連續存放，不會與其他寫入者交錯，供鏈路層組合封包標頭與 CRC 使用。
  */
-void Uart_Sync_Init(void);
+HAL_StatusTypeDef UART_SendParts_DMA(UART_HandleTypeDef *huart, const UartTxPart_TypeDef *parts, uint8_t count);
 
 /**
- * @brief 初始化接收緩衝區池
+ * @brief (任務) 在傳輸中的 G-code 行送完後插隊送出 str，之後恢復環形緩衝區的傳輸
+ * @note  只支援以行為單位傳輸的印表機 UART。返回時 str 已全部寫入 DR，
+ *        排在它之後的資料仍在環形緩衝區中，不會遺失或重送。
+ * @retval HAL_TIMEOUT 超過 UART_URGENT_TIMEOUT_MS 仍未到行邊界 (DMA 已停止時仍會送出) 或未送完
  */
-void Uart_Rx_Pool_Init(void);
+HAL_StatusTypeDef UART_SendUrgent(UART_HandleTypeDef *huart, const char *str);
+
+/**
+ * @brief 丟棄環形緩衝區中尚未開始傳輸的資料 (計入 dropBytes)
+ * @note  傳輸中的一段 DMA 會送完；呼叫之後才寫入的資料照常送出。
+ * @return 丟棄的位元組數
+ */
+uint16_t UART_DiscardPending(UART_HandleTypeDef *huart);
+
+/**
+ * @brief 讀取發送環形緩衝區統計
+ */
+void UART_GetTxStats(const UART_HandleTypeDef *huart, UartTxStats_TypeDef *stats);
+
+/**
+ * @brief 命令：回報各 UART 發送環形緩衝區統計 cReqUartTx
+ */
+void GetUartTxHandler(const char *args, size_t len, ResStruct_t *_resStruct);
 
 /**
- * @brief 恢復 UART 接收 (當有空閒緩衝區時調用)
+ * @brief 綁定 TX DMA 完成回調並開啟 DMAT，須在 MX_USARTx_UART_Init 之後呼叫
  */
-void UART_Resume_Reception(void);
+void Uart_Tx_Init(void);
+
+/**
+ * @brief 初始化接收緩衝區池
+ */
+void Uart_Rx_Pool_Init(void);
 
 /* USER CODE END Prototypes */
 
@@ -3,8 +3,14 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "cmsis_os.h"
+#include "boot.h"
 #include <stdio.h>
 
+#define LOG_MODULE UI
+#include "logger.h"
+
+#define BOOT_SCREEN_TIMEOUT_MS   10000  // 開機步驟逾時仍進入主畫面 (例如 SD 正在格式化)
+
 void show_boot_animation(void) {
 	const int screen_x = LCD_GetXSize();
 	const int screen_y = LCD_GetYSize();
@@ -25,10 +31,24 @@ void show_boot_animation(void) {
 	GUI_SetColor(GUI_WHITE);
 	GUI_DrawRect(bar_x, bar_y, bar_x + bar_width, bar_y + bar_height);
 	
+	// 第一個畫面已出現
+	Boot_StepDone(BOOT_STEP_GUI);
+
+	// 進度條依已完成的開機步驟前進，不再固定等待 2 秒
 	GUI_SetColor(GUI_GREEN);
-	for (int i = 1; i <= bar_width - 4; i++) {
-		GUI_FillRect(bar_x + 2, bar_y + 2, bar_x + 2 + i, bar_y + bar_height - 2);
-		osDelay(10);
+	const int fill_width = bar_width - 4;
+	uint32_t waited = 0;
+	bool ready;
+	do {
+		ready = Boot_WaitSteps(BOOT_READY_MASK, 50);
+		waited += 50;
+		int fill = ready ? fill_width : (fill_width * Boot_DoneCount()) / BOOT_STEP_COUNT;
+		if (fill > 0) {
+			GUI_FillRect(bar_x + 2, bar_y + 2, bar_x + 2 + fill, bar_y + bar_height - 2);
+		}
+	} while (!ready && waited < BOOT_SCREEN_TIMEOUT_MS);
+	if (!ready) {
+		LOG_W("boot not ready after %dms, showing main screen\r\n", BOOT_SCREEN_TIMEOUT_MS);
 	}
 	// 動畫完成後清屏為黑色，等待 GUI 任務繪製主界面
 	GUI_SetBkColor(GUI_DARKGRAY);
@@ -43,6 +63,7 @@ void touchTask(void *argument) {
 }
 
 void GUI_Task(void *argument) {
+	Boot_StepBegin(BOOT_STEP_GUI);
 	show_boot_animation();
 	
 	WM_HWIN hWin = CreateFramewin();
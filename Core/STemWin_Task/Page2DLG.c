@@ -165,7 +165,7 @@ static void _cbDialog(WM_MESSAGE *pMsg) {
 						// USER START (Optionally insert code for reacting on notification message)
                             memset(cmdBuf, 0, sizeof(cmdBuf));
                             snprintf(cmdBuf, sizeof(cmdBuf), "%s<%d>", CMD_Set_Nozzle_Temp, nozzle_temp);
-                            xQueueSend(xCmdQueue, cmdBuf, 0);
+                            ESP32_PostCommand(cmdBuf);
                             UI_Update_NozzleTemp(nozzle_temp);
 						// USER END
 							break;
@@ -197,7 +197,7 @@ static void _cbDialog(WM_MESSAGE *pMsg) {
 						// USER START (Optionally insert code for reacting on notification message)
                             memset(cmdBuf, 0, sizeof(cmdBuf));
                             snprintf(cmdBuf, sizeof(cmdBuf), "%s", CMD_Go_Home);
-                            xQueueSend(xCmdQueue, cmdBuf, 0);
+                            ESP32_PostCommand(cmdBuf);
 						// USER END
 						break;
 						// USER START (Optionally insert additional code for further notification handling)
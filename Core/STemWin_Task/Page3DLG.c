@@ -25,8 +25,7 @@
 #include "cmdList.h"
 #include "FreeRTOS.h"
 #include "queue.h"
-
-extern QueueHandle_t xCmdQueue;
+#include "esp32.h"
 // USER END
 
 #include "DIALOG.h"
@@ -155,7 +154,7 @@ static void _cbDialog(WM_MESSAGE *pMsg) {
 						// USER START (Optionally insert code for reacting on notification message)
                             memset(cmdBuf, 0, sizeof(cmdBuf));
                             snprintf(cmdBuf, sizeof(cmdBuf), "%s", CMD_Start_To_Print);
-                            xQueueSend(xCmdQueue, cmdBuf, 0);
+                            ESP32_PostCommand(cmdBuf);
 						// USER END
 							break;
 							// USER START (Optionally insert additional code for further notification handling)
@@ -172,7 +171,7 @@ static void _cbDialog(WM_MESSAGE *pMsg) {
 						// USER START (Optionally insert code for reacting on notification message)
                             memset(cmdBuf, 0, sizeof(cmdBuf));
                             snprintf(cmdBuf, sizeof(cmdBuf), "%s", CMD_Pause_Printing);
-                            xQueueSend(xCmdQueue, cmdBuf, 0);
+                            ESP32_PostCommand(cmdBuf);
 						// USER END
 						break;
 						// USER START (Optionally insert additional code for further notification handling)
@@ -189,7 +188,7 @@ static void _cbDialog(WM_MESSAGE *pMsg) {
 						// USER START (Optionally insert code for reacting on notification message)
                             memset(cmdBuf, 0, sizeof(cmdBuf));
                             snprintf(cmdBuf, sizeof(cmdBuf), "%s", CMD_Stop_printing);
-                            xQueueSend(xCmdQueue, cmdBuf, 0);
+                            ESP32_PostCommand(cmdBuf);
 						// USER END
 							break;
 							// USER START (Optionally insert additional code for further notification handling)
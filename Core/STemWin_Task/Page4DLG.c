@@ -24,6 +24,7 @@
 #include "DIALOG.h"
 #include "usart.h"
 #include "esp32.h"
+#include "taskStats.h"
 
 /*********************************************************************
 *
@@ -38,6 +39,7 @@
 #define ID_TEXT_SYS_2    (GUI_ID_USER + 0x04)
 #define ID_TEXT_SYS_IP   (GUI_ID_USER + 0x05)
 #define ID_BTN_ESP32_BURN (GUI_ID_USER + 0x06)
+#define ID_LISTVIEW_TASKS (GUI_ID_USER + 0x07)
 
 
 // USER START (Optionally insert additional defines)
@@ -65,10 +67,13 @@ static const GUI_WIDGET_CREATE_INFO _aDialogCreate[] = {
 	{TEXT_CreateIndirect, "Camera: OFF", ID_TEXT_CAM_ST, 160, 20, 140, 20, 0, 0x0, 0},
 
 	// System Info
-	{TEXT_CreateIndirect, "System Info:", ID_TEXT_SYS_1, 10, 70, 290, 20, 0, 0x0, 0},
-	{TEXT_CreateIndirect, "FW: v1.0.0", ID_TEXT_SYS_2, 10, 95, 290, 20, 0, 0x0, 0},
-	{TEXT_CreateIndirect, "IP: ---", ID_TEXT_SYS_IP, 10, 120, 290, 20, 0, 0x0, 0},
+	{TEXT_CreateIndirect, "System Info:", ID_TEXT_SYS_1, 10, 70, 145, 20, 0, 0x0, 0},
+	{TEXT_CreateIndirect, "FW: v1.0.0", ID_TEXT_SYS_2, 10, 95, 145, 20, 0, 0x0, 0},
+	{TEXT_CreateIndirect, "IP: ---", ID_TEXT_SYS_IP, 10, 120, 145, 20, 0, 0x0, 0},
 	{BUTTON_CreateIndirect, "esp32 burn", ID_BTN_ESP32_BURN, 10, 145, 140, 40, 0, 0x0, 0},
+
+	// Task Stats (CPU %, stack free bytes, switches per second)
+	{LISTVIEW_CreateIndirect, "Tasks", ID_LISTVIEW_TASKS, 160, 60, 145, 130, 0, 0x0, 0},
 	// USER START (Optionally insert additional widgets)
 	// USER END
 };
@@ -81,6 +86,37 @@ static const GUI_WIDGET_CREATE_INFO _aDialogCreate[] = {
 */
 
 // USER START (Optionally insert additional static code)
+
+/**
+ * @brief 以最近一次的任務統計更新列表 (依 CPU 使用率排序)
+ */
+static void _UpdateTaskList(WM_HWIN hList) {
+	static TaskStats_TypeDef stats;
+	char text[12];
+	unsigned rows;
+
+	TaskStats_Get(&stats);
+	rows = LISTVIEW_GetNumRows(hList);
+	while (rows < stats.count) {
+		LISTVIEW_AddRow(hList, NULL);
+		rows++;
+	}
+	while (rows > stats.count) {
+		LISTVIEW_DeleteRow(hList, --rows);
+	}
+	for (unsigned i = 0; i < stats.count; i++) {
+		const TaskStatsEntry_TypeDef *e = &stats.task[i];
+		LISTVIEW_SetItemText(hList, 0, i, e->name);
+		snprintf(text, sizeof(text), "%u.%u", e->cpuPermille / 10, e->cpuPermille % 10);
+		LISTVIEW_SetItemText(hList, 1, i, text);
+		snprintf(text, sizeof(text), "%u", e->stackFree);
+		LISTVIEW_SetItemText(hList, 2, i, text);
+		snprintf(text, sizeof(text), "%lu",
+		         (unsigned long) (stats.windowMs > 0 ? (e->switches * 1000U) / stats.windowMs : 0));
+		LISTVIEW_SetItemText(hList, 3, i, text);
+	}
+}
+
 // USER END
 
 /*********************************************************************
@@ -133,6 +169,26 @@ static void _cbDialog(WM_MESSAGE *pMsg) {
 			// ESP32 Burn Button
 			hItem = WM_GetDialogItem(pMsg->hWin, ID_BTN_ESP32_BURN);
 			BUTTON_SetFont(hItem, GUI_FONT_16B_1);
+
+			// Task Stats
+			hItem = WM_GetDialogItem(pMsg->hWin, ID_LISTVIEW_TASKS);
+			LISTVIEW_SetFont(hItem, GUI_FONT_13_1);
+			HEADER_SetFont(LISTVIEW_GetHeader(hItem), GUI_FONT_13_1);
+			LISTVIEW_AddColumn(hItem, 52, "Task", GUI_TA_LEFT | GUI_TA_VCENTER);
+			LISTVIEW_AddColumn(hItem, 33, "CPU%", GUI_TA_RIGHT | GUI_TA_VCENTER);
+			LISTVIEW_AddColumn(hItem, 30, "Stk", GUI_TA_RIGHT | GUI_TA_VCENTER);
+			LISTVIEW_AddColumn(hItem, 30, "Sw/s", GUI_TA_RIGHT | GUI_TA_VCENTER);
+			LISTVIEW_SetBkColor(hItem, LISTVIEW_CI_UNSEL, GUI_BLACK);
+			LISTVIEW_SetTextColor(hItem, LISTVIEW_CI_UNSEL, GUI_WHITE);
+			_UpdateTaskList(hItem);
+			WM_CreateTimer(pMsg->hWin, 0, TASKSTATS_PERIOD_MS, 0);
+			break;
+		case WM_TIMER:
+			// 只在本頁顯示時重繪列表
+			if (WM_IsVisible(pMsg->hWin)) {
+				_UpdateTaskList(WM_GetDialogItem(pMsg->hWin, ID_LISTVIEW_TASKS));
+			}
+			WM_RestartTimer(pMsg->Data.v, TASKSTATS_PERIOD_MS);
 			break;
 		case WM_NOTIFY_PARENT:
 			Id = WM_GetId(pMsg->hWinSrc);
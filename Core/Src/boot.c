@@ -0,0 +1,235 @@
+/**
+ * @file    boot.c
+ * @brief   開機流程協調，說明見 boot.h
+ */
+
+#include "boot.h"
+#include <stdio.h>
+#include <string.h>
+#include "cmsis_os2.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "event_groups.h"
+#include "main.h"
+#include "link.h"
+#include "esp32.h"
+#include "estop.h"
+#include "telemetry.h"
+#include "fileTask.h"
+#include "fileCatalog.h"
+#include "storage.h"
+#include "Fatfs_SDIO.h"
+#include "hx711.h"
+
+#define LOG_MODULE BOOT
+#include "logger.h"
+
+#define BOOT_ALL_MASK            (BOOT_BIT(BOOT_STEP_COUNT) - 1U)
+#define BOOT_UNSET               0xFFFFFFFFUL
+
+typedef struct {
+	BootStep_TypeDef step;
+	uint32_t deps;       // 須先完成的步驟
+	void (*run)(void);
+} BootJob_TypeDef;
+
+static const char *const stepName[BOOT_STEP_COUNT] = {
+	[BOOT_STEP_LINK]    = "link",
+	[BOOT_STEP_SD]      = "sd",
+	[BOOT_STEP_HX711]   = "hx711",
+	[BOOT_STEP_CATALOG] = "catalog",
+	[BOOT_STEP_GUI]     = "gui",
+};
+
+static void job_link(void) {
+	FileTask_Init(); // 初始化檔案任務佇列
+	Estop_Init();
+	ESP32_Init();
+	Telemetry_Init();
+}
+
+static void job_sd(void) {
+	Sanitize_SD_Bus();
+	SDIO_FatFs_init();
+}
+
+static void job_hx711(void) {
+	Hx711_Init(&hx711);
+}
+
+static void job_catalog(void) {
+	Catalog_Init(); // 卡片在其他裝置上被修改時會重建索引，需時較久
+	Storage_Init(); // 背景統計剩餘空間
+}
+
+/* 依優先順序排列：工作者總是先取排在前面、相依步驟已完成的工作 */
+static const BootJob_TypeDef bootJobs[] = {
+	{BOOT_STEP_LINK,    0,                       job_link},
+	{BOOT_STEP_SD,      0,                       job_sd},
+	{BOOT_STEP_HX711,   0,                       job_hx711},
+	{BOOT_STEP_CATALOG, BOOT_BIT(BOOT_STEP_SD),  job_catalog},
+};
+#define BOOT_JOB_COUNT           (sizeof(bootJobs) / sizeof(bootJobs[0]))
+
+static StaticEventGroup_t bootEventsBuf;
+static EventGroupHandle_t bootEvents = NULL;
+static uint32_t claimedJobs = 0;   // 已被工作者取走的工作 (bootJobs 索引)
+static uint32_t rtosMs = 0;
+static uint32_t readyMs = BOOT_UNSET;
+static uint32_t stepStart[BOOT_STEP_COUNT];
+static uint32_t stepEnd[BOOT_STEP_COUNT];
+
+static const osThreadAttr_t bootWorker_attributes = {
+	.name = "Boot_Worker",
+	.stack_size = configMINIMAL_STACK_SIZE * 16, // Catalog_Init 會呼叫 FatFs (長檔名緩衝區在堆疊上)
+	.priority = (osPriority_t) osPriorityNormal,
+};
+
+static void boot_log_timeline(void) {
+	LOG_I("rtos %lums, ready %lums\r\n", (unsigned long) rtosMs, (unsigned long) readyMs);
+	for (uint8_t i = 0; i < BOOT_STEP_COUNT; i++) {
+		LOG_I("%-8s %5lu -> %5lu ms (%lu ms)\r\n", stepName[i], (unsigned long) stepStart[i],
+		      (unsigned long) stepEnd[i], (unsigned long) (stepEnd[i] - stepStart[i]));
+	}
+}
+
+/**
+ * @brief 取一個相依步驟已完成且尚未被取走的工作
+ * @return bootJobs 索引，沒有可執行的工作時回傳 -1，全部已被取走時回傳 -2
+ */
+static int32_t boot_claim(void) {
+	uint32_t done = xEventGroupGetBits(bootEvents);
+	int32_t idx = -2;
+
+	taskENTER_CRITICAL();
+	for (uint32_t i = 0; i < BOOT_JOB_COUNT; i++) {
+		if (claimedJobs & (1UL << i)) {
+			continue;
+		}
+		if ((bootJobs[i].deps & done) == bootJobs[i].deps) {
+			claimedJobs |= 1UL << i;
+			idx = (int32_t) i;
+			break;
+		}
+		idx = -1;
+	}
+	taskEXIT_CRITICAL();
+	return idx;
+}
+
+static void boot_worker(void) {
+	int32_t idx;
+
+	while ((idx = boot_claim()) != -2) {
+		if (idx < 0) {
+			// 等任一尚未完成的步驟完成後再找
+			uint32_t pending = BOOT_ALL_MASK & ~xEventGroupGetBits(bootEvents);
+			xEventGroupWaitBits(bootEvents, pending, pdFALSE, pdFALSE, pdMS_TO_TICKS(100));
+			continue;
+		}
+		Boot_StepBegin(bootJobs[idx].step);
+		bootJobs[idx].run();
+		Boot_StepDone(bootJobs[idx].step);
+	}
+}
+
+static void Boot_Worker_Task(void *argument) {
+	boot_worker();
+	vTaskDelete(NULL);
+}
+
+void Boot_Init(void) {
+	rtosMs = HAL_GetTick();
+	// SD 與 HX711 工作會同時開啟 GPIO 時脈，RCC->APB2ENR 的讀改寫可能互相覆蓋，
+	// 先在 RTOS 啟動前全部開啟，工作中的重複開啟便不會改變暫存器值
+	__HAL_RCC_GPIOB_CLK_ENABLE();
+	__HAL_RCC_GPIOC_CLK_ENABLE();
+	__HAL_RCC_GPIOD_CLK_ENABLE();
+	__HAL_RCC_GPIOF_CLK_ENABLE();
+	for (uint8_t i = 0; i < BOOT_STEP_COUNT; i++) {
+		stepStart[i] = BOOT_UNSET;
+		stepEnd[i] = BOOT_UNSET;
+	}
+	bootEvents = xEventGroupCreateStatic(&bootEventsBuf);
+}
+
+void Boot_Run(void) {
+	for (uint8_t i = 1; i < BOOT_WORKERS; i++) {
+		if (osThreadNew(Boot_Worker_Task, NULL, &bootWorker_attributes) == NULL) {
+			LOG_E("boot worker create failed, running serially\r\n");
+			break;
+		}
+	}
+	boot_worker();
+}
+
+void Boot_StepBegin(BootStep_TypeDef step) {
+	stepStart[step] = HAL_GetTick();
+}
+
+void Boot_StepDone(BootStep_TypeDef step) {
+	bool ready;
+	bool all;
+
+	stepEnd[step] = HAL_GetTick();
+	uint32_t done = xEventGroupSetBits(bootEvents, BOOT_BIT(step)) | BOOT_BIT(step);
+
+	taskENTER_CRITICAL();
+	ready = (readyMs == BOOT_UNSET) && (done & BOOT_READY_MASK) == BOOT_READY_MASK;
+	if (ready) {
+		readyMs = stepEnd[step];
+	}
+	all = (done & BOOT_ALL_MASK) == BOOT_ALL_MASK;
+	taskEXIT_CRITICAL();
+
+	LOG_D("%s done at %lums\r\n", stepName[step], (unsigned long) stepEnd[step]);
+	if (all) {
+		boot_log_timeline();
+	}
+}
+
+bool Boot_IsDone(BootStep_TypeDef step) {
+	return (xEventGroupGetBits(bootEvents) & BOOT_BIT(step)) != 0;
+}
+
+bool Boot_StorageReady(void) {
+	// 目錄索引相依 SD，索引完成即表示卡已掛載
+	return Boot_IsDone(BOOT_STEP_CATALOG);
+}
+
+bool Boot_WaitSteps(uint32_t mask, uint32_t timeoutMs) {
+	TickType_t ticks = (timeoutMs == osWaitForever) ? portMAX_DELAY : pdMS_TO_TICKS(timeoutMs);
+	EventBits_t bits = xEventGroupWaitBits(bootEvents, mask, pdFALSE, pdTRUE, ticks);
+	return (bits & mask) == mask;
+}
+
+uint8_t Boot_DoneCount(void) {
+	uint32_t done = xEventGroupGetBits(bootEvents) & BOOT_ALL_MASK;
+	uint8_t n = 0;
+
+	for (; done; done &= done - 1) {
+		n++;
+	}
+	return n;
+}
+
+void GetBootHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
+	char buf[200];
+	int n = snprintf(buf, sizeof(buf), "Boot:rtos=%lu,ready=%ld", (unsigned long) rtosMs,
+	                 readyMs == BOOT_UNSET ? -1L : (long) readyMs);
+
+	// 各步驟為 開始-結束 (ms)，尚未完成者結束時間為 -1
+	for (uint8_t i = 0; i < BOOT_STEP_COUNT && n < (int) sizeof(buf); i++) {
+		n += snprintf(buf + n, sizeof(buf) - (size_t) n, ",%s=%ld-%ld", stepName[i],
+		              stepStart[i] == BOOT_UNSET ? -1L : (long) stepStart[i],
+		              stepEnd[i] == BOOT_UNSET ? -1L : (long) stepEnd[i]);
+	}
+	if (n < (int) sizeof(buf) - 1) {
+		buf[n++] = '\n';
+		buf[n] = '\0';
+	} else {
+		n = (int) sizeof(buf) - 1;
+	}
+	LOG_D("%s", buf);
+	Link_Send(LINK_CH_RSP, buf, (uint16_t) n);
+}
@@ -1,115 +1,170 @@
 #include "cmdHandler.h"
 #include <string.h>
 #include <stdio.h>
-
-/* 命令格式定義  */
-typedef struct {
-	char cmdName[MAX_CMD_LEN];
-	CommandCallback callback;
-} Command_Typedef;
-
-static Command_Typedef commands[MAX_CMD_COUNT] = {0}; //存放所有命令
-static uint8_t cmdQty = 0; //目前命令數量
-
-CmdHandlerStat_t register_command(const char *cmdName, CommandCallback callback) {
-	if (cmdQty >= MAX_CMD_COUNT) {
-		return QTY_OVER;
-	} else if (cmdName == NULL) {
-		return NAME_ERR;
-	} else if (callback == NULL) {
-		return CALBCK_ERR;
+#include "cmdList.h"
+#include "esp32.h"
+#include "printerController.h"
+#include "telemetry.h"
+#include "estop.h"
+#include "fileList.h"
+#include "fileCatalog.h"
+#include "Fatfs_SDIO.h"
+#include "storage.h"
+#include "sd_bench.h"
+#include "boot.h"
+#include "usart.h"
+#include "trace.h"
+#include "taskStats.h"
+#include "heapStats.h"
+
+#define LOG_MODULE CMD
+#include "logger.h"
+
+/* 編譯期產生的完美雜湊命令表 (見 tools/gen_cmd_table.py) */
+#include "cmdTable.h"
+
+#define CMD_COUNT_ONE(name, callback) + 1
+_Static_assert((0 CMD_TABLE(CMD_COUNT_ONE)) == CMD_COUNT, "cmdTable.h is out of date with CMD_TABLE");
+
+/**
+ * @brief 取出命令名稱長度 (到 '<'、空白或換行為止)
+ */
+static size_t cmd_token_len(const char *cmd, size_t len) {
+	size_t n = 0;
+	if (len > MAX_CMD_LEN) len = MAX_CMD_LEN;
+	while (n < len && cmd[n] != '\0' && cmd[n] != '<' &&
+	       cmd[n] != ' ' && cmd[n] != '\r' && cmd[n] != '\n') {
+		++n;
 	}
+	return n;
+}
 
-	// 檢查是否重複
-	for (uint8_t i = 0; i < cmdQty; ++i) {
-		if (strcmp(commands[i].cmdName, cmdName) == 0) {
-			//重複
-			return REPEAT_ERR;
-		}
+/**
+ * @brief FNV-1a，種子由產生器決定，必須與 gen_cmd_table.py 一致
+ */
+static uint32_t cmd_hash(const char *name, size_t len) {
+	uint32_t h = CMD_HASH_SEED;
+	for (size_t i = 0; i < len; ++i) {
+		h ^= (uint8_t) name[i];
+		h *= 16777619U;
 	}
+	return h;
+}
 
-	strncpy(commands[cmdQty].cmdName, cmdName, MAX_CMD_LEN - 1);
-	// commands[cmdQty].cmdName[MAX_CMD_LEN - 1] = '\0';
-	commands[cmdQty].callback = callback;
-	++cmdQty;
-	return CMD_OK;
+/**
+ * @brief 以雜湊表查詢命令，名稱必須完全相符
+ * @return 找不到時回傳 NULL
+ */
+static const Command_Typedef *find_command(const char *cmd, size_t len) {
+	if (cmd == NULL) return NULL;
+
+	size_t nameLen = cmd_token_len(cmd, len);
+	if (nameLen == 0) return NULL;
+
+	const Command_Typedef *entry = &cmdHashTable[cmd_hash(cmd, nameLen) & ((1U << CMD_HASH_BITS) - 1U)];
+	if (entry->callback == NULL || entry->nameLen != nameLen || memcmp(entry->cmdName, cmd, nameLen) != 0) {
+		return NULL;
+	}
+	return entry;
 }
 
-CmdHandlerStat_t execute_command(const char *cmd, ResStruct_t *_resStruct) {
-	if (cmd == NULL) return CMD_ERR;
-
-	char cmdName[MAX_CMD_LEN] = {0};
-	size_t cmdLen;
-
-	// 查找命令表中的匹配命令
-	for (uint8_t i = 0; i < cmdQty; ++i) {
-		cmdLen = strlen(commands[i].cmdName);
-		if (strncmp(cmd, commands[i].cmdName, cmdLen) == 0) {
-			strncpy(cmdName, cmd, cmdLen);
-			cmdName[cmdLen] = '\0';
-			printf("%-20s %s is running...\r\n", "[cmdhandler.c]", cmdName);
-			commands[i].callback(cmd, _resStruct);
-			// memset(cmdName, 0, MAX_CMD_LEN);
-			return CMD_OK;
-		}
+CmdHandlerStat_t execute_command(const char *cmd, size_t len, ResStruct_t *_resStruct) {
+	const Command_Typedef *entry = find_command(cmd, len);
+
+	if (entry == NULL) {
+		LOG_W("No matching command found for: %.*s\r\n", cmd ? (int) cmd_token_len(cmd, len) : 6, cmd ? cmd : "(null)");
+		return CMD_ERR;
 	}
-	printf("%-20s No matching command found for: %s\r\n", "[cmdhandler.c]", cmd);
-	return EXC_ERR;
+	LOG_D("%s is running...\r\n", entry->cmdName);
+	entry->callback(cmd, len, _resStruct);
+	return CMD_OK;
 }
 
-bool isReqCmd(const char *cmd) {
-	if (cmd == NULL) return false;
-	return (strstr(cmd, (const char *) "cReq") != NULL);
+bool isReqCmd(const char *cmd, size_t len) {
+	if (cmd == NULL || len < 4) return false;
+	return (memcmp(cmd, "cReq", 4) == 0);
 }
 
-CmdHandlerStat_t isValidCmd(const char *cmd) {
-	for (int i = 0; i < cmdQty; ++i) {
-		if (0 == strncmp(commands[i].cmdName, cmd, strlen(commands[i].cmdName))) {
-			return CMD_OK;
-		}
-	}
-	return CMD_ERR;
+CmdHandlerStat_t isValidCmd(const char *cmd, size_t len) {
+	return (find_command(cmd, len) != NULL) ? CMD_OK : CMD_ERR;
 }
 
-bool extract_parameter(const char *input, char *output, size_t max_len) {
-	if (!input || !output || max_len == 0) {
+bool get_parameter(const char *input, size_t len, const char **param, size_t *paramLen) {
+	if (!input || !param || !paramLen) {
 		return false;
 	}
 
-	// 找到 '<' 和 '>'
-	char *start = strchr(input, '<');
-	char *end = strchr(input, '>');
+	// 找到 '<' 和 '>'，不超出命令長度
+	const char *start = memchr(input, '<', len);
+	if (!start) {
+		return false;
+	}
+	const char *end = memchr(start + 1, '>', len - (size_t) (start + 1 - input));
 
 	// 檢查格式
-	if (!start || !end || end <= start + 1) {
+	if (!end || end <= start + 1) {
 		return false;
 	}
 
-	// 計算參數長度
-	size_t len = end - start - 1;
-	if (len >= max_len) {
-		len = max_len - 1; // 防止溢出
+	// 參數在 \r\n 處截斷
+	size_t n = 0;
+	while (start + 1 + n < end && start[1 + n] != '\r' && start[1 + n] != '\n') {
+		++n;
 	}
 
-	// 複製參數
-	strncpy(output, start + 1, len);
-	output[len] = '\0';
-
-	// 移除 \r\n
-	for (int i = 0; i < strlen(output); i++) {
-		if (output[i] == '\r' || output[i] == '\n') {
-			output[i] = '\0';
-			break;
+	*param = start + 1;
+	*paramLen = n;
+	return true;
+}
+
+bool get_uint_parameter(const char *input, size_t len, uint32_t *value) {
+	const char *param;
+	size_t paramLen;
+	uint32_t v = 0;
+
+	if (!value || !get_parameter(input, len, &param, &paramLen) || paramLen == 0) {
+		return false;
+	}
+	for (size_t i = 0; i < paramLen; ++i) {
+		if (param[i] < '0' || param[i] > '9') {
+			return false;
+		}
+		uint32_t d = (uint32_t) (param[i] - '0');
+		// 超出 uint32_t 範圍視為格式錯誤，不可回繞
+		if (v > (UINT32_MAX - d) / 10U) {
+			return false;
 		}
+		v = v * 10U + d;
+	}
+	*value = v;
+	return true;
+}
+
+bool extract_parameter(const char *input, size_t len, char *output, size_t max_len) {
+	const char *param;
+	size_t paramLen;
+
+	if (!output || max_len == 0 || !get_parameter(input, len, &param, &paramLen)) {
+		return false;
 	}
 
+	// 防止溢出
+	if (paramLen >= max_len) {
+		paramLen = max_len - 1;
+	}
+
+	// 複製參數
+	memcpy(output, param, paramLen);
+	output[paramLen] = '\0';
 	return true;
 }
 
 #ifdef DEBUG
 void print_all_cmd(void) {
-	for (uint8_t i = 0; i < cmdQty; ++i) {
-		printf("%-20s %s\n", commands[i].cmdName);
+	for (uint32_t i = 0; i < (1U << CMD_HASH_BITS); ++i) {
+		if (cmdHashTable[i].callback != NULL) {
+			LOG_I("%s\r\n", cmdHashTable[i].cmdName);
+		}
 	}
 }
 #endif
@@ -4,38 +4,102 @@
 #include "fileTask.h"
 #include "cmdList.h"
 #include "usart.h"
+#include "link.h"
+#include "telemetry.h"
+#include "estop.h"
 #include "ui_updater.h"
+#include "storage.h"
+#include "heapStats.h"
+#include "sd_bench.h"
+#include "printerController.h"
+#include "boot.h"
+
+#define LOG_MODULE ESP32
+#include "logger.h"
 
 
 #define ESP32_OK				 "ok\n"              //用於與esp32同步狀態
 #define ESP32_DISCONNECTED		 "wifi disconnected" //esp32 wifi異常會發送
 #define ESP32_OVER				 0                   //用於檢查是否收到CMD_Transmisson_Over
-#define CMD_BUF_SIZE		     100
+#define CMD_QUEUE_LEN		     16                  //命令描述佇列長度
+#define LOCAL_CMD_SLOTS		     4                   //本地 (UI) 命令暫存槽數量
+#define LOCAL_CMD_SIZE		     48                  //本地命令最大長度
 #define WAIT_ESP32_READY_TIMEOUT 10                  //最大等待ESP32初始化時間
 
 
+/*
+ * 命令佇列只存放描述 (LinkFrame_TypeDef)，命令本體留在接收緩衝區中，
+ * 由命令任務執行完畢後歸還；本地命令則存放於 localCmdSlot。
+ */
 QueueHandle_t xCmdQueue = NULL;
 StaticQueue_t cmdQueue_s;
-uint8_t cmdQueueArea[10 * CMD_BUF_SIZE];
+uint8_t cmdQueueArea[CMD_QUEUE_LEN * sizeof(LinkFrame_TypeDef)];
+static char localCmdSlot[LOCAL_CMD_SLOTS][LOCAL_CMD_SIZE];
+static uint8_t localCmdBusy = 0; // 每個 bit 代表一個暫存槽
 static ESP32_STATE_TypeDef currentState = ESP32_INIT;
 char ip[15] = {0}; // Initialize to empty string
 bool isWebConnected = false;
 
-void ESP32_Init(void) {
-	Uart_Rx_Pool_Init();
-	ESP32_SetState(ESP32_INIT);
-	memset(pCurrentRxBuf->data, 0, UART_RX_BUFFER_SIZE);
-	HAL_UART_Receive_DMA(&ESP32_USART_PORT, (uint8_t*)pCurrentRxBuf->data, sizeof(pCurrentRxBuf->data));
-	__HAL_UART_ENABLE_IT(&ESP32_USART_PORT, UART_IT_IDLE);
-	ESP32_RegCallback();
+/**
+ * @brief (ISR) 命令通道處理函式
+ * @note  封包內可能有多條以 '\n' 分隔的命令，每條命令各自以
+ *        (指標, 長度) 描述送入 xCmdQueue，並各持有一個緩衝區參考。
+ */
+static bool cmdChannelHandler(const LinkFrame_TypeDef *frame, BaseType_t *pxHigherPriorityTaskWoken) {
+	const char *p = (const char *) frame->data;
+	const char *end = p + frame->len;
+
+	if (xCmdQueue == NULL) {
+		return false;
+	}
+
+	while (p < end) {
+		const char *eol = memchr(p, '\n', (size_t) (end - p));
+		const char *stop = eol ? eol : end;
+		if (stop > p && stop[-1] == '\r') {
+			stop--;
+		}
+
+		// strlen 對字串常數於編譯期求值
+		if ((size_t) (stop - p) == strlen(CMD_Emergency_Stop) &&
+		    memcmp(p, CMD_Emergency_Stop, strlen(CMD_Emergency_Stop)) == 0) {
+			// 緊急停止不排隊，直接喚醒緊急停止任務
+			Estop_TriggerFromISR(pxHigherPriorityTaskWoken);
+		} else if (stop > p) {
+			LinkFrame_TypeDef cmd = {frame->buf, (const uint8_t *) p, (uint16_t) (stop - p), LINK_CH_CMD};
+			// 鏈路層在處理函式返回前持有參考，送出後再加參考不會有競爭
+			if (xQueueSendFromISR(xCmdQueue, &cmd, pxHigherPriorityTaskWoken) == pdTRUE) {
+				Link_RetainFrameFromISR(frame);
+			} else {
+				linkStats.rxDropped++;
+			}
+		}
+		p = eol ? eol + 1 : end;
+	}
+	return false;
+}
+
+/**
+ * @brief 歸還命令描述所佔用的接收緩衝區或本地暫存槽
+ */
+static void cmd_release(const LinkFrame_TypeDef *cmd) {
+	if (cmd->buf != NULL) {
+		Link_ReleaseFrame(cmd);
+		return;
+	}
+
+	uint32_t slot = (uint32_t) ((const char *) cmd->data - localCmdSlot[0]) / LOCAL_CMD_SIZE;
+	if (slot < LOCAL_CMD_SLOTS) {
+		taskENTER_CRITICAL();
+		localCmdBusy &= (uint8_t) ~(1U << slot);
+		taskEXIT_CRITICAL();
+	}
 }
 
-void ESP32_RegCallback(void) {
-	register_command(CMD_WIFI_STATUS, WifiStatusHandler);
-	register_command(CMD_Start_Transmisson, StartTransmissionHandler);
-	register_command(CMD_Transmisson_Over, TransmissionOverHandler);
-	register_command(CMD_SET_FILENAME, SetFileNameHandler);
-	register_command(CMD_CLIENT_STATUS, WebStatusHandler);
+void ESP32_Init(void) {
+	ESP32_SetState(ESP32_INIT);
+	Link_SetRxHandler(LINK_CH_CMD, cmdChannelHandler);
+	Link_Init();
 }
 
 ESP32_STATE_TypeDef ESP32_GetState(void) {
@@ -46,31 +110,67 @@ void ESP32_SetState(ESP32_STATE_TypeDef state) {
 	currentState = state;
 }
 
+bool ESP32_PostCommand(const char *cmd) {
+	uint32_t slot;
+	size_t len;
+
+	if (cmd == NULL || xCmdQueue == NULL) {
+		return false;
+	}
+	len = strnlen(cmd, LOCAL_CMD_SIZE);
+	if (len == 0 || len >= LOCAL_CMD_SIZE) {
+		return false;
+	}
+
+	taskENTER_CRITICAL();
+	for (slot = 0; slot < LOCAL_CMD_SLOTS; slot++) {
+		if ((localCmdBusy & (1U << slot)) == 0) {
+			localCmdBusy |= (uint8_t) (1U << slot);
+			break;
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	if (slot == LOCAL_CMD_SLOTS) {
+		LOG_W("local cmd slots full\r\n");
+		return false;
+	}
+
+	memcpy(localCmdSlot[slot], cmd, len);
+	LinkFrame_TypeDef desc = {NULL, (const uint8_t *) localCmdSlot[slot], (uint16_t) len, LINK_CH_CMD};
+	if (xQueueSend(xCmdQueue, &desc, 0) != pdTRUE) {
+		cmd_release(&desc);
+		return false;
+	}
+	return true;
+}
+
 void ESP32_CmdHandler_Task(void *argument) {
-	char _cmdBuf[CMD_BUF_SIZE] = {0};
+	LinkFrame_TypeDef cmd;
 	static ResStruct_t resStruct; //回調函數返回結構體
-	xCmdQueue = xQueueCreateStatic(10,
-	                               CMD_BUF_SIZE,
+	xCmdQueue = xQueueCreateStatic(CMD_QUEUE_LEN,
+	                               sizeof(LinkFrame_TypeDef),
 	                               cmdQueueArea,
 	                               &cmdQueue_s);
 	if (xCmdQueue == NULL) {
-		printf("%-20s rxTask init failed!\r\n", "[esp32.c]");
+		LOG_E("rxTask init failed!\r\n");
 		Error_Handler();
 	}
+	vQueueAddToRegistry(xCmdQueue, "cmdQ");
 
 	while (1) {
-		if (xQueueReceive(xCmdQueue, _cmdBuf, pdMS_TO_TICKS(1000))) {
-			_cmdBuf[CMD_BUF_SIZE - 1] = '\0';
-			if (isValidCmd(_cmdBuf) == CMD_OK) {
-				execute_command(_cmdBuf, isReqCmd(_cmdBuf) ? &resStruct : NULL);
+		if (xQueueReceive(xCmdQueue, &cmd, pdMS_TO_TICKS(1000))) {
+			const char *cmdStr = (const char *) cmd.data;
+			// 單次雜湊查表，未知命令由 execute_command 回報；參數由回調函數就地解析
+			if (execute_command(cmdStr, cmd.len, isReqCmd(cmdStr, cmd.len) ? &resStruct : NULL) == CMD_OK) {
 				if (strlen(resStruct.resBuf) != 0) {
-					UART_SendString_DMA(&ESP32_USART_PORT, resStruct.resBuf);
+					Link_SendString(LINK_CH_RSP, resStruct.resBuf);
 					memset(resStruct.resBuf, 0, RESBUF_SIZE);
 				}
 			} else {
-				printf("%-20s unvalid cmd\r\n", "[esp32.c]");
+				LOG_W("unvalid cmd\r\n");
 			}
-			memset(_cmdBuf, 0, CMD_BUF_SIZE);
+			cmd_release(&cmd);
 		} else {
 			// 監控stack用量
 			// printf("%-20s stack high water mark: %d\r\n", "[esp32.c]", uxTaskGetStackHighWaterMark(NULL));
@@ -78,119 +178,179 @@ void ESP32_CmdHandler_Task(void *argument) {
 	}
 }
 
-void WifiStatusHandler(const char *args, ResStruct_t *_resStruct) {
+void WifiStatusHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
 	char wifiStatus[20] = {0};
 
-	extract_parameter(args, wifiStatus, 20);
+	extract_parameter(args, len, wifiStatus, 20);
 	if (wifiStatus[0] == '1') {
 		strncpy(ip, wifiStatus + 1, 15);
 		ip[14] = '\0'; // Ensure null termination
-		printf("%-20s Wifi connected @ %s\r\n", "[esp32.c]", ip);
+		LOG_I("Wifi connected @ %s\r\n", ip);
 		ESP32_SetState(ESP32_IDLE);
 	} else {
 		memset(ip, 0, sizeof(ip)); // Clear IP on disconnect
-		printf("%-20s Wifi disconnected\r\n", "[esp32.c]");
+		LOG_I("Wifi disconnected\r\n");
 		ESP32_SetState(ESP32_INIT);
 	}
 }
 
-void WebStatusHandler(const char *args, ResStruct_t *_resStruct) {
-	char status[5];
-	extract_parameter(args, status, 5);
-	isWebConnected = (bool)atol(status);
+void WebStatusHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
+	uint32_t status = 0;
+	get_uint_parameter(args, len, &status);
+	isWebConnected = (status != 0);
+	if (isWebConnected) {
+		// 新連線的網頁需要完整狀態
+		Telemetry_RequestKeyframe();
+	}
 }
 
-void StartTransmissionHandler(const char *args, ResStruct_t *_resStruct) {
+void StartTransmissionHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
+	uint32_t fileSize;
+
+	if (!Boot_StorageReady()) {
+		LOG_W("storage not ready, upload rejected\r\n");
+		Link_SendString(LINK_CH_RSP, "Error: booting\n");
+		return;
+	}
+	if (SdBench_IsRunning()) {
+		LOG_W("SD bench running, upload rejected\r\n");
+		Link_SendString(LINK_CH_RSP, "Error: busy\n");
+		return;
+	}
+
+	// 可選參數 cStartTransmission<size>：空間不足時事先拒絕，不等寫到一半才失敗
+	if (memchr(args, '<', len) != NULL) {
+		// 有參數但格式錯誤時不可當作省略，否則會略過空間檢查
+		if (!get_uint_parameter(args, len, &fileSize)) {
+			LOG_W("Invalid upload size\r\n");
+			Link_SendString(LINK_CH_RSP, "Error: invalid size\n");
+			return;
+		}
+		StorageFit_TypeDef fit = Storage_CheckFits(fileSize);
+		if (fit == STORAGE_NO_SPACE) {
+			LOG_W("upload of %lu bytes rejected, no space\r\n", (unsigned long) fileSize);
+			Link_SendString(LINK_CH_RSP, "Error: no space\n");
+			return;
+		}
+		if (fit == STORAGE_UNKNOWN) {
+			LOG_W("free space not counted yet, accepting upload\r\n");
+		}
+	}
+
+	// 鏈路層有獨立封包與緩衝，不再需要等待 ESP32_RECV_DELAY 才回應
 	ESP32_SetState(ESP32_BUSY);
-	vTaskDelay(ESP32_RECV_DELAY);
-	UART_SendString_DMA(&ESP32_USART_PORT, "STM ok\n");
+	Link_SendString(LINK_CH_RSP, "STM ok\n");
 }
 
-char hashVal[SHA256_HASH_SIZE]; // 傳址給檔案接收任務
 GcodeTaskArgs_t gcodeTaskArgs;
 
-void SetFileNameHandler(const char *args, ResStruct_t *_resStruct) {
+/**
+ * @note 非同步：建立接收任務後立即回傳 job id，
+ *       開檔結果由 Gcode_RxHandler_Task 以完成事件回報。
+ */
+void SetFileNameHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
+	uint16_t jobId = ESP32_JobStart();
+
 	curFileName[FILENAME_SIZE - 1] = '\0';
 
-	if (false == extract_parameter(args, curFileName, FILENAME_SIZE)) {
-		ESP32_SetState(ESP32_IDLE);
-		printf("%-20s Invalid filename format\r\n", "[esp32.c]");
+	if (gcodeRxTaskHandle != NULL) {
+		LOG_W("Gcode task is still running\r\n");
+		ESP32_JobComplete(jobId, false, "busy");
+		return;
+	}
+	if (SdBench_IsRunning()) {
+		LOG_W("SD bench running, upload rejected\r\n");
+		ESP32_JobComplete(jobId, false, "busy");
+		return;
+	}
+	if (!Boot_StorageReady()) {
+		LOG_W("storage not ready, upload rejected\r\n");
+		ESP32_JobComplete(jobId, false, "booting");
 		return;
 	}
-	printf("%-20s %-30s %s\r\n", "[esp32.c]", "received file name :", curFileName);
-	printf("%-20s %-30s free heap: %d bytes \r\n",
-	       "[esp32.c]",
-	       "ready to creat Gcode task",
-	       xPortGetFreeHeapSize());
-
-	gcodeTaskArgs.ownerTaskHandle = xTaskGetCurrentTaskHandle();
-	gcodeTaskArgs.hashResult = hashVal;
 
-	gcodeRxTaskHandle = osThreadNew(Gcode_RxHandler_Task, &gcodeTaskArgs, &gcodeTask_attributes);
-	if (gcodeRxTaskHandle == NULL) {
+	if (false == extract_parameter(args, len, curFileName, FILENAME_SIZE)) {
 		ESP32_SetState(ESP32_IDLE);
-		printf("%-20s Error creating gcode task\r\n", "[esp32.c]");
+		LOG_W("Invalid filename format\r\n");
+		ESP32_JobComplete(jobId, false, "bad filename");
 		return;
 	}
+	LOG_I("received file name: %s\r\n", curFileName);
+	LOG_D("ready to create Gcode task, free heap: %u bytes\r\n", (unsigned int) xPortGetFreeHeapSize());
 
-	// 等待 Gcode_RxHandler_Task 初始化完成，最長等待 5 秒
-	if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(5000)) == 0) {
-		// 如果超時，說明 Gcode_RxHandler_Task 初始化失敗 (例如 f_open 失敗)
-		printf("%-20s Gcode_RxHandler_Task init failed or timeout\r\n", "[esp32.c]");
-		if (gcodeRxTaskHandle != NULL) {
-			vTaskDelete(gcodeRxTaskHandle);
-			gcodeRxTaskHandle = NULL;
-		}
+	memset(&gcodeTaskArgs, 0, sizeof(gcodeTaskArgs));
+	gcodeTaskArgs.openJobId = jobId;
+
+	// 上一個上傳已結束 (見上方檢查)；列印仍在進行時其配置必然存活，只重設基準
+	HeapStats_JobMark("upload", pcTaskHandle == NULL);
+	gcodeRxTaskHandle = osThreadNew(Gcode_RxHandler_Task, &gcodeTaskArgs, &gcodeTask_attributes);
+	if (gcodeRxTaskHandle == NULL) {
 		ESP32_SetState(ESP32_IDLE);
-		UART_SendString_DMA(&ESP32_USART_PORT, "Error: File open failed\n");
+		LOG_E("Error creating gcode task\r\n");
+		ESP32_JobComplete(jobId, false, "no memory");
 		return;
 	}
 }
 
 /**
- * @note 暫時改用接收與上傳行數驗證
+ * @note 非同步：通知接收任務結束後立即返回，
+ *       雜湊比對於接收任務收尾時完成並以完成事件回報。
  */
-void TransmissionOverHandler(const char *args, ResStruct_t *_resStruct) {
-	delete = true;
-	uartRxBuf_TypeDef *pNullBuf = NULL;
-	
+void TransmissionOverHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
+	uint16_t jobId = ESP32_JobStart();
+	bool running;
+	LinkFrame_TypeDef endFrame = {NULL, NULL, 0, LINK_CH_FILE}; // 結束信號，喚醒接收任務
+
+	// 與接收任務收尾互斥：任務仍在時才把驗證工作交給它
+	taskENTER_CRITICAL();
+	running = (gcodeRxTaskHandle != NULL);
+	if (running) {
+		gcodeTaskArgs.expectedHash[0] = '\0';
+		extract_parameter(args, len, gcodeTaskArgs.expectedHash, SHA256_HASH_SIZE);
+		gcodeTaskArgs.overJobId = jobId;
+		delete = true;
+	}
+	taskEXIT_CRITICAL();
+
+	ESP32_SetState(ESP32_IDLE);
+	Link_SendString(LINK_CH_RSP, ESP32_OK);
+
+	if (!running) {
+		LOG_W("no transmission in progress\r\n");
+		ESP32_JobComplete(jobId, false, "not receiving");
+		return;
+	}
+
 	// 檢查佇列是否存在，避免在任務已因錯誤結束後存取空指標
 	if (xFileQueue != NULL) {
-		xQueueSend(xFileQueue, &pNullBuf, pdMS_TO_TICKS(10));
+		xQueueSend(xFileQueue, &endFrame, 0);
 	}
+}
 
-	vTaskDelay(pdMS_TO_TICKS(10));
-	ESP32_SetState(ESP32_IDLE);
-	UART_SendString_DMA(&ESP32_USART_PORT, ESP32_OK);
+uint16_t ESP32_JobStart(void) {
+	static uint16_t nextJobId = 0;
+	char msg[16];
+	uint16_t id;
 
-	// 等待任務終止
-	if (gcodeRxTaskHandle != NULL) {
-		for (int i = 0; i < 1000; i++) {
-			if (gcodeRxTaskHandle == NULL) {
-				break;
-			}
-			vTaskDelay(pdMS_TO_TICKS(10));
-		}
+	taskENTER_CRITICAL();
+	if (++nextJobId == 0) {
+		++nextJobId; // 0 保留為「無工作」
 	}
-	char srcHash[70] = {0};
-	extract_parameter(args, srcHash, SHA256_HASH_SIZE);
-	hashVal[SHA256_HASH_SIZE - 1] = '\0';
+	id = nextJobId;
+	taskEXIT_CRITICAL();
 
-	if (strcmp(srcHash, hashVal) == 0) {
-		printf("%-20s File %s verification succeeded\r\n", "[esp32.c]", curFileName);
-	} else {
-		// // 驗證不過再驗證一次 再不對叫網頁重發一次
-		// memset(hashVal, 0, SHA256_HASH_SIZE);
-		// // calFileHash(hashVal);
-		// if (strcmp(srcHash, hashVal) == 0) {
-		// 	printf("%-20s File %s reverification succeeded\r\n", "[esp32.c]", curFileName);
-		// } else {
-		// 	printf("%-20s File %s verification failed\r\n", "[esp32.c]", curFileName);
-		// 	// sendString_to_Esp32(ERROR_FILE_BROKEN);
-		// }
-	}
-	printf("%-20s \r\n======================TransMission Successed=====================\r\n", "[esp32.c]");
-	UI_Show_FileUploadSuccess();
-	ESP32_SetState(ESP32_IDLE);
-	UART_SendString_DMA(&ESP32_USART_PORT, ESP32_OK);
-}
\ No newline at end of file
+	snprintf(msg, sizeof(msg), "job:%u\n", id);
+	Link_SendString(LINK_CH_RSP, msg);
+	return id;
+}
+
+void ESP32_JobComplete(uint16_t jobId, bool success, const char *detail) {
+	char msg[LINK_MAX_TX_PAYLOAD + 1];
+
+	if (jobId == 0) {
+		return;
+	}
+	snprintf(msg, sizeof(msg), "done:%u:%s%s%s\n", jobId, success ? "ok" : "err",
+	         detail ? ":" : "", detail ? detail : "");
+	Link_SendString(LINK_CH_EVENT, msg);
+}
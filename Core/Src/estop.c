@@ -0,0 +1,131 @@
+/**
+ * @file    estop.c
+ * @brief   緊急停止快速通道，流程見 estop.h
+ */
+
+#include "estop.h"
+#include <stdio.h>
+#include "cmsis_os2.h"
+#include "task.h"
+#include "usart.h"
+#include "link.h"
+#include "printerController.h"
+
+#define LOG_MODULE ESTOP
+#include "logger.h"
+
+#define ESTOP_GCODE          "M112\r\n"  // 於行邊界送出，不需先送換行
+
+static volatile uint32_t triggerCycles;    // 觸發時的 DWT 計數
+static volatile bool triggerPending = false;
+static EstopStats_TypeDef estopStats;
+
+static StaticTask_t estopTaskCb;
+static uint32_t estopTaskStack[configMINIMAL_STACK_SIZE * 2];
+static osThreadId_t estopTaskHandle = NULL;
+static const osThreadAttr_t estopTask_attributes = {
+	.name = "Estop_Task",
+	.cb_mem = &estopTaskCb,
+	.cb_size = sizeof(estopTaskCb),
+	.stack_mem = estopTaskStack,
+	.stack_size = sizeof(estopTaskStack),
+	.priority = (osPriority_t) osPriorityRealtime7, // 系統最高任務優先權
+};
+
+/**
+ * @brief 等印表機 UART 傳輸中的 G-code 行送完後插隊送出 M112，並記錄延遲
+ * @note  不會截斷正在傳送的行；排在後面的 G-code 由 PC_OnEmergencyStop 丟棄。
+ */
+static void estop_send_m112(void) {
+	HAL_StatusTypeDef status = UART_SendUrgent(&PRINTING_USART_PORT, ESTOP_GCODE);
+	uint32_t cycles = DWT->CYCCNT - triggerCycles;
+
+	estopStats.lastCycles = cycles;
+	if (cycles > estopStats.maxCycles) {
+		estopStats.maxCycles = cycles;
+	}
+	if (status != HAL_OK) {
+		LOG_E("M112 send failed (%d)\r\n", (int) status);
+	}
+}
+
+static void Estop_Task(void *argument) {
+	for (;;) {
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		if (!triggerPending) {
+			continue;
+		}
+
+		estop_send_m112();
+		triggerPending = false;
+		estopStats.count++;
+
+		// 停止列印任務、丟棄排隊中的 G-code 後關閉加熱器 (經由一般 DMA 佇列送出)
+		PC_OnEmergencyStop();
+		LOG_I("M112 sent, latency %lu us (max %lu us)\r\n",
+		      (unsigned long) (estopStats.lastCycles / (SystemCoreClock / 1000000U)),
+		      (unsigned long) (estopStats.maxCycles / (SystemCoreClock / 1000000U)));
+	}
+}
+
+/**
+ * @brief (ISR) 緊急停止通道處理函式，內容不重要，收到即觸發
+ */
+static bool estopChannelHandler(const LinkFrame_TypeDef *frame, BaseType_t *pxHigherPriorityTaskWoken) {
+	Estop_TriggerFromISR(pxHigherPriorityTaskWoken);
+	return false;
+}
+
+void Estop_Init(void) {
+	// 啟用 DWT 週期計數器；只取差值，不重設計數 (事件追蹤共用，見 trace.h)
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	estopTaskHandle = osThreadNew(Estop_Task, NULL, &estopTask_attributes);
+	if (estopTaskHandle == NULL) {
+		LOG_E("Estop task create failed!\r\n");
+		return;
+	}
+	Link_SetRxHandler(LINK_CH_ESTOP, estopChannelHandler);
+}
+
+void Estop_TriggerFromISR(BaseType_t *pxHigherPriorityTaskWoken) {
+	if (estopTaskHandle == NULL) {
+		return;
+	}
+	// 連續觸發時保留第一次的時間點
+	if (!triggerPending) {
+		triggerCycles = DWT->CYCCNT;
+		triggerPending = true;
+	}
+	vTaskNotifyGiveFromISR((TaskHandle_t) estopTaskHandle, pxHigherPriorityTaskWoken);
+}
+
+void Estop_Trigger(void) {
+	if (estopTaskHandle == NULL) {
+		return;
+	}
+	taskENTER_CRITICAL();
+	if (!triggerPending) {
+		triggerCycles = DWT->CYCCNT;
+		triggerPending = true;
+	}
+	taskEXIT_CRITICAL();
+	xTaskNotifyGive((TaskHandle_t) estopTaskHandle);
+}
+
+void Estop_GetStats(EstopStats_TypeDef *stats) {
+	if (stats != NULL) {
+		*stats = estopStats;
+	}
+}
+
+void GetEstopLatencyHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
+	uint32_t cyclesPerUs = SystemCoreClock / 1000000U;
+
+	if (_resStruct != NULL) {
+		snprintf(_resStruct->resBuf, sizeof(_resStruct->resBuf), "EstopLatency:%lu,%lu\n",
+		         (unsigned long) (estopStats.lastCycles / cyclesPerUs),
+		         (unsigned long) (estopStats.maxCycles / cyclesPerUs));
+	}
+}
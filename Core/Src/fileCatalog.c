@@ -0,0 +1,758 @@
+/**
+ * @file    fileCatalog.c
+ * @brief   SD 卡檔案目錄索引，格式見 fileCatalog.h
+ *
+ *          索引檔不常駐開啟，每次操作時開啟、完成後關閉，且同一時間
+ *          只使用一個檔案物件 (重建時另加一個目錄物件)，
+ *          上傳與列印同時進行時仍在 _FS_LOCK 的上限內。
+ *          fast-seek 對照表檔同樣以 catFile 存取。
+ */
+
+#include "fileCatalog.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "task.h"
+#include "link.h"
+#include "fileTask.h"
+#include "printerController.h"
+#include "boot.h"
+
+#define LOG_MODULE CATALOG
+#include "logger.h"
+
+#define CATALOG_RECORD_OFFSET(slot) (sizeof(CatalogHeader_TypeDef) + (DWORD) (slot) * sizeof(CatalogRecord_TypeDef))
+
+_Static_assert(CATALOG_MAX_FILES < CATALOG_HASH_BUCKETS, "hash table must be larger than the slot count");
+_Static_assert((CATALOG_HASH_BUCKETS & (CATALOG_HASH_BUCKETS - 1)) == 0, "bucket count must be a power of two");
+_Static_assert(CATALOG_MAX_FILES < 255, "bucket entries are 8-bit slot numbers");
+
+typedef struct {
+	const char *tag;
+	uint8_t field;
+} HeaderTag_TypeDef;
+
+enum {
+	TAG_PRINT_TIME = 0,
+	TAG_FILAMENT,
+	TAG_LAYERS
+};
+
+/*  支援的切片軟體檔頭標記  */
+static const HeaderTag_TypeDef headerTags[] = {
+	{";Print time: ",      TAG_PRINT_TIME},
+	{";TIME:",             TAG_PRINT_TIME},
+	{";Filament used: ",   TAG_FILAMENT},
+	{";Filament length: ", TAG_FILAMENT},
+	{";LAYER_COUNT:",      TAG_LAYERS},
+	{";Layer count: ",     TAG_LAYERS},
+};
+
+static StaticSemaphore_t catalogMutexBuf;
+static SemaphoreHandle_t catalogMutex = NULL;
+
+static CatalogHeader_TypeDef catHdr;
+static uint32_t slotHash[CATALOG_MAX_FILES];      // 各位置檔名雜湊，0 表示空位
+static uint8_t bucket[CATALOG_HASH_BUCKETS];      // 雜湊表，內容為位置 + 1，0 表示空
+static bool catDirty = false;                     // 索引檔寫入失敗，與目錄不一致
+
+/*  以下靜態物件皆受 catalogMutex 保護  */
+static FIL catFile;
+static DIR catDir;
+static FILINFO catFno;
+static char catLfnBuf[_MAX_LFN + 1];
+static CatalogRecord_TypeDef catRec;
+static char headerBuf[CATALOG_HEADER_SCAN];
+
+static uint32_t name_hash(const char *name) {
+	uint32_t h = 0x811C9DC5U; // FNV-1a
+	while (*name) {
+		h ^= (uint8_t) *name++;
+		h *= 16777619U;
+	}
+	return h ? h : 1U;
+}
+
+static uint32_t fnv_bytes(uint32_t h, const void *data, size_t len) {
+	const uint8_t *p = data;
+	while (len--) {
+		h ^= *p++;
+		h *= 16777619U;
+	}
+	return h;
+}
+
+/**
+ * @brief 單一檔案的特徵值，以短檔名、大小與修改時間計算 (不需解碼長檔名)
+ */
+static uint32_t entry_sig(const FILINFO *fno) {
+	uint32_t h = 0x811C9DC5U;
+	h = fnv_bytes(h, fno->fname, strlen(fno->fname));
+	h = fnv_bytes(h, &fno->fsize, sizeof(fno->fsize));
+	h = fnv_bytes(h, &fno->fdate, sizeof(fno->fdate));
+	h = fnv_bytes(h, &fno->ftime, sizeof(fno->ftime));
+	return h;
+}
+
+static bool is_listed(const FILINFO *fno) {
+	// 跳過目錄、隱藏檔與系統檔 (索引檔本身為隱藏 + 系統)
+	return (fno->fattrib & (AM_DIR | AM_HID | AM_SYS)) == 0;
+}
+
+static bool lock(void) {
+	if (catalogMutex == NULL) {
+		return false;
+	}
+	return xSemaphoreTake(catalogMutex, pdMS_TO_TICKS(CATALOG_LOCK_TIMEOUT_MS)) == pdTRUE;
+}
+
+static void unlock(void) {
+	xSemaphoreGive(catalogMutex);
+}
+
+/*---------------------------------- RAM 雜湊表 ----------------------------------*/
+
+static void bucket_insert(uint32_t slot) {
+	uint32_t i = slotHash[slot] & (CATALOG_HASH_BUCKETS - 1);
+	while (bucket[i] != 0) {
+		i = (i + 1) & (CATALOG_HASH_BUCKETS - 1);
+	}
+	bucket[i] = (uint8_t) (slot + 1);
+}
+
+/**
+ * @brief 刪除後重建雜湊表 (線性探測不便直接移除，重建只需數百次迴圈)
+ */
+static void bucket_rebuild(void) {
+	memset(bucket, 0, sizeof(bucket));
+	for (uint32_t s = 0; s < catHdr.slotCount; s++) {
+		if (slotHash[s] != 0) {
+			bucket_insert(s);
+		}
+	}
+}
+
+static void index_clear(void) {
+	memset(slotHash, 0, sizeof(slotHash));
+	memset(bucket, 0, sizeof(bucket));
+}
+
+/*---------------------------------- 索引檔存取 ----------------------------------*/
+
+static FRESULT rec_read(uint32_t slot, CatalogRecord_TypeDef *rec) {
+	UINT br;
+	FRESULT res = f_lseek(&catFile, CATALOG_RECORD_OFFSET(slot));
+	if (res == FR_OK) {
+		res = f_read(&catFile, rec, sizeof(*rec), &br);
+	}
+	return (res == FR_OK && br != sizeof(*rec)) ? FR_INT_ERR : res;
+}
+
+static FRESULT rec_write(uint32_t slot, const CatalogRecord_TypeDef *rec) {
+	UINT bw;
+	FRESULT res = f_lseek(&catFile, CATALOG_RECORD_OFFSET(slot));
+	if (res == FR_OK) {
+		res = f_write(&catFile, rec, sizeof(*rec), &bw);
+	}
+	return (res == FR_OK && bw != sizeof(*rec)) ? FR_DISK_ERR : res;
+}
+
+static FRESULT hdr_write(void) {
+	UINT bw;
+	FRESULT res = f_lseek(&catFile, 0);
+	if (res == FR_OK) {
+		res = f_write(&catFile, &catHdr, sizeof(catHdr), &bw);
+	}
+	return (res == FR_OK && bw != sizeof(catHdr)) ? FR_DISK_ERR : res;
+}
+
+/**
+ * @brief 以雜湊表查詢檔名，索引檔須已開啟；找到時紀錄留在 rec 中
+ * @return 紀錄位置，找不到時回傳 -1
+ */
+static int32_t index_find(const char *name, CatalogRecord_TypeDef *rec) {
+	uint32_t h = name_hash(name);
+	uint32_t i = h & (CATALOG_HASH_BUCKETS - 1);
+
+	while (bucket[i] != 0) {
+		uint32_t slot = bucket[i] - 1U;
+		// 雜湊相同才讀取紀錄比對完整檔名
+		if (slotHash[slot] == h && rec_read(slot, rec) == FR_OK && strcmp(rec->name, name) == 0) {
+			return (int32_t) slot;
+		}
+		i = (i + 1) & (CATALOG_HASH_BUCKETS - 1);
+	}
+	return -1;
+}
+
+/**
+ * @brief 走訪根目錄計算特徵值 (不解碼長檔名)
+ */
+static FRESULT dir_signature(uint16_t *count, uint32_t *sig) {
+	FRESULT res;
+
+	*count = 0;
+	*sig = 0;
+	res = f_opendir(&catDir, "/");
+	if (res != FR_OK) {
+		return res;
+	}
+	catFno.lfname = NULL;
+	catFno.lfsize = 0;
+	for (;;) {
+		res = f_readdir(&catDir, &catFno);
+		if (res != FR_OK || catFno.fname[0] == 0) {
+			break;
+		}
+		if (is_listed(&catFno)) {
+			(*count)++;
+			*sig ^= entry_sig(&catFno);
+		}
+	}
+	f_closedir(&catDir);
+	return res;
+}
+
+/**
+ * @brief 讀取 G-code 檔頭並填入紀錄的列印資訊 (使用 catFile，呼叫前須先關閉索引檔)
+ */
+static void scan_header(const char *name, CatalogRecord_TypeDef *rec) {
+	UINT br = 0;
+
+	rec->printSeconds = CATALOG_UNKNOWN;
+	rec->filamentMm = CATALOG_UNKNOWN;
+	rec->layers = CATALOG_UNKNOWN;
+	if (f_open(&catFile, name, FA_READ) != FR_OK) {
+		return;
+	}
+	f_read(&catFile, headerBuf, sizeof(headerBuf) - 1, &br);
+	f_close(&catFile);
+	headerBuf[br] = '\0';
+	Catalog_ParseHeader(headerBuf, rec);
+}
+
+static void record_from_fno(CatalogRecord_TypeDef *rec, const char *name, const FILINFO *fno) {
+	memset(rec, 0, sizeof(*rec));
+	rec->used = 1;
+	rec->fdate = fno->fdate;
+	rec->ftime = fno->ftime;
+	rec->size = fno->fsize;
+	rec->entrySig = entry_sig(fno);
+	strncpy(rec->name, name, sizeof(rec->name) - 1);
+}
+
+static FRESULT catalog_create(void) {
+	FRESULT res = f_open(&catFile, CATALOG_FILE_NAME, FA_CREATE_ALWAYS | FA_WRITE);
+	if (res != FR_OK) {
+		return res;
+	}
+	catHdr.magic = CATALOG_MAGIC;
+	catHdr.version = CATALOG_VERSION;
+	catHdr.recordSize = sizeof(CatalogRecord_TypeDef);
+	catHdr.signature = 0;
+	catHdr.fileCount = 0;
+	catHdr.slotCount = 0;
+	res = hdr_write();
+	f_close(&catFile);
+
+	// 隱藏索引檔，不出現在檔案清單與特徵值中
+	f_chmod(CATALOG_FILE_NAME, AM_HID | AM_SYS, AM_HID | AM_SYS);
+	return res;
+}
+
+/**
+ * @brief 走訪根目錄重建整個索引，失敗時標記 catDirty 於下一次存取再重建
+ * @note  目錄保持開啟，每個檔案輪流以 catFile 讀取檔頭、寫入索引檔
+ */
+static FRESULT catalog_rebuild(void) {
+	FRESULT res, hres;
+	TickType_t start = xTaskGetTickCount();
+
+	// 先開啟目錄：開不了時保留現有索引，不清空
+	res = f_opendir(&catDir, "/");
+	if (res != FR_OK) {
+		LOG_E("Failed to open root dir, err=%d\r\n", res);
+		catDirty = true;
+		return res;
+	}
+	index_clear();
+	res = catalog_create();
+	if (res != FR_OK) {
+		LOG_E("Failed to create catalog, err=%d\r\n", res);
+		f_closedir(&catDir);
+		catDirty = true;
+		return res;
+	}
+
+	catFno.lfname = catLfnBuf;
+	catFno.lfsize = sizeof(catLfnBuf);
+	for (;;) {
+		catLfnBuf[0] = '\0';
+		res = f_readdir(&catDir, &catFno);
+		if (res != FR_OK || catFno.fname[0] == 0) {
+			break;
+		}
+		if (!is_listed(&catFno)) {
+			continue;
+		}
+		if (catHdr.slotCount >= CATALOG_MAX_FILES) {
+			LOG_W("Catalog full, remaining files are not indexed\r\n");
+			break;
+		}
+
+		const char *name = (catFno.lfname[0] != 0) ? catFno.lfname : catFno.fname;
+		uint32_t slot = catHdr.slotCount;
+		record_from_fno(&catRec, name, &catFno);
+		scan_header(name, &catRec);
+
+		res = f_open(&catFile, CATALOG_FILE_NAME, FA_WRITE);
+		if (res != FR_OK) {
+			break;
+		}
+		res = rec_write(slot, &catRec);
+		f_close(&catFile);
+		if (res != FR_OK) {
+			break;
+		}
+
+		slotHash[slot] = name_hash(name);
+		bucket_insert(slot);
+		catHdr.slotCount++;
+		catHdr.fileCount++;
+		catHdr.signature ^= catRec.entrySig;
+	}
+	f_closedir(&catDir);
+
+	// 目錄未完整走訪時特徵值不符，下次開機會再重建
+	hres = f_open(&catFile, CATALOG_FILE_NAME, FA_WRITE);
+	if (hres == FR_OK) {
+		hres = hdr_write();
+		if (f_close(&catFile) != FR_OK && hres == FR_OK) {
+			hres = FR_DISK_ERR;
+		}
+	}
+	if (res == FR_OK) {
+		res = hres;
+	}
+	catDirty = (res != FR_OK);
+	if (res != FR_OK) {
+		LOG_E("Catalog rebuild failed, err=%d\r\n", res);
+		return res;
+	}
+	LOG_I("Catalog rebuilt: %u files in %lums\r\n", catHdr.fileCount, (unsigned long) (xTaskGetTickCount() - start));
+	return res;
+}
+
+/**
+ * @brief 索引檔寫入失敗後於下一次存取時重建，須持有 catalogMutex
+ */
+static void catalog_repair(void) {
+	if (catDirty) {
+		catalog_rebuild(); // 失敗時仍為 dirty，下一次存取再試
+	}
+}
+
+/**
+ * @brief 讀取既有索引檔並建立雜湊表
+ * @return false 表示索引檔不存在、格式不符或與根目錄不一致
+ */
+static bool catalog_load(void) {
+	UINT br;
+	uint16_t count;
+	uint32_t sig;
+	bool ok = true;
+
+	index_clear();
+	if (f_open(&catFile, CATALOG_FILE_NAME, FA_READ) != FR_OK) {
+		return false;
+	}
+	if (f_read(&catFile, &catHdr, sizeof(catHdr), &br) != FR_OK || br != sizeof(catHdr) ||
+	    catHdr.magic != CATALOG_MAGIC || catHdr.version != CATALOG_VERSION ||
+	    catHdr.recordSize != sizeof(CatalogRecord_TypeDef) || catHdr.slotCount > CATALOG_MAX_FILES) {
+		f_close(&catFile);
+		return false;
+	}
+	for (uint32_t s = 0; s < catHdr.slotCount && ok; s++) {
+		ok = rec_read(s, &catRec) == FR_OK;
+		if (ok && catRec.used) {
+			catRec.name[sizeof(catRec.name) - 1] = '\0';
+			slotHash[s] = name_hash(catRec.name);
+			bucket_insert(s);
+		}
+	}
+	f_close(&catFile);
+	if (!ok) {
+		return false;
+	}
+
+	if (dir_signature(&count, &sig) != FR_OK || count != catHdr.fileCount || sig != catHdr.signature) {
+		LOG_W("Card changed (files %u/%u)\r\n", count, catHdr.fileCount);
+		return false;
+	}
+	return true;
+}
+
+/*---------------------------------- 對外介面 ----------------------------------*/
+
+void Catalog_Init(void) {
+	if (catalogMutex == NULL) {
+		catalogMutex = xSemaphoreCreateMutexStatic(&catalogMutexBuf);
+		vQueueAddToRegistry(catalogMutex, "catalog");
+	}
+	if (!lock()) {
+		return;
+	}
+	if (catalog_load()) {
+		LOG_I("Catalog loaded: %u files\r\n", catHdr.fileCount);
+	} else {
+		catalog_rebuild();
+	}
+	unlock();
+}
+
+static uint32_t parse_print_time(const char *pos) {
+	int hours = 0, minutes = 0, seconds = 0;
+
+	// 解析時間格式，可能是 "HH:MM:SS" 或 "MM:SS" 或只有秒數
+	int parsed = sscanf(pos, "%d:%d:%d", &hours, &minutes, &seconds);
+	if (parsed == 3) {
+		return (uint32_t) (hours * 3600 + minutes * 60 + seconds);
+	} else if (parsed == 2) {
+		return (uint32_t) (hours * 60 + minutes);
+	}
+	return (uint32_t) atoi(pos);
+}
+
+/**
+ * @brief 解析耗材長度 "1.234m" 或 "1234.5 mm"，不使用浮點數
+ */
+static uint32_t parse_filament_mm(const char *pos) {
+	char *end;
+	uint32_t whole = strtoul(pos, &end, 10);
+	uint32_t frac = 0, scale = 1;
+
+	if (*end == '.') {
+		end++;
+		while (*end >= '0' && *end <= '9') {
+			if (scale < 1000) {
+				frac = frac * 10U + (uint32_t) (*end - '0');
+				scale *= 10U;
+			}
+			end++;
+		}
+	}
+	while (*end == ' ') {
+		end++;
+	}
+	if (end[0] == 'm' && end[1] != 'm') {
+		return whole * 1000U + frac * (1000U / scale); // 公尺
+	}
+	return whole;
+}
+
+bool Catalog_ParseHeader(const char *header, CatalogRecord_TypeDef *rec) {
+	bool found = false;
+
+	rec->printSeconds = CATALOG_UNKNOWN;
+	rec->filamentMm = CATALOG_UNKNOWN;
+	rec->layers = CATALOG_UNKNOWN;
+	for (size_t i = 0; i < sizeof(headerTags) / sizeof(headerTags[0]); i++) {
+		const char *pos = strstr(header, headerTags[i].tag);
+		if (pos == NULL) {
+			continue;
+		}
+		pos += strlen(headerTags[i].tag);
+		switch (headerTags[i].field) {
+			case TAG_PRINT_TIME:
+				if (rec->printSeconds == CATALOG_UNKNOWN) rec->printSeconds = parse_print_time(pos);
+				break;
+			case TAG_FILAMENT:
+				if (rec->filamentMm == CATALOG_UNKNOWN) rec->filamentMm = parse_filament_mm(pos);
+				break;
+			default:
+				if (rec->layers == CATALOG_UNKNOWN) rec->layers = (uint32_t) strtoul(pos, NULL, 10);
+				break;
+		}
+		found = true;
+	}
+	return found;
+}
+
+bool Catalog_AddFile(const char *name, const char *sha256Hex) {
+	FRESULT res;
+	int32_t slot;
+	uint32_t oldSig = 0;
+
+	if (name == NULL || name[0] == '\0' || !lock()) {
+		return false;
+	}
+	catalog_repair();
+
+	catFno.lfname = NULL;
+	catFno.lfsize = 0;
+	res = f_stat(name, &catFno);
+	if (res != FR_OK) {
+		unlock();
+		return false;
+	}
+
+	// 找出既有紀錄 (覆寫上傳) 或空位
+	if (f_open(&catFile, CATALOG_FILE_NAME, FA_READ) != FR_OK) {
+		unlock();
+		return false;
+	}
+	slot = index_find(name, &catRec);
+	f_close(&catFile);
+	if (slot >= 0) {
+		oldSig = catRec.entrySig;
+	} else {
+		for (uint32_t s = 0; s < catHdr.slotCount; s++) {
+			if (slotHash[s] == 0) {
+				slot = (int32_t) s;
+				break;
+			}
+		}
+		if (slot < 0) {
+			if (catHdr.slotCount >= CATALOG_MAX_FILES) {
+				LOG_W("Catalog full, %s not indexed\r\n", name);
+				unlock();
+				return false;
+			}
+			slot = catHdr.slotCount++;
+		}
+	}
+
+	record_from_fno(&catRec, name, &catFno);
+	scan_header(name, &catRec);
+	if (sha256Hex != NULL && strlen(sha256Hex) >= sizeof(catRec.sha256) * 2) {
+		for (size_t i = 0; i < sizeof(catRec.sha256); i++) {
+			char byte[3] = {sha256Hex[i * 2], sha256Hex[i * 2 + 1], '\0'};
+			catRec.sha256[i] = (uint8_t) strtoul(byte, NULL, 16);
+		}
+		catRec.hasHash = 1;
+	}
+
+	res = f_open(&catFile, CATALOG_FILE_NAME, FA_WRITE);
+	if (res == FR_OK) {
+		res = rec_write((uint32_t) slot, &catRec);
+		if (res == FR_OK) {
+			if (slotHash[slot] == 0) {
+				catHdr.fileCount++;
+				slotHash[slot] = name_hash(name);
+				bucket_insert((uint32_t) slot);
+			}
+			catHdr.signature ^= oldSig ^ catRec.entrySig;
+			res = hdr_write();
+		}
+		FRESULT closeRes = f_close(&catFile); // 關檔時才寫回扇區，失敗同樣視為寫入失敗
+		if (res == FR_OK) {
+			res = closeRes;
+		}
+		if (res != FR_OK) {
+			catDirty = true;
+		}
+	}
+	unlock();
+
+	if (res != FR_OK) {
+		LOG_E("Failed to index %s, err=%d\r\n", name, res);
+	}
+	return res == FR_OK;
+}
+
+FRESULT Catalog_DeleteFile(const char *name) {
+	FRESULT res;
+	int32_t slot = -1;
+
+	if (name == NULL || name[0] == '\0') {
+		return FR_INVALID_NAME;
+	}
+	if (!lock()) {
+		return FR_TIMEOUT;
+	}
+
+	catalog_repair();
+
+	res = f_unlink(name);
+	if (res != FR_OK) {
+		unlock();
+		return res;
+	}
+
+	// 檔案已刪除：RAM 索引一律移除，索引檔更新失敗時標記待重建
+	res = f_open(&catFile, CATALOG_FILE_NAME, FA_READ | FA_WRITE);
+	if (res == FR_OK) {
+		slot = index_find(name, &catRec);
+		if (slot >= 0) {
+			slotHash[slot] = 0;
+			bucket_rebuild();
+			catHdr.fileCount--;
+			catHdr.signature ^= catRec.entrySig;
+			catRec.used = 0;
+			res = rec_write((uint32_t) slot, &catRec);
+			if (res == FR_OK) {
+				res = hdr_write();
+			}
+		}
+		FRESULT closeRes = f_close(&catFile);
+		if (res == FR_OK) {
+			res = closeRes;
+		}
+	}
+	if (res != FR_OK) {
+		catDirty = true;
+		LOG_E("%s deleted but catalog update failed, err=%d\r\n", name, res);
+	}
+	unlock();
+	return res;
+}
+
+bool Catalog_Lookup(const char *name, CatalogRecord_TypeDef *rec) {
+	int32_t slot = -1;
+
+	if (name == NULL || rec == NULL || !lock()) {
+		return false;
+	}
+	catalog_repair();
+	if (f_open(&catFile, CATALOG_FILE_NAME, FA_READ) == FR_OK) {
+		slot = index_find(name, rec);
+		f_close(&catFile);
+	}
+	unlock();
+	return slot >= 0;
+}
+
+int32_t Catalog_ForEach(uint32_t slot, CatalogVisitor visit, void *ctx) {
+	int32_t next = -1;
+
+	if (visit == NULL || !lock()) {
+		return -2;
+	}
+	catalog_repair();
+	if (f_open(&catFile, CATALOG_FILE_NAME, FA_READ) != FR_OK) {
+		unlock();
+		return -2;
+	}
+	for (uint32_t s = slot; s < catHdr.slotCount; s++) {
+		if (slotHash[s] == 0) {
+			continue;
+		}
+		if (rec_read(s, &catRec) != FR_OK) {
+			next = -2;
+			break;
+		}
+		catRec.name[sizeof(catRec.name) - 1] = '\0';
+		if (!visit(s, &catRec, ctx)) {
+			next = (s + 1 < catHdr.slotCount) ? (int32_t) (s + 1) : -1;
+			break;
+		}
+	}
+	f_close(&catFile);
+	unlock();
+	return next;
+}
+
+/*---------------------------------- fast-seek 對照表 ----------------------------------*/
+
+bool Catalog_LoadSeekMap(const CatalogSeekMap_TypeDef *key, DWORD *tbl, UINT maxWords) {
+	CatalogSeekMap_TypeDef hdr;
+	UINT br = 0;
+	bool ok = false;
+
+	if (key == NULL || tbl == NULL || !lock()) {
+		return false;
+	}
+	if (f_open(&catFile, CATALOG_SEEKMAP_FILE, FA_READ) == FR_OK) {
+		if (f_read(&catFile, &hdr, sizeof(hdr), &br) == FR_OK && br == sizeof(hdr) &&
+		    hdr.magic == CATALOG_SEEKMAP_MAGIC && hdr.sclust == key->sclust && hdr.size == key->size &&
+		    hdr.fdate == key->fdate && hdr.ftime == key->ftime &&
+		    hdr.words >= 2 && hdr.words <= maxWords) {
+			UINT bytes = hdr.words * sizeof(DWORD);
+			ok = f_read(&catFile, tbl, bytes, &br) == FR_OK && br == bytes && tbl[0] == hdr.words;
+		}
+		f_close(&catFile);
+	}
+	unlock();
+	return ok;
+}
+
+bool Catalog_SaveSeekMap(const CatalogSeekMap_TypeDef *key, const DWORD *tbl) {
+	CatalogSeekMap_TypeDef hdr;
+	UINT bw = 0;
+	FRESULT res;
+
+	if (key == NULL || tbl == NULL || tbl[0] < 2 || !lock()) {
+		return false;
+	}
+	hdr = *key;
+	hdr.magic = CATALOG_SEEKMAP_MAGIC;
+	hdr.words = tbl[0];
+
+	res = f_open(&catFile, CATALOG_SEEKMAP_FILE, FA_CREATE_ALWAYS | FA_WRITE);
+	if (res == FR_OK) {
+		res = f_write(&catFile, &hdr, sizeof(hdr), &bw);
+		if (res == FR_OK && bw != sizeof(hdr)) {
+			res = FR_DISK_ERR;
+		}
+		if (res == FR_OK) {
+			res = f_write(&catFile, tbl, hdr.words * sizeof(DWORD), &bw);
+			if (res == FR_OK && bw != hdr.words * sizeof(DWORD)) {
+				res = FR_DISK_ERR;
+			}
+		}
+		f_close(&catFile);
+		// 與索引檔相同，不出現在檔案清單與特徵值中
+		f_chmod(CATALOG_SEEKMAP_FILE, AM_HID | AM_SYS, AM_HID | AM_SYS);
+	}
+	unlock();
+	return res == FR_OK;
+}
+
+void DeleteFileHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
+	static char name[FILENAME_SIZE]; // 靜態避免堆疊溢出
+	FRESULT res;
+	bool existed;
+
+	if (!extract_parameter(args, len, name, sizeof(name))) {
+		LOG_W("Invalid file name\r\n");
+		Link_SendString(LINK_CH_RSP, "Error: invalid name\n");
+		return;
+	}
+	if (!Boot_StorageReady()) {
+		Link_SendString(LINK_CH_RSP, "Error: booting\n");
+		return;
+	}
+
+	// 正在上傳或列印中的檔案不可刪除
+	if ((isTransmittimg || PC_GetState() == PC_BUSY) && strcmp(name, curFileName) == 0) {
+		Link_SendString(LINK_CH_RSP, "Error: file busy\n");
+		return;
+	}
+
+	existed = (f_stat(name, NULL) == FR_OK);
+	res = Catalog_DeleteFile(name);
+	LOG_I("Delete %s, res=%d\r\n", name, res);
+	if (res == FR_OK) {
+		Link_SendString(LINK_CH_RSP, "ok\n");
+	} else if (existed && f_stat(name, NULL) == FR_NO_FILE) {
+		Link_SendString(LINK_CH_RSP, "Error: catalog update failed\n"); // 檔案已刪除，索引將重建
+	} else {
+		Link_SendString(LINK_CH_RSP, "Error: delete failed\n");
+	}
+}
+
+void RebuildCatalogHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
+	FRESULT res = FR_TIMEOUT;
+
+	if (!Boot_StorageReady()) {
+		Link_SendString(LINK_CH_RSP, "Error: booting\n"); // 開機時 Catalog_Init 會自行載入或重建
+		return;
+	}
+	if (lock()) {
+		res = catalog_rebuild(); // 失敗時保持 dirty，下一次存取再重建
+		unlock();
+	}
+	Link_SendString(LINK_CH_RSP, (res == FR_OK) ? "ok\n" : "Error: rebuild failed\n");
+}
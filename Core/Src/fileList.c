@@ -0,0 +1,97 @@
+/**
+ * @file    fileList.c
+ * @brief   SD 卡檔案清單分頁串流，協定見 fileList.h
+ */
+
+#include "fileList.h"
+#include <stdio.h>
+#include <string.h>
+#include "link.h"
+#include "fileCatalog.h"
+#include "boot.h"
+
+#define LOG_MODULE FILELIST
+#include "logger.h"
+
+typedef struct {
+	uint16_t framePos;
+	uint16_t count;
+} ListPage_TypeDef;
+
+static char listFrame[LINK_MAX_TX_PAYLOAD];
+static char listLine[LINK_MAX_TX_PAYLOAD];
+
+/**
+ * @brief 將一行加入封包緩衝區，放不下時先送出
+ */
+static void frame_append(uint16_t *pos, const char *line, uint16_t len) {
+	if (*pos + len > sizeof(listFrame)) {
+		Link_Send(LINK_CH_RSP, listFrame, *pos);
+		*pos = 0;
+	}
+	memcpy(listFrame + *pos, line, len);
+	*pos += len;
+}
+
+static void format_number(char *out, size_t size, uint32_t value) {
+	if (value == CATALOG_UNKNOWN) {
+		strcpy(out, "-");
+	} else {
+		snprintf(out, size, "%lu", (unsigned long) value);
+	}
+}
+
+static bool list_visit(uint32_t slot, const CatalogRecord_TypeDef *rec, void *ctx) {
+	ListPage_TypeDef *page = ctx;
+	char printTime[12], filament[12], layers[12];
+
+	format_number(printTime, sizeof(printTime), rec->printSeconds);
+	format_number(filament, sizeof(filament), rec->filamentMm);
+	format_number(layers, sizeof(layers), rec->layers);
+
+	int n = snprintf(listLine, sizeof(listLine), "%s\t%lu\t%04u-%02u-%02u %02u:%02u\t%s\t%s\t%s\n",
+	                 rec->name, (unsigned long) rec->size,
+	                 (rec->fdate >> 9) + 1980, (rec->fdate >> 5) & 0x0F, rec->fdate & 0x1F,
+	                 rec->ftime >> 11, (rec->ftime >> 5) & 0x3F, printTime, filament, layers);
+	if (n > 0 && n < (int) sizeof(listLine)) {
+		frame_append(&page->framePos, listLine, (uint16_t) n);
+	}
+	page->count++;
+	return page->count < FILE_LIST_PAGE_SIZE;
+}
+
+int32_t FileList_SendPage(uint32_t cursor) {
+	ListPage_TypeDef page = {0};
+	int32_t next;
+	int n;
+
+	if (!Boot_StorageReady()) {
+		Link_SendString(LINK_CH_RSP, "files:booting\n");
+		return -1;
+	}
+	next = Catalog_ForEach(cursor, list_visit, &page);
+	if (next < -1) {
+		LOG_E("Failed to read catalog\r\n");
+		Link_SendString(LINK_CH_RSP, "files:err\n");
+		return -1;
+	}
+
+	// 頁尾摘要行，與最後幾個條目一起送出
+	n = snprintf(listLine, sizeof(listLine), "files:%lu:%u:%ld\n",
+	             (unsigned long) cursor, page.count, (long) next);
+	frame_append(&page.framePos, listLine, (uint16_t) n);
+	Link_Send(LINK_CH_RSP, listFrame, page.framePos);
+	return next;
+}
+
+void ListFilesHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
+	uint32_t cursor = 0;
+
+	// 省略參數時從頭開始
+	if (memchr(args, '<', len) != NULL && !get_uint_parameter(args, len, &cursor)) {
+		LOG_W("Invalid list cursor\r\n");
+		Link_SendString(LINK_CH_RSP, "files:err\n");
+		return;
+	}
+	FileList_SendPage(cursor);
+}
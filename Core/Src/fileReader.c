@@ -0,0 +1,109 @@
+/**
+ * @file    fileReader.c
+ * @brief   循序讀取用的大緩衝區檔案讀取器，說明見 fileReader.h
+ */
+
+#include "fileReader.h"
+#include <string.h>
+
+/**
+ * @brief 目前緩衝區已讀完，讀取下一塊
+ * @return 有新資料
+ */
+static bool reader_fill(FileReader_TypeDef *r) {
+	UINT br = 0;
+
+	if (r->err != FR_OK) {
+		return false;
+	}
+	r->base += r->len;
+	r->len = 0;
+	r->pos = 0;
+	if (r->base >= f_size(r->fp)) {
+		return false; // 檔尾不再讀卡
+	}
+	r->err = f_read(r->fp, r->buf, r->size, &br);
+	r->len = br;
+	return r->err == FR_OK && br > 0;
+}
+
+void FileReader_Init(FileReader_TypeDef *r, FIL *fp, void *buf, UINT size) {
+	r->fp = fp;
+	r->buf = buf;
+	r->size = size;
+	r->len = 0;
+	r->pos = 0;
+	r->base = f_tell(fp);
+	r->err = FR_OK;
+}
+
+char *FileReader_GetLine(FileReader_TypeDef *r, char *line, UINT size) {
+	UINT n = 0;
+
+	if (size == 0) {
+		return NULL;
+	}
+	while (n < size - 1) {
+		if (r->pos >= r->len && !reader_fill(r)) {
+			break;
+		}
+		BYTE c = r->buf[r->pos++];
+#if _USE_STRFUNC == 2
+		if (c == '\r') {
+			continue;
+		}
+#endif
+		line[n++] = (char) c;
+		if (c == '\n') {
+			break;
+		}
+	}
+	line[n] = '\0';
+	return (n > 0) ? line : NULL;
+}
+
+UINT FileReader_Peek(FileReader_TypeDef *r, void *dst, UINT n) {
+	if (r->pos >= r->len && !reader_fill(r)) {
+		return 0;
+	}
+	if (n > r->len - r->pos) {
+		n = r->len - r->pos;
+	}
+	memcpy(dst, r->buf + r->pos, n);
+	return n;
+}
+
+UINT FileReader_Chunk(FileReader_TypeDef *r, const BYTE **data) {
+	UINT n;
+
+	if (r->pos >= r->len && !reader_fill(r)) {
+		return 0;
+	}
+	n = r->len - r->pos;
+	*data = r->buf + r->pos;
+	r->pos = r->len;
+	return n;
+}
+
+FRESULT FileReader_Seek(FileReader_TypeDef *r, DWORD ofs) {
+	DWORD aligned;
+
+	if (r->err == FR_OK && ofs >= r->base && ofs < r->base + r->len) {
+		r->pos = ofs - r->base;
+		return FR_OK;
+	}
+
+	// 從緩衝區長度的整數倍開始讀，之後的補充維持同樣的對齊
+	aligned = ofs - (ofs % r->size);
+	r->err = f_lseek(r->fp, aligned);
+	r->base = aligned;
+	r->len = 0;
+	r->pos = 0;
+	if (r->err != FR_OK) {
+		return r->err;
+	}
+	if (reader_fill(r)) {
+		r->pos = (ofs - aligned < r->len) ? (UINT) (ofs - aligned) : r->len;
+	}
+	return r->err;
+}
@@ -1,21 +1,31 @@
 #include "cmsis_os.h"
 #include "fileTask.h"
 #include "usart.h"
+#include "link.h"
 #include "esp32.h"
 #include "ff_print_err.h"
 #include "ui_updater.h"
-#include "bsp_sdio_sdcard.h"
+#include "cmdList.h"
+#include "fileCatalog.h"
+#include "diskio.h"
+#include "sd_diskio.h"
+#include "trace.h"
+
+#define LOG_MODULE FILETASK
+#include "logger.h"
 
 #define SD_RTY_TIMES			 5			//sd寫檔重試次數
 #define USE_SHA256               1
 #define FILE_QUEUE_LEN			 10
 #define SD_WRITE_DELAY_MS		 2			// 每次寫入前的延遲
+#define UPLOAD_STAGE_SIZE		 4096		// 暫存區大小，湊滿後一次寫入 (多磁區傳輸)
+#define UPLOAD_STAGE_MIN		 2048		// heap 不足時退而求其次的大小
 
 
 osThreadId_t gcodeRxTaskHandle = NULL;
 QueueHandle_t xFileQueue = NULL;
 StaticQueue_t fileQueue_s;
-uint8_t fileQueueArea[FILE_QUEUE_LEN * sizeof(uartRxBuf_TypeDef *)];
+uint8_t fileQueueArea[FILE_QUEUE_LEN * sizeof(LinkFrame_TypeDef)];
 
 const osThreadAttr_t gcodeTask_attributes = {
 	.name = "Gcode_Rx_Task",
@@ -26,6 +36,7 @@ const osThreadAttr_t gcodeTask_attributes = {
 char curFileName[FILENAME_SIZE] = {0};
 volatile bool delete = false;
 volatile bool isTransmittimg = false;
+static volatile uint32_t uploadedBytes = 0; // 供狀態快照讀取
 
 typedef struct {
 	FIL file;						// 檔案物件
@@ -36,25 +47,50 @@ typedef struct {
 	uint32_t packageNum;			// 檔案接收次數計數器
 	uint16_t timeoutCnt;			// 超時檢查計數器
 	uint32_t syncCounter;			// f_sync 計數器
+	bool opened;					// 檔案是否成功開啟
+	uint8_t *stage;					// 寫入暫存區 (heap)，NULL 表示逐包直接寫入
+	uint16_t stageSize;
+	uint16_t stageLen;
+	BYTE drv;						// 檔案所在的實體磁碟 (重新開檔失敗時 file.fs 會被清除)
 	SHA256_CTX sha256_ctx;
 }transmittingCtx_TypeDef;
 
 typedef enum {RECV_OK, RECV_FAIL} RECV_STATUS_TypeDef;
 
-static void dumpArr(int *arr, int numOfArr);
 static RECV_STATUS_TypeDef transmittingInitStage(transmittingCtx_TypeDef* ctx, GcodeTaskArgs_t* taskArgs);
 static RECV_STATUS_TypeDef transmittingStage(transmittingCtx_TypeDef* ctx);
 static RECV_STATUS_TypeDef transmittingOverStage(transmittingCtx_TypeDef* ctx, GcodeTaskArgs_t* taskArgs);
+static FRESULT writeWithRetry(transmittingCtx_TypeDef* ctx, const void *data, UINT len);
+static FRESULT stageWrite(transmittingCtx_TypeDef* ctx, const uint8_t *data, UINT len);
+static FRESULT stageFlush(transmittingCtx_TypeDef* ctx);
+static void stageRelease(transmittingCtx_TypeDef* ctx);
+
+/**
+ * @brief (ISR) 檔案通道處理函式，封包描述直接交給接收任務，不複製資料
+ */
+static bool fileChannelHandler(const LinkFrame_TypeDef *frame, BaseType_t *pxHigherPriorityTaskWoken) {
+	if (!isTransmittimg || xFileQueue == NULL) {
+		linkStats.rxDropped++;
+		return false;
+	}
+	if (xQueueSendFromISR(xFileQueue, frame, pxHigherPriorityTaskWoken) != pdTRUE) {
+		linkStats.rxDropped++;
+		return false;
+	}
+	return true;
+}
 
 void FileTask_Init(void) {
+	Link_SetRxHandler(LINK_CH_FILE, fileChannelHandler);
 	xFileQueue = xQueueCreateStatic(FILE_QUEUE_LEN,
-									sizeof(uartRxBuf_TypeDef *),
+									sizeof(LinkFrame_TypeDef),
 									fileQueueArea,
 									&fileQueue_s);
 	if (xFileQueue == NULL) {
-		printf("%-20s fileQueue Init Failed!\r\n", "[fileTask.c]");
+		LOG_E("fileQueue Init Failed!\r\n");
 	} else {
-		printf("%-20s fileQueue Inited.\r\n", "[fileTask.c]");
+		vQueueAddToRegistry(xFileQueue, "fileQ");
+		LOG_D("fileQueue Inited.\r\n");
 	}
 }
 
@@ -67,12 +103,19 @@ void Gcode_RxHandler_Task(void *argument) {
 	transmittingCtx.packageNum = 0;
 	transmittingCtx.timeoutCnt = 0;
 	transmittingCtx.syncCounter = 0;
+	transmittingCtx.opened = false;
+	transmittingCtx.stage = NULL;
+	transmittingCtx.stageSize = 0;
+	transmittingCtx.stageLen = 0;
+	transmittingCtx.drv = 0;
 
 	GcodeTaskArgs_t* taskArgs = (GcodeTaskArgs_t*)argument;
 
-	if (taskArgs == NULL || taskArgs->ownerTaskHandle == NULL) {
-		printf("%-20s argument is NULL or ownerTaskHandle is NULL\r\n", "[fileTask.c]");
-		goto CleanUp;
+	if (taskArgs == NULL) {
+		LOG_W("argument is NULL\r\n");
+		gcodeRxTaskHandle = NULL;
+		vTaskDelete(NULL);
+		return;
 	}
 
 	if (RECV_OK != transmittingInitStage(&transmittingCtx, taskArgs)) { goto CleanUp; }
@@ -90,41 +133,62 @@ CleanUp:
 
 static RECV_STATUS_TypeDef transmittingInitStage(transmittingCtx_TypeDef* ctx, GcodeTaskArgs_t* taskArgs) {
 	isTransmittimg = true;
+	uploadedBytes = 0;
 #if USE_SHA256
 	sha256_init(&ctx->sha256_ctx);
 #endif
 
-	// 重置佇列，清除舊資料
+	// 清除舊資料，並歸還其佔用的接收緩衝區
 	if (xFileQueue != NULL) {
-		xQueueReset(xFileQueue);
+		LinkFrame_TypeDef staleFrame;
+		while (xQueueReceive(xFileQueue, &staleFrame, 0) == pdTRUE) {
+			Link_ReleaseFrame(&staleFrame);
+		}
 	}
 
-	printf("%-20s creating %s... \r\n", "[fileTask.c]", curFileName);
+	LOG_I("creating %s... \r\n", curFileName);
 
 	ctx->f_res = f_open(&ctx->file, curFileName, FA_CREATE_ALWAYS | FA_WRITE);
 	if (ctx->f_res != FR_OK) {
-		printf("%-20s %-20s \r\n", "[fileTask.c]", "Failed to open file:");
+		LOG_E("Failed to open file: %s\r\n", curFileName);
 		printf_fatfs_error(ctx->f_res);
-		// 通知 esp32.c 任務創建失敗
-		xTaskNotifyGive(taskArgs->ownerTaskHandle);
-		return RECV_FAIL;
+		return RECV_FAIL; // 由 transmittingOverStage 回報開檔失敗
 	}
 	// 清空檔案
 	if (f_truncate(&ctx->file) != FR_OK) {
-		printf("%-20s %-30s %d \r\n", "[fileTask.c]", "Failed to truncate file:", ctx->f_res);
+		LOG_E("Failed to truncate file: %d\r\n", ctx->f_res);
 		f_close(&ctx->file); // 關閉檔案
-		xTaskNotifyGive(taskArgs->ownerTaskHandle); // 也通知失敗
 		return RECV_FAIL;
 	}
-	vTaskDelay(ESP32_RECV_DELAY);
-	UART_SendString_DMA(&ESP32_USART_PORT, "Name ok\n");
-	// 通知 esp32.c 任務創建成功
-	xTaskNotifyGive(taskArgs->ownerTaskHandle);
-	printf("%-20s %-30s free heap: %d bytes \r\n",
-		   "[fileTask.c]",
-		   "Gcode_RxHandler_Task created!",
-		   xPortGetFreeHeapSize());
-	printf("%-20s %-20s \r\n", "[fileTask.c]", "Ready to receive.");
+	ctx->opened = true;
+
+	/*
+	 * 封包長度不是 512 的倍數，逐包 f_write 會讓 FatFs 以單磁區讀-改-寫處理。
+	 * 先湊滿暫存區再寫入，檔案位置始終對齊磁區，FatFs 直接以多磁區 (CMD25)
+	 * 從暫存區傳輸；heap 位址對齊 8 bytes，DMA 不需經 bounce buffer。
+	 */
+	ctx->stageSize = UPLOAD_STAGE_SIZE;
+	ctx->stage = pvPortMalloc(ctx->stageSize);
+	if (ctx->stage == NULL) {
+		ctx->stageSize = UPLOAD_STAGE_MIN;
+		ctx->stage = pvPortMalloc(ctx->stageSize);
+	}
+	if (ctx->stage == NULL) {
+		ctx->stageSize = 0;
+		LOG_W("no heap for write stage, writing per frame\r\n");
+	}
+	ctx->stageLen = 0;
+
+	// 預告循序寫入，讓驅動在每次多磁區寫入前送出 ACMD23 預先抹除
+	DWORD seqHint = SD_SEQ_WRITE_OPEN;
+	ctx->drv = ctx->file.fs->drv;
+	disk_ioctl(ctx->drv, SD_CTRL_SEQ_WRITE_HINT, &seqHint);
+
+	Link_SendString(LINK_CH_RSP, "Name ok\n");
+	// 開檔完成，回報 SetFilename 工作
+	ESP32_JobComplete(taskArgs->openJobId, true, NULL);
+	LOG_D("Gcode_RxHandler_Task created, free heap: %u bytes\r\n", (unsigned int) xPortGetFreeHeapSize());
+	LOG_I("Ready to receive.\r\n");
 	UI_Update_Status("Uploading...");
 
 #ifdef DEBUG
@@ -136,82 +200,37 @@ static RECV_STATUS_TypeDef transmittingInitStage(transmittingCtx_TypeDef* ctx, G
 }
 
 static RECV_STATUS_TypeDef transmittingStage(transmittingCtx_TypeDef* ctx) {
-	UINT fnum = 0;
 	bool received_data = false;
-	uartRxBuf_TypeDef *pFileBuf = NULL;
-	uint8_t retryCount = 0;
+	LinkFrame_TypeDef fileFrame;
 
-	received_data = xQueueReceive(xFileQueue, &pFileBuf, pdMS_TO_TICKS(1000));
+	received_data = xQueueReceive(xFileQueue, &fileFrame, pdMS_TO_TICKS(1000));
 
 	/*========== 正常接收檔案 ==========*/
-	if (received_data && pFileBuf != NULL) {
-		if (pFileBuf->len != 0) {
+	if (received_data && fileFrame.data != NULL) {
+		if (fileFrame.len != 0) {
 			ctx->timeoutCnt = 0;
 			ctx->packageNum++;
 			ctx->syncCounter++;
 			
-			// 寫入重試機制
-			for (retryCount = 0; retryCount < SD_RTY_TIMES; retryCount++) {
-				// 每次寫入前短暫延遲，讓 SD 卡有時間處理
-				if (retryCount > 0) {
-					vTaskDelay(pdMS_TO_TICKS(20 * retryCount)); // 遞增延遲
-					// 等待 SD 卡就緒
-					uint32_t waitStart = HAL_GetTick();
-					while (BSP_SD_GetCardState() != MSD_OK) {
-						if ((HAL_GetTick() - waitStart) > 500) {
-							printf("%-20s SD card not ready, timeout\r\n", "[fileTask.c]");
-							break;
-						}
-						vTaskDelay(pdMS_TO_TICKS(5));
-					}
-				}
-				
-				ctx->f_res = f_write(&ctx->file, pFileBuf->data, pFileBuf->len, &fnum);
-				if (ctx->f_res == FR_OK && fnum == pFileBuf->len) {
-					break;
-				}
-				
-				printf("%-20s SD write retry %d, err: ", "[fileTask.c]", retryCount + 1);
-				printf_fatfs_error(ctx->f_res);
-				
-				// 如果是檔案物件無效，嘗試重新開啟
-				if (ctx->f_res == FR_INVALID_OBJECT) {
-					f_close(&ctx->file);
-					vTaskDelay(pdMS_TO_TICKS(50));
-					// 使用 FA_OPEN_ALWAYS 開啟，然後 seek 到檔案尾端 (FatFs R0.11 沒有 FA_OPEN_APPEND)
-					ctx->f_res = f_open(&ctx->file, curFileName, FA_OPEN_ALWAYS | FA_WRITE);
-					if (ctx->f_res == FR_OK) {
-						f_lseek(&ctx->file, f_size(&ctx->file)); // 移動到檔案尾端
-					} else {
-						printf("%-20s Failed to reopen file\r\n", "[fileTask.c]");
-					}
-				}
-			}
+			ctx->f_res = stageWrite(ctx, fileFrame.data, fileFrame.len);
 			
 			if (ctx->f_res != FR_OK) {
-				printf("%-20s SD write failed after %d retries\r\n", "[fileTask.c]", SD_RTY_TIMES);
-				xQueueSend(xFreeBufferQueue, &pFileBuf, 0);
-				if (uartRxPaused) {
-					UART_Resume_Reception();
-				}
+				LOG_E("SD write failed after %d retries\r\n", SD_RTY_TIMES);
+				Link_ReleaseFrame(&fileFrame);
 				return RECV_FAIL;
 			}
 			
-			ctx->fnumCount += fnum;
+			ctx->fnumCount += fileFrame.len;
+			uploadedBytes = ctx->fnumCount;
 			
 			// 每 100 個包執行一次 f_sync，減少 SD 卡負擔
+			// (暫存區內尚未寫入的資料不在此提交，以免檔案位置離開磁區邊界)
 			if (ctx->syncCounter >= 100) {
 				ctx->syncCounter = 0;
-				// 等待 SD 卡就緒再 sync
-				uint32_t waitStart = HAL_GetTick();
-				while (BSP_SD_GetCardState() != MSD_OK) {
-					if ((HAL_GetTick() - waitStart) > 500) break;
-					vTaskDelay(pdMS_TO_TICKS(5));
-				}
+				// 卡片就緒由 sd_diskio 在卷冊鎖內等待，此處不可直接對卡片下命令
 				ctx->f_res = f_sync(&ctx->file);
 				if (ctx->f_res != FR_OK) {
-					printf("%-20s f_sync failed: ", "[fileTask.c]");
-					printf_fatfs_error(ctx->f_res);
+					LOG_E("f_sync failed: %d\r\n", ctx->f_res);
 					// f_sync 失敗不一定是致命錯誤，繼續嘗試
 				}
 			}
@@ -224,19 +243,15 @@ static RECV_STATUS_TypeDef transmittingStage(transmittingCtx_TypeDef* ctx) {
 				}
 			}
 #if USE_SHA256
-			sha256_update(&ctx->sha256_ctx, pFileBuf->data, pFileBuf->len);
+			TRACE_SPAN_BEGIN(TRACE_SPAN_SHA256, fileFrame.len);
+			sha256_update(&ctx->sha256_ctx, fileFrame.data, fileFrame.len);
+			TRACE_SPAN_END(TRACE_SPAN_SHA256);
 #endif
-			xQueueSend(xFreeBufferQueue, &pFileBuf, 0);
-			if (uartRxPaused) {
-				UART_Resume_Reception();
-			}
+			Link_ReleaseFrame(&fileFrame);
 			return RECV_OK;
 		} else {
 			// len == 0
-			xQueueSend(xFreeBufferQueue, &pFileBuf, 0);
-			if (uartRxPaused) {
-				UART_Resume_Reception();
-			}
+			Link_ReleaseFrame(&fileFrame);
 		}
 
 	/*========== 超時 (received_data == false) ==========*/
@@ -248,18 +263,125 @@ static RECV_STATUS_TypeDef transmittingStage(transmittingCtx_TypeDef* ctx) {
 	f_sync(&ctx->file);
 	ctx->timeoutCnt++;
 	if (ctx->timeoutCnt >= 5) {
-		printf("%-20s timeout waiting for uart\r\n", "[fileTask.c]");
-		UART_SendString_DMA(&ESP32_USART_PORT, "reset\n");
+		LOG_W("timeout waiting for uart\r\n");
+		Link_SendString(LINK_CH_RSP, "reset\n");
 		return RECV_FAIL;
 	}
 
 	return RECV_OK;
 }
 
+/**
+ * @brief 寫入 SD 卡，失敗時等待卡片就緒後重試
+ */
+static FRESULT writeWithRetry(transmittingCtx_TypeDef* ctx, const void *data, UINT len) {
+	UINT fnum = 0;
+	uint8_t retryCount = 0;
+
+	for (retryCount = 0; retryCount < SD_RTY_TIMES; retryCount++) {
+		// 每次寫入前短暫延遲，讓 SD 卡有時間處理
+		if (retryCount > 0) {
+			vTaskDelay(pdMS_TO_TICKS(20 * retryCount)); // 遞增延遲
+		}
+		
+		TRACE_SPAN_BEGIN(TRACE_SPAN_F_WRITE, len);
+		ctx->f_res = f_write(&ctx->file, data, len, &fnum);
+		TRACE_SPAN_END(TRACE_SPAN_F_WRITE);
+		if (ctx->f_res == FR_OK && fnum == len) {
+			break;
+		}
+		
+		LOG_W("SD write retry %d, err: %d\r\n", retryCount + 1, ctx->f_res);
+		
+		// 如果是檔案物件無效，嘗試重新開啟
+		if (ctx->f_res == FR_INVALID_OBJECT) {
+			f_close(&ctx->file);
+			vTaskDelay(pdMS_TO_TICKS(50));
+			// 使用 FA_OPEN_ALWAYS 開啟，然後 seek 到檔案尾端 (FatFs R0.11 沒有 FA_OPEN_APPEND)
+			ctx->f_res = f_open(&ctx->file, curFileName, FA_OPEN_ALWAYS | FA_WRITE);
+			if (ctx->f_res == FR_OK) {
+				f_lseek(&ctx->file, f_size(&ctx->file)); // 移動到檔案尾端
+			} else {
+				LOG_E("Failed to reopen file\r\n");
+			}
+		}
+	}
+	return ctx->f_res;
+}
+
+/**
+ * @brief 資料先複製到暫存區，湊滿時整塊寫入
+ */
+static FRESULT stageWrite(transmittingCtx_TypeDef* ctx, const uint8_t *data, UINT len) {
+	if (ctx->stage == NULL) {
+		return writeWithRetry(ctx, data, len);
+	}
+	while (len > 0) {
+		UINT n = ctx->stageSize - ctx->stageLen;
+		if (n > len) {
+			n = len;
+		}
+		memcpy(ctx->stage + ctx->stageLen, data, n);
+		ctx->stageLen += n;
+		data += n;
+		len -= n;
+		if (ctx->stageLen == ctx->stageSize) {
+			ctx->stageLen = 0;
+			if (writeWithRetry(ctx, ctx->stage, ctx->stageSize) != FR_OK) {
+				return ctx->f_res;
+			}
+		}
+	}
+	return FR_OK;
+}
+
+/**
+ * @brief 寫出暫存區中剩餘的資料 (檔案結尾)
+ */
+static FRESULT stageFlush(transmittingCtx_TypeDef* ctx) {
+	UINT n = ctx->stageLen;
+
+	ctx->stageLen = 0;
+	if (ctx->stage == NULL || n == 0) {
+		return FR_OK;
+	}
+	return writeWithRetry(ctx, ctx->stage, n);
+}
+
+/**
+ * @brief 結束循序寫入預告並歸還暫存區
+ */
+static void stageRelease(transmittingCtx_TypeDef* ctx) {
+	DWORD seqHint = 0;
+
+	disk_ioctl(ctx->drv, SD_CTRL_SEQ_WRITE_HINT, &seqHint);
+	if (ctx->stage != NULL) {
+		vPortFree(ctx->stage);
+		ctx->stage = NULL;
+	}
+}
+
 static RECV_STATUS_TypeDef transmittingOverStage(transmittingCtx_TypeDef* ctx, GcodeTaskArgs_t* taskArgs) {
 	uint32_t tmp = xTaskGetTickCount() - ctx->timer;
+	uint16_t overJobId;
+
+	if (!ctx->opened) {
+		delete = false;
+		isTransmittimg = false;
+		ESP32_SetState(ESP32_IDLE);
+		Link_SendString(LINK_CH_RSP, "Error: File open failed\n");
+		ESP32_JobComplete(taskArgs->openJobId, false, "open failed");
+		UI_Update_Status("Idle");
+		gcodeRxTaskHandle = NULL;
+		vTaskDelete(NULL);
+		return RECV_FAIL;
+	}
 
-	// 確保所有資料寫入 SD 卡
+	// 寫出暫存區剩餘資料，並確保所有資料寫入 SD 卡
+	if (stageFlush(ctx) != FR_OK) {
+		LOG_E("SD write failed on final flush\r\n");
+	}
+	stageRelease(ctx);
 	f_sync(&ctx->file);
 
 #if USE_SHA256
@@ -275,11 +397,10 @@ static RECV_STATUS_TypeDef transmittingOverStage(transmittingCtx_TypeDef* ctx, G
 #endif
 
 	f_close(&ctx->file);
-	delete = false;
 	isTransmittimg = false;
-	printf("%-20s fnumCount: %d\r\n", "[fileTask.c]", ctx->fnumCount);
-	printf("%-20s minimum stack size: %u\r\n", "[fileTask.c]", ctx->stackHighWaterMark);
-	printf("%-20s total time: %dms\r\n", "[fileTask.c]", tmp);
+	LOG_I("fnumCount: %d\r\n", ctx->fnumCount);
+	LOG_D("minimum stack size: %u\r\n", ctx->stackHighWaterMark);
+	LOG_I("total time: %dms\r\n", tmp);
 
 	// 不再刪除佇列，保留給下次使用
 	// if (xFileQueue != NULL) {
@@ -287,59 +408,38 @@ static RECV_STATUS_TypeDef transmittingOverStage(transmittingCtx_TypeDef* ctx, G
 	// 	xFileQueue = NULL;
 	// }
 	UI_Update_Status("Idle");
+
+	// 與 TransmissionOverHandler 互斥：之後收到的結束命令會直接回報錯誤
+	taskENTER_CRITICAL();
+	overJobId = taskArgs->overJobId;
+	delete = false;
 	gcodeRxTaskHandle = NULL;
+	taskEXIT_CRITICAL();
+
+	// 由 TransmissionOver 結束時才需要驗證，逾時結束已送出 "reset"
+	if (overJobId != 0) {
+		taskArgs->hashResult[SHA256_HASH_SIZE - 1] = '\0';
+		if (strcmp(taskArgs->expectedHash, taskArgs->hashResult) == 0) {
+			LOG_I("File %s verification succeeded\r\n", curFileName);
+			LOG_I("======================TransMission Successed=====================\r\n");
+			UI_Show_FileUploadSuccess();
+			Catalog_AddFile(curFileName, taskArgs->hashResult);
+			ESP32_JobComplete(overJobId, true, NULL);
+		} else {
+			LOG_E("File %s verification failed\r\n", curFileName);
+			Catalog_AddFile(curFileName, NULL); // 檔案仍留在卡上，索引須與目錄一致
+			ESP32_JobComplete(overJobId, false, ERROR_FILE_BROKEN);
+		}
+		ESP32_SetState(ESP32_IDLE);
+	} else {
+		Catalog_AddFile(curFileName, NULL);
+	}
+
 	vTaskDelete(NULL);
 	return RECV_OK;
 }
 
 
-static void dumpArr(int *arr, int numOfArr) {
-	if (arr == NULL) {
-		return;
-	}
-	for (int i = 0; i < numOfArr; i++) {
-		printf("%d ", arr[i]);
-	}
-	printf("\n");
-}
-
-
-void calFileHash(char* hashOutput) {
-	FIL tmpFile;
-	FRESULT f_res;
-	UINT fnum;
-
-	SHA256_CTX sha256_ctx;
-	uint8_t hash_output[SHA256_BLOCK_SIZE];
-	char fileBuf[256];
-
-	if (hashOutput == NULL) {
-		printf("%-20s arg err!!\r\n", "[fileTask.c]");
-		return;
-	}
-
-	f_res = f_open(&tmpFile, curFileName, FA_READ);
-	if (f_res != FR_OK) {
-		f_close(&tmpFile);
-		printf("%-20s Failed to open file: %s\r\n", "[fileTask.c]", curFileName);
-		return;
-	}
-	if (f_size(&tmpFile) <= 0) {
-		f_close(&tmpFile);
-		printf("%-20s file has no content\r\n", "[fileTask.c]");
-		return;
-	}
-	sha256_init(&sha256_ctx);
-
-	while (f_read(&tmpFile, fileBuf, sizeof(fileBuf), &fnum) == FR_OK && fnum > 0) {
-		sha256_update(&sha256_ctx, fileBuf, fnum);
-	}
-	sha256_final(&sha256_ctx, hash_output);
-	f_close(&tmpFile);
-
-	// 轉換為十六進位字串
-	for (int j = 0; j < SHA256_BLOCK_SIZE; j++) {
-		sprintf(hashOutput + (j * 2), "%02x", hash_output[j]);
-	}
-	hashOutput[SHA256_BLOCK_SIZE - 1] = '\0';
+uint32_t FileTask_GetUploadedBytes(void) {
+	return uploadedBytes;
 }
@@ -31,6 +31,15 @@
 #include "fileTask.h"
 #include "printerController.h"
 #include "usart.h"
+#include "telemetry.h"
+#include "estop.h"
+#include "fileCatalog.h"
+#include "storage.h"
+#include "boot.h"
+#include "taskStats.h"
+
+#define LOG_MODULE RTOS
+#include "logger.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -83,7 +92,7 @@ const osThreadAttr_t esp32RxHandlerTask_attributes = {
 osThreadId_t defaultTaskHandle;
 const osThreadAttr_t defaultTask_attributes = {
 	.name = "defaultTask",
-	.stack_size = configMINIMAL_STACK_SIZE * 10,
+	.stack_size = configMINIMAL_STACK_SIZE * 16, // 也是開機工作者，與 Boot_Worker 相同 (見 boot.c)
 	.priority = (osPriority_t) osPriorityNormal,
 };
 
@@ -104,6 +113,7 @@ void MX_FREERTOS_Init(void); /* (MISRA C 2004 rule 8.1) */
 void MX_FREERTOS_Init(void) {
 	/* USER CODE BEGIN Init */
 	// printf("%-20s %-30s free heap: %d bytes\r\n", "[freertos.c]", "rtos initing...", xPortGetFreeHeapSize());
+	Boot_Init(); // 各任務啟動後即可等待開機步驟
 	/* USER CODE END Init */
 
 	/* USER CODE BEGIN RTOS_MUTEX */
@@ -132,16 +142,16 @@ void MX_FREERTOS_Init(void) {
 	//任務建立結果檢查
 #ifdef DEBUG
 	if (defaultTaskHandle == NULL) {
-		printf("%-20s defaultTaskHandle created failed!!\r\n", "[freertos.c]");
+		LOG_E("defaultTaskHandle created failed!!\r\n");
 	}
 	if (UITaskHandle == NULL) {
-		printf("%-20s UITaskHandle created failed!!\r\n", "[freertos.c]");
+		LOG_E("UITaskHandle created failed!!\r\n");
 	}
 	if (TouchTaskHandle == NULL) {
-		printf("%-20s TouchTaskHandle created failed!!\r\n", "[freertos.c]");
+		LOG_E("TouchTaskHandle created failed!!\r\n");
 	}
 	if (esp32RxHandlerTaskHandle == NULL) {
-		printf("%-20s esp32RxHandlerTaskHandle created failed!!\r\n", "[freertos.c]");
+		LOG_E("esp32RxHandlerTaskHandle created failed!!\r\n");
 	}
 #endif
 	/* USER CODE END RTOS_THREADS */
@@ -149,7 +159,7 @@ void MX_FREERTOS_Init(void) {
 	/* USER CODE BEGIN RTOS_EVENTS */
 	/* add events, ... */
 	/* USER CODE END RTOS_EVENTS */
-	printf("%-20s %-30s free heap: %d bytes\r\n", "[freertos.c]", "tasks initialized.", xPortGetFreeHeapSize());
+	LOG_D("tasks initialized, free heap: %u bytes\r\n", (unsigned int) xPortGetFreeHeapSize());
 }
 
 /* USER CODE BEGIN Header_StartDefaultTask */
@@ -160,25 +170,24 @@ void MX_FREERTOS_Init(void) {
   */
 /* USER CODE END Header_StartDefaultTask */
 void StartDefaultTask(void *argument) {
-	FileTask_Init(); // 初始化檔案任務佇列
-	ESP32_Init();
-	Hx711_Init(&hx711);
-	
-	// 初始化印表機通訊 (需要在 RTOS 啟動後)
+	// 初始化印表機通訊 (需要在 RTOS 啟動後)，不相依其他開機步驟
 	printerRxSemaphore = xSemaphoreCreateBinary();
 	if (printerRxSemaphore == NULL) {
-		printf("%-20s Failed to create printerRxSemaphore\r\n", "[freertos.c]");
+		LOG_E("Failed to create printerRxSemaphore\r\n");
+	} else {
+		vQueueAddToRegistry(printerRxSemaphore, "printerRx");
 	}
 	__HAL_UART_ENABLE_IT(&huart3, UART_IT_IDLE);
 
+	// 鏈路、SD 掛載、秤重歸零、目錄索引並行執行，本任務為其中一個工作者
+	Boot_Run();
+
+	// 各任務統計改由 cReqTaskStats 與系統頁查看，不再每秒輸出堆積用量；
+	// 視窗長度以實際取樣間的週期數計算，輪詢耗時不影響百分比
 	for (;;) {
-		size_t free_heap = xPortGetFreeHeapSize();
-		size_t used_heap = configTOTAL_HEAP_SIZE - free_heap;
-		uint8_t usage_percent = (used_heap * 100) / configTOTAL_HEAP_SIZE;
-		printf("%-20s Heap usage: %u%% (%u / %u bytes)\r\n", "[freertos.c]", usage_percent, (unsigned int) used_heap,
-		       (unsigned int) configTOTAL_HEAP_SIZE);
+		TaskStats_Sample();
 		PC_Param_Polling();
-		osDelay(1000);
+		osDelay(TASKSTATS_PERIOD_MS);
 	}
 }
 
@@ -186,12 +195,24 @@ void StartDefaultTask(void *argument) {
 /* Private application code --------------------------------------------------*/
 /* USER CODE BEGIN Application */
 void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName) {
-	/* 先打印哪個任務溢出（在禁用中斷之前） */
-	printf("%-20s Stack overflow in task: %s\r\n", "[freertos.c]", pcTaskName);
-	
+	static const char msg[] = "\r\nStack overflow in task: ";
+	uint16_t nameLen = 0;
+
 	/* 停用中斷，避免繼續運行造成更大破壞 */
 	taskDISABLE_INTERRUPTS();
 
+	/* 打印哪個任務溢出：日誌環形緩衝區要靠 DMA 完成中斷才送得出去，
+	 * 因此停下傳輸中的 DMA 後以阻塞方式直接寫 UART1，不做格式化以少用堆疊 */
+	while (nameLen < configMAX_TASK_NAME_LEN && pcTaskName[nameLen] != '\0') {
+		nameLen++;
+	}
+	if (huart1.hdmatx != NULL) {
+		CLEAR_BIT(huart1.hdmatx->Instance->CCR, DMA_CCR_EN);
+	}
+	HAL_UART_Transmit(&huart1, (uint8_t *) msg, sizeof(msg) - 1, HAL_MAX_DELAY);
+	HAL_UART_Transmit(&huart1, (uint8_t *) pcTaskName, nameLen, HAL_MAX_DELAY);
+	HAL_UART_Transmit(&huart1, (uint8_t *) "\r\n", 2, HAL_MAX_DELAY);
+
 	/* 可以在這裡打開 LED 快速閃爍作為錯誤提示 */
 	// Error_LED_Blink();
 
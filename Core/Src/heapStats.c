@@ -0,0 +1,245 @@
+/**
+ * @file    heapStats.c
+ * @brief   FreeRTOS 堆積使用追蹤，說明見 heapStats.h
+ */
+
+#include "heapStats.h"
+#include <stdio.h>
+#include <string.h>
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "link.h"
+
+#define LOG_MODULE RTOS
+#include "logger.h"
+
+/* 由連結器 --wrap 提供，指向 heap_4.c 的原始實作 */
+void *__real_pvPortMalloc(size_t xWantedSize);
+void __real_vPortFree(void *pv);
+void *__wrap_pvPortMalloc(size_t xWantedSize);
+void __wrap_vPortFree(void *pv);
+
+typedef struct {
+	uint32_t pc;                       // 呼叫 pvPortMalloc 的返回位址
+	char task[HEAPSTATS_TASK_LEN];     // 配置時執行的任務 (不一定以 '\0' 結尾)
+	uint16_t live;                     // 目前存活的區塊數與請求大小總和
+	uint16_t liveBytes;
+	uint16_t baseLive;                 // 上一次工作標記時的存活數
+	uint16_t baseBytes;
+	uint32_t allocs;                   // 累計配置次數
+} HeapSite_TypeDef;
+
+typedef struct {
+	uint16_t ofs;                      // 相對 SRAM_BASE 的位移 (RAM 64 KB)
+	uint16_t size;                     // 請求大小，0 表示此項未使用
+	uint8_t site;
+} HeapLive_TypeDef;
+
+typedef struct {
+	uint8_t site;
+	uint16_t live;
+	int32_t bytes;
+} HeapLeak_TypeDef;
+
+static HeapSite_TypeDef sites[HEAPSTATS_MAX_SITES] = {{0, "other"}};
+static uint8_t siteCount = 1;
+static HeapLive_TypeDef live[HEAPSTATS_MAX_LIVE];
+static uint32_t hist[HEAPSTATS_HIST_BINS];
+static uint32_t failCount;
+static uint32_t untracked;
+
+static HeapLeak_TypeDef leaks[HEAPSTATS_MAX_LEAKS];
+static uint8_t leakCount;
+static const char *leakFrom;
+static const char *leakTo;
+static const char *lastJob = "boot";
+static uint32_t markCount;
+
+static uint8_t hist_bin(size_t size) {
+	uint8_t bin = 0;
+	size_t limit = 16;
+
+	while (size > limit && bin < HEAPSTATS_HIST_BINS - 1) {
+		limit <<= 1;
+		bin++;
+	}
+	return bin;
+}
+
+/**
+ * @brief 找出或新增呼叫點，表滿時回傳 0 (other)；於排程器暫停時呼叫
+ */
+static uint8_t find_site(uint32_t pc) {
+	const char *task = (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) ? "init" : pcTaskGetName(NULL);
+
+	for (uint8_t i = 1; i < siteCount; i++) {
+		if (sites[i].pc == pc && strncmp(sites[i].task, task, HEAPSTATS_TASK_LEN) == 0) {
+			return i;
+		}
+	}
+	if (siteCount >= HEAPSTATS_MAX_SITES) {
+		return 0;
+	}
+	sites[siteCount].pc = pc;
+	strncpy(sites[siteCount].task, task, HEAPSTATS_TASK_LEN);
+	return siteCount++;
+}
+
+void *__wrap_pvPortMalloc(size_t xWantedSize) {
+	uint32_t pc = (uint32_t) (uintptr_t) __builtin_return_address(0) & ~1UL; // 去除 Thumb 位元
+	void *p;
+
+	vTaskSuspendAll();
+	p = __real_pvPortMalloc(xWantedSize);
+	if (p == NULL) {
+		failCount++;
+	} else {
+		uint8_t site = find_site(pc);
+		HeapLive_TypeDef *slot = NULL;
+
+		hist[hist_bin(xWantedSize)]++;
+		sites[site].allocs++;
+		for (uint8_t i = 0; i < HEAPSTATS_MAX_LIVE; i++) {
+			if (live[i].size == 0) {
+				slot = &live[i];
+				break;
+			}
+		}
+		if (slot != NULL) {
+			slot->ofs = (uint16_t) ((uintptr_t) p - SRAM_BASE);
+			slot->size = (uint16_t) xWantedSize;
+			slot->site = site;
+			sites[site].live++;
+			sites[site].liveBytes += (uint16_t) xWantedSize;
+		} else {
+			untracked++; // 釋放時找不到，不影響呼叫點統計
+		}
+	}
+	(void) xTaskResumeAll();
+	return p;
+}
+
+void __wrap_vPortFree(void *pv) {
+	uint16_t ofs = (uint16_t) ((uintptr_t) pv - SRAM_BASE);
+
+	if (pv == NULL) {
+		return;
+	}
+	vTaskSuspendAll();
+	for (uint8_t i = 0; i < HEAPSTATS_MAX_LIVE; i++) {
+		if (live[i].size != 0 && live[i].ofs == ofs) {
+			sites[live[i].site].live--;
+			sites[live[i].site].liveBytes -= live[i].size;
+			live[i].size = 0;
+			break;
+		}
+	}
+	__real_vPortFree(pv);
+	(void) xTaskResumeAll();
+}
+
+void HeapStats_JobMark(const char *job, bool compare) {
+	uint8_t n = 0;
+
+	// 第一次標記只建立基準 (開機期間的配置不算洩漏)
+	compare = compare && markCount > 0;
+	vTaskSuspendAll();
+	for (uint8_t i = 0; i < siteCount; i++) {
+		HeapSite_TypeDef *s = &sites[i];
+		if (compare && s->live > s->baseLive && n < HEAPSTATS_MAX_LEAKS) {
+			leaks[n].site = i;
+			leaks[n].live = (uint16_t) (s->live - s->baseLive);
+			leaks[n].bytes = (int32_t) s->liveBytes - (int32_t) s->baseBytes;
+			n++;
+		}
+		s->baseLive = s->live;
+		s->baseBytes = s->liveBytes;
+	}
+	if (compare) {
+		leakCount = n;
+		leakFrom = lastJob;
+		leakTo = job;
+	}
+	lastJob = job;
+	markCount++;
+	(void) xTaskResumeAll();
+
+	if (!compare) {
+		LOG_D("%s: baseline only\r\n", job);
+	}
+
+	for (uint8_t i = 0; i < n; i++) {
+		const HeapSite_TypeDef *s = &sites[leaks[i].site];
+		char task[HEAPSTATS_TASK_LEN + 1];
+
+		// 日誌以 strnlen 複製字串參數，名稱須先補上結尾
+		memcpy(task, s->task, HEAPSTATS_TASK_LEN);
+		task[HEAPSTATS_TASK_LEN] = '\0';
+		LOG_W("%s -> %s: site %08lx (%s) +%u blocks, %+ld bytes\r\n", leakFrom, leakTo,
+		      (unsigned long) s->pc, task, leaks[i].live, (long) leaks[i].bytes);
+	}
+}
+
+void GetHeapStatsHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
+	char param[8] = {0};
+	char buf[160];
+	HeapStats_t hs;
+	HeapSite_TypeDef s;
+	int n;
+
+	if (extract_parameter(args, len, param, sizeof(param))) {
+		if (strcmp(param, "mark") != 0) {
+			Link_SendString(LINK_CH_RSP, "Heap:invalid\n");
+			return;
+		}
+		HeapStats_JobMark("manual", true); // 由使用者決定時機，不檢查工作任務
+	}
+
+	// 摘要：碎片化比例為千分比
+	vPortGetHeapStats(&hs);
+	n = snprintf(buf, sizeof(buf),
+	             "Heap:total=%u,free=%u,min=%u,largest=%u,blocks=%u,frag=%u,allocs=%u,frees=%u,fails=%lu,untracked=%lu\n",
+	             (unsigned int) configTOTAL_HEAP_SIZE, (unsigned int) hs.xAvailableHeapSpaceInBytes,
+	             (unsigned int) hs.xMinimumEverFreeBytesRemaining, (unsigned int) hs.xSizeOfLargestFreeBlockInBytes,
+	             (unsigned int) hs.xNumberOfFreeBlocks,
+	             (hs.xAvailableHeapSpaceInBytes > 0)
+	                 ? (unsigned int) (1000U - (hs.xSizeOfLargestFreeBlockInBytes * 1000U) / hs.xAvailableHeapSpaceInBytes)
+	                 : 0U,
+	             (unsigned int) hs.xNumberOfSuccessfulAllocations, (unsigned int) hs.xNumberOfSuccessfulFrees,
+	             (unsigned long) failCount, (unsigned long) untracked);
+	Link_Send(LINK_CH_RSP, buf, (uint16_t) n);
+
+	// 大小分布：<=16, <=32, ... <=4096, >4096
+	n = snprintf(buf, sizeof(buf), "HeapHist:");
+	for (uint8_t i = 0; i < HEAPSTATS_HIST_BINS; i++) {
+		n += snprintf(buf + n, sizeof(buf) - (size_t) n, "%s%lu", (i > 0) ? "," : "", (unsigned long) hist[i]);
+	}
+	n += snprintf(buf + n, sizeof(buf) - (size_t) n, "\n");
+	Link_Send(LINK_CH_RSP, buf, (uint16_t) n);
+
+	// 各呼叫點：位址,任務,存活區塊,存活位元組,累計配置次數
+	for (uint8_t i = 0; i < siteCount; i++) {
+		vTaskSuspendAll();
+		s = sites[i];
+		(void) xTaskResumeAll();
+		if (s.allocs == 0) {
+			continue;
+		}
+		n = snprintf(buf, sizeof(buf), "HeapSite:%08lx,%.8s,%u,%u,%lu\n", (unsigned long) s.pc, s.task,
+		             s.live, s.liveBytes, (unsigned long) s.allocs);
+		Link_Send(LINK_CH_RSP, buf, (uint16_t) n);
+	}
+
+	// 最近一次工作標記的比對結果
+	if (leakFrom != NULL) {
+		n = snprintf(buf, sizeof(buf), "HeapLeak:%s>%s,sites=%u\n", leakFrom, leakTo, leakCount);
+		Link_Send(LINK_CH_RSP, buf, (uint16_t) n);
+		for (uint8_t i = 0; i < leakCount; i++) {
+			const HeapSite_TypeDef *ls = &sites[leaks[i].site];
+			n = snprintf(buf, sizeof(buf), "HeapLeak:%08lx,%.8s,+%u,%+ld\n", (unsigned long) ls->pc, ls->task,
+			             leaks[i].live, (long) leaks[i].bytes);
+			Link_Send(LINK_CH_RSP, buf, (uint16_t) n);
+		}
+	}
+}
@@ -0,0 +1,337 @@
+/**
+ * @file    link.c
+ * @brief   ESP32 <-> STM32 UART 多工封包鏈路層，封包格式見 link.h
+ */
+
+#include "link.h"
+#include <stdio.h>
+#include <string.h>
+#include "queue.h"
+#include "task.h"
+
+#define LOG_MODULE LINK
+#include "logger.h"
+
+#define LINK_CRC_INIT            0xFFFF
+
+LinkStats_TypeDef linkStats;
+
+static LinkRxHandler rxHandlers[LINK_CH_COUNT];
+static uartRxBuf_TypeDef *pRxBuf;      // 目前 DMA 寫入中的緩衝區
+static volatile bool rxPaused = false; // 緩衝區池耗盡，DMA 停止 (RTS 拉高讓 ESP32 暫停)
+static uint16_t pausedTailPos;         // 暫停時 pRxBuf 內半包的位置
+static uint16_t pausedTailLen;         // 暫停時 pRxBuf 內半包的長度
+
+// CRC-16/CCITT-FALSE (poly 0x1021)
+static const uint16_t crc16Table[256] = {
+	0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+	0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+	0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+	0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+	0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+	0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+	0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+	0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+	0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+	0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+	0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+	0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+	0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+	0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+	0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+	0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+	0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+	0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+	0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+	0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+	0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+	0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+	0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+	0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+	0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+	0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+	0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+	0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+	0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+	0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+	0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+	0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0
+};
+
+static uint16_t crc16_update(uint16_t crc, const uint8_t *data, size_t len) {
+	while (len--) {
+		crc = (uint16_t) (crc << 8) ^ crc16Table[(uint8_t) (crc >> 8) ^ *data++];
+	}
+	return crc;
+}
+
+/**
+ * @brief 從 pRxBuf 的 fill 位置開始 DMA 接收，前面 fill 個位元組為上次遺留的半包
+ */
+static void rx_start(uint16_t fill) {
+	HAL_UART_Receive_DMA(&ESP32_USART_PORT,
+	                     (uint8_t *) pRxBuf->data + fill,
+	                     UART_RX_BUFFER_SIZE - fill);
+}
+
+/**
+ * @brief 將 pRxBuf 中 [pos, pos + tail) 的半包搬到下一個緩衝區開頭並重新啟動接收
+ * @param next 新緩衝區，NULL 表示原地重用 pRxBuf
+ * @return 被換下、需要釋放接收端參考的舊緩衝區，原地重用時為 NULL
+ */
+static uartRxBuf_TypeDef *rx_rearm(uint16_t pos, uint16_t tail, uartRxBuf_TypeDef *next) {
+	uartRxBuf_TypeDef *old = NULL;
+
+	if (next == NULL) {
+		memmove(pRxBuf->data, pRxBuf->data + pos, tail);
+	} else {
+		memcpy(next->data, pRxBuf->data + pos, tail);
+		next->refCnt = 1; // 接收端本身的參考
+		old = pRxBuf;
+		pRxBuf = next;
+	}
+	rx_start(tail);
+	return old;
+}
+
+static void buf_put_from_isr(uartRxBuf_TypeDef *buf, BaseType_t *pxHigherPriorityTaskWoken) {
+	UBaseType_t savedIrq = taskENTER_CRITICAL_FROM_ISR();
+	uint8_t ref = --buf->refCnt;
+	taskEXIT_CRITICAL_FROM_ISR(savedIrq);
+
+	if (ref == 0) {
+		xQueueSendFromISR(xFreeBufferQueue, &buf, pxHigherPriorityTaskWoken);
+	}
+}
+
+static void buf_put(uartRxBuf_TypeDef *buf) {
+	taskENTER_CRITICAL();
+	uint8_t ref = --buf->refCnt;
+	taskEXIT_CRITICAL();
+
+	if (ref == 0) {
+		xQueueSend(xFreeBufferQueue, &buf, 0);
+	}
+}
+
+/**
+ * @brief (ISR) 保留 pRxBuf 中的半包並重新啟動接收
+ * @note  若已解析的封包仍被消費者持有，則換一個新緩衝區，
+ *        否則原地重用；池中無可用緩衝區時暫停接收，
+ *        待 Link_ReleaseFrame() 歸還後再恢復。
+ */
+static void rx_restart_from_isr(uint16_t pos, uint16_t tail, BaseType_t *pxHigherPriorityTaskWoken) {
+	uartRxBuf_TypeDef *next = NULL;
+
+	if (pRxBuf->refCnt > 1 &&
+	    xQueueReceiveFromISR(xFreeBufferQueue, &next, pxHigherPriorityTaskWoken) != pdTRUE) {
+		pausedTailPos = pos;
+		pausedTailLen = tail;
+		rxPaused = true;
+		linkStats.rxPaused++;
+		return;
+	}
+
+	uartRxBuf_TypeDef *old = rx_rearm(pos, tail, next);
+	if (old != NULL) {
+		buf_put_from_isr(old, pxHigherPriorityTaskWoken);
+	}
+}
+
+/**
+ * @brief 恢復暫停中的接收 (任務環境)
+ */
+static void rx_resume(void) {
+	uartRxBuf_TypeDef *next = NULL;
+	uartRxBuf_TypeDef *old = NULL;
+
+	// 進入臨界區保護，避免與 ISR 衝突
+	taskENTER_CRITICAL();
+	if (rxPaused) {
+		if (pRxBuf->refCnt == 1 || xQueueReceive(xFreeBufferQueue, &next, 0) == pdTRUE) {
+			rxPaused = false;
+			old = rx_rearm(pausedTailPos, pausedTailLen, next);
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	if (old != NULL) {
+		buf_put(old);
+	}
+}
+
+static void rx_dispatch(uartRxBuf_TypeDef *buf, uint8_t ch, const uint8_t *payload, uint16_t len,
+                        BaseType_t *pxHigherPriorityTaskWoken) {
+	LinkFrame_TypeDef frame = {buf, payload, len, ch};
+	LinkRxHandler handler = rxHandlers[ch];
+
+	linkStats.rxFrames++;
+	if (handler == NULL) {
+		linkStats.rxDropped++;
+		return;
+	}
+
+	// 先加參考，處理函式可能立即把封包交給更高優先權的任務
+	buf->refCnt++;
+	if (!handler(&frame, pxHigherPriorityTaskWoken)) {
+		buf->refCnt--;
+	}
+}
+
+/**
+ * @brief 解析 buf 中 [0, end) 的資料並分派完整封包
+ * @return 第一個未處理位元組的位置，其後為尚未收完的半包
+ */
+static uint16_t rx_parse(uartRxBuf_TypeDef *buf, uint16_t end, BaseType_t *pxHigherPriorityTaskWoken) {
+	const uint8_t *d = (const uint8_t *) buf->data;
+	uint16_t pos = 0;
+
+	while (end - pos >= LINK_HDR_SIZE) {
+		if (d[pos] != LINK_SOF0 || d[pos + 1] != LINK_SOF1) {
+			pos++;
+			continue;
+		}
+
+		uint8_t ch = d[pos + 2];
+		uint16_t len = d[pos + 3] | (uint16_t) (d[pos + 4] << 8);
+		if (ch >= LINK_CH_COUNT || len > LINK_MAX_RX_PAYLOAD) {
+			linkStats.rxHdrErr++;
+			pos++;
+			continue;
+		}
+
+		if (end - pos < LINK_OVERHEAD + len) {
+			break; // 半包，等待下一次 IDLE
+		}
+
+		const uint8_t *payload = d + pos + LINK_HDR_SIZE;
+		uint16_t crc = payload[len] | (uint16_t) (payload[len + 1] << 8);
+		if (crc16_update(LINK_CRC_INIT, d + pos + 2, 3 + len) != crc) {
+			linkStats.rxCrcErr++;
+			pos++;
+			continue;
+		}
+
+		rx_dispatch(buf, ch, payload, len, pxHigherPriorityTaskWoken);
+		pos += LINK_OVERHEAD + len;
+	}
+
+	return pos;
+}
+
+void Link_Init(void) {
+	Uart_Rx_Pool_Init();
+
+	if (xQueueReceive(xFreeBufferQueue, &pRxBuf, 0) != pdTRUE) {
+		LOG_W("no rx buffer available!\r\n");
+		Error_Handler();
+	}
+	pRxBuf->refCnt = 1;
+	rxPaused = false;
+	rx_start(0);
+	__HAL_UART_ENABLE_IT(&ESP32_USART_PORT, UART_IT_IDLE);
+	LOG_D("link layer inited.\r\n");
+}
+
+void Link_SetRxHandler(LinkChannel_TypeDef ch, LinkRxHandler handler) {
+	if (ch < LINK_CH_COUNT) {
+		rxHandlers[ch] = handler;
+	}
+}
+
+void Link_RxIdleCallback(void) {
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+	if (rxPaused) {
+		return; // DMA 已停止，等待緩衝區歸還
+	}
+
+	HAL_UART_AbortReceive(&ESP32_USART_PORT);
+	uint16_t end = UART_RX_BUFFER_SIZE - __HAL_DMA_GET_COUNTER(ESP32_USART_PORT.hdmarx);
+	pRxBuf->len = end;
+
+	uint16_t pos = rx_parse(pRxBuf, end, &xHigherPriorityTaskWoken);
+	uint16_t tail = end - pos;
+	if (tail >= UART_RX_BUFFER_SIZE) {
+		// 緩衝區已滿仍無完整封包，只能丟棄
+		linkStats.rxOverflow++;
+		pos = end;
+		tail = 0;
+	}
+
+	rx_restart_from_isr(pos, tail, &xHigherPriorityTaskWoken);
+	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+void Link_RxErrorCallback(void) {
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+	if (rxPaused) {
+		return;
+	}
+	// 錯誤發生時的半包必定損壞，直接丟棄
+	rx_restart_from_isr(0, 0, &xHigherPriorityTaskWoken);
+	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+void Link_RetainFrameFromISR(const LinkFrame_TypeDef *frame) {
+	if (frame == NULL || frame->buf == NULL) {
+		return;
+	}
+
+	UBaseType_t savedIrq = taskENTER_CRITICAL_FROM_ISR();
+	frame->buf->refCnt++;
+	taskEXIT_CRITICAL_FROM_ISR(savedIrq);
+}
+
+void Link_ReleaseFrame(const LinkFrame_TypeDef *frame) {
+	if (frame == NULL || frame->buf == NULL) {
+		return;
+	}
+
+	buf_put(frame->buf);
+	if (rxPaused) {
+		rx_resume();
+	}
+}
+
+HAL_StatusTypeDef Link_Send(LinkChannel_TypeDef ch, const void *data, uint16_t len) {
+	uint8_t hdr[LINK_HDR_SIZE];
+	uint8_t crcBuf[LINK_CRC_SIZE];
+
+	if (ch >= LINK_CH_COUNT || (data == NULL && len != 0) || len > LINK_MAX_TX_PAYLOAD) {
+		linkStats.txErr++;
+		return HAL_ERROR;
+	}
+
+	hdr[0] = LINK_SOF0;
+	hdr[1] = LINK_SOF1;
+	hdr[2] = (uint8_t) ch;
+	hdr[3] = (uint8_t) len;
+	hdr[4] = (uint8_t) (len >> 8);
+
+	uint16_t crc = crc16_update(LINK_CRC_INIT, hdr + 2, 3);
+	crc = crc16_update(crc, data, len);
+	crcBuf[0] = (uint8_t) crc;
+	crcBuf[1] = (uint8_t) (crc >> 8);
+
+	const UartTxPart_TypeDef parts[] = {
+		{hdr, sizeof(hdr)},
+		{data, len},
+		{crcBuf, sizeof(crcBuf)},
+	};
+	HAL_StatusTypeDef status = UART_SendParts_DMA(&ESP32_USART_PORT, parts, 3);
+	if (status == HAL_OK) {
+		linkStats.txFrames++;
+	} else {
+		linkStats.txErr++;
+	}
+	return status;
+}
+
+HAL_StatusTypeDef Link_SendString(LinkChannel_TypeDef ch, const char *str) {
+	if (str == NULL) {
+		return HAL_ERROR;
+	}
+	return Link_Send(ch, str, (uint16_t) strlen(str));
+}
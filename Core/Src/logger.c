@@ -0,0 +1,80 @@
+/**
+ * @file    logger.c
+ * @brief   分級日誌的執行期等級與設定命令，說明見 logger.h
+ */
+
+#define LOG_MODULE CMD
+#include "logger.h"
+#include <stdio.h>
+#include <string.h>
+#include "link.h"
+
+#define LOG_MOD_NAME_(id, name)  name,
+static const char *const modName[LOG_MOD_COUNT] = {
+	LOG_MODULE_TABLE(LOG_MOD_NAME_)
+};
+#undef LOG_MOD_NAME_
+
+static const char *const levelName[] = {"off", "error", "warn", "info", "debug"};
+
+#define LOG_MOD_DEFAULT_(id, name) LOG_RUNTIME_DEFAULT,
+volatile uint8_t logLevels[LOG_MOD_COUNT] = {
+	LOG_MODULE_TABLE(LOG_MOD_DEFAULT_)
+};
+#undef LOG_MOD_DEFAULT_
+
+/**
+ * @brief 解析等級 (數字或名稱)
+ * @return 等級，無效時回傳 -1
+ */
+static int parse_level(const char *s) {
+	if (s[0] >= '0' && s[0] <= '9' && s[1] == '\0') {
+		return (s[0] - '0' <= LOG_LEVEL_DEBUG) ? s[0] - '0' : -1;
+	}
+	for (int i = 0; i <= LOG_LEVEL_DEBUG; i++) {
+		if (strcmp(s, levelName[i]) == 0) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+void SetLogLevelHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
+	char param[32] = {0};
+	char buf[LINK_MAX_TX_PAYLOAD];
+	int n;
+
+	if (extract_parameter(args, len, param, sizeof(param))) {
+		char *eq = strchr(param, '=');
+		int level = (eq != NULL) ? parse_level(eq + 1) : -1;
+		bool found = false;
+
+		if (level >= 0) {
+			*eq = '\0';
+			for (int i = 0; i < LOG_MOD_COUNT; i++) {
+				if (strcmp(param, "all") == 0 || strcmp(param, modName[i]) == 0) {
+					logLevels[i] = (uint8_t) level;
+					found = true;
+				}
+			}
+		}
+		if (!found) {
+			LOG_W("Invalid log level parameter\r\n");
+			Link_SendString(LINK_CH_RSP, "LogLevel:invalid\n");
+			return;
+		}
+	}
+
+	// 回報各模組目前等級 (數字，見 LOG_LEVEL_xxx)
+	n = snprintf(buf, sizeof(buf), "LogLevel:build=%d", LOG_BUILD_LEVEL);
+	for (int i = 0; i < LOG_MOD_COUNT && n < (int) sizeof(buf); i++) {
+		n += snprintf(buf + n, sizeof(buf) - (size_t) n, ",%s=%u", modName[i], logLevels[i]);
+	}
+	if (n < (int) sizeof(buf) - 1) {
+		buf[n++] = '\n';
+		buf[n] = '\0';
+	} else {
+		n = (int) sizeof(buf) - 1;
+	}
+	Link_Send(LINK_CH_RSP, buf, (uint16_t) n);
+}
@@ -31,18 +31,20 @@
 
 #include "bsp_led.h"
 #include "ff.h"
-#include "sdio_test.h"
 
 #include "bsp_xpt2046_lcd.h"
 #include "printerController.h"
 #include "Fatfs_SDIO.h"
 #include "GUI.h"
 #include "hx711.h"
+#include "trace.h"
+
+#define LOG_MODULE MAIN
+#include "logger.h"
 
 void SystemClock_Config(void);
 void MX_FREERTOS_Init(void);
 uint8_t ILI9341_Read_MADCTL(void);
-void Sanitize_SD_Bus(void);
 
 
 /**
@@ -53,29 +55,40 @@ int main(void) {
 	/*------------BSP HAL INIT------------*/
 	HAL_Init();
 	SystemClock_Config();
+	Trace_Init(); // 在建立任何任務與佇列前開始記錄
 	MX_GPIO_Init();
 	MX_DMA_Init();
 	MX_USART1_UART_Init();
 	MX_USART2_UART_Init();
 	MX_USART3_UART_Init();
+	Uart_Tx_Init();
 	__HAL_RCC_CRC_CLK_ENABLE();
 	/*------------CUSTOMIZE FUNC INIT------------*/
 	LED_GPIO_Config();
 	XPT2046_Init();
 	PC_init();
-	Sanitize_SD_Bus();
-	SDIO_FatFs_init();
+	// SD 匯流排重置與掛載改由開機工作者並行執行 (boot.c)；GUI 仍在此初始化，
+	// 避免與其他任務同時修改 GPIOD/GPIOE 的設定暫存器
 	GUI_Init();
-	printf("%-20s GUI 初始化完成\r\n", "[main.c]");
+	LOG_I("GUI 初始化完成\r\n");
 	/*-----------------RTOS INIT-----------------*/
 	osKernelInitialize();
 	MX_FREERTOS_Init();
-	Uart_Sync_Init();
 	osKernelStart();
 	while (1) {
 	}
 }
 
+/**
+  * @brief 半個 SD 時脈週期 (約 5us，時脈約 100kHz，低於識別模式的 400kHz 上限)
+  *        原本每半週期 HAL_Delay(1)，80 個時脈就佔去 160ms 開機時間
+  */
+static void SD_Bus_HalfClock(void)
+{
+	for (volatile uint32_t n = SystemCoreClock / 1000000U; n > 0; n--) {
+	}
+}
+
 /* -------------------------------------------------------------------------- */
 /* 函式名稱：Sanitize_SD_Bus                                                 */
 /* 功能：手動重置 SD 卡匯流排，解除 Busy 鎖死與同步狀態機                      */
@@ -102,9 +115,9 @@ void Sanitize_SD_Bus(void)
 	for(int i = 0; i < 80; i++)
 	{
 		HAL_GPIO_WritePin(GPIOC, GPIO_PIN_12, GPIO_PIN_SET);   // CK High
-		HAL_Delay(1); // 延遲 1ms，確保頻率極低 (<400kHz)，安全第一
+		SD_Bus_HalfClock();
 		HAL_GPIO_WritePin(GPIOC, GPIO_PIN_12, GPIO_PIN_RESET); // CK Low
-		HAL_Delay(1);
+		SD_Bus_HalfClock();
 	}
 	HAL_GPIO_DeInit(GPIOC, GPIO_PIN_8 | GPIO_PIN_9 | GPIO_PIN_10 | GPIO_PIN_11 | GPIO_PIN_12);
 	HAL_GPIO_DeInit(GPIOD, GPIO_PIN_2);
@@ -2,11 +2,23 @@
 #include <stdlib.h>
 #include "cmsis_os.h"
 #include "Fatfs_SDIO.h"
+#include "sd_bench.h"
 #include "esp32.h"
 #include "hx711.h"
 #include "fileTask.h"
 #include "cmdList.h"
 #include "ui_updater.h"
+#include "link.h"
+#include "estop.h"
+#include "fileList.h"
+#include "fileCatalog.h"
+#include "fileReader.h"
+#include "boot.h"
+#include "trace.h"
+#include "heapStats.h"
+
+#define LOG_MODULE PRINTER
+#include "logger.h"
 
 
 /*-----存放印表機各項參數-----*/
@@ -49,9 +61,19 @@ volatile bool printerOkReceived = false;
 char printerRxBuf[PRINTER_RX_BUF_SIZE] __attribute__((aligned(4)));
 volatile uint16_t printerRxLen = 0;
 
-static void PC_ParseRemainingTime(FIL *file);
+static void PC_ParseRemainingTime(FileReader_TypeDef *reader);
 static void PC_ParseTemperatureFromResponse(const char *response);
 
+/*-----fast-seek-----*/
+#define PRINT_CLMT_WORDS     64            // 叢集對照表長度 (DWORD)，可容納 31 個不連續片段
+#define PRINT_SEEK_NONE      0xFFFFFFFFUL
+
+static DWORD printClmt[PRINT_CLMT_WORDS];  // 只有一個列印任務，對照表隨 FIL 使用至關檔
+static volatile DWORD seekRequest = PRINT_SEEK_NONE;
+
+static void PC_AttachSeekMap(FIL *file);
+static void PC_SeekToLine(FileReader_TypeDef *reader, DWORD offset, char *lineBuf, UINT lineSize);
+
 // 預設超時時間 (毫秒)
 #define GCODE_DEFAULT_TIMEOUT_MS     10000   // 一般命令 10 秒
 #define GCODE_BLOCKING_TIMEOUT_MS   300000   // 阻塞命令 (M109/M190/G28) 5 分鐘
@@ -111,13 +133,10 @@ static bool PC_SendGcodeAndWaitOk(const char *gcode_line) {
 	HAL_UART_Receive_DMA(&huart3, (uint8_t*)printerRxBuf, sizeof(printerRxBuf) - 1);
 	__HAL_UART_ENABLE_IT(&huart3, UART_IT_IDLE);
 	
-	// 發送 G-code（阻塞式確保發送完成）
-	HAL_StatusTypeDef uart_status = HAL_UART_Transmit(&huart3,
-	                                                   (uint8_t*)gcode_line,
-	                                                   strlen(gcode_line),
-	                                                   1000);
+	// 發送 G-code（與其他 USART3 傳輸共用發送環形緩衝區，依序送出）
+	HAL_StatusTypeDef uart_status = UART_SendString_DMA(&huart3, gcode_line);
 	if (uart_status != HAL_OK) {
-		printf("%-20s UART TX failed: %d\r\n", "[printerController.c]", uart_status);
+		LOG_E("UART TX failed: %d\r\n", uart_status);
 		HAL_UART_AbortReceive(&huart3);
 		return false;
 	}
@@ -167,12 +186,11 @@ static bool PC_SendGcodeAndWaitOk(const char *gcode_line) {
 	
 	// 總超時
 	HAL_UART_AbortReceive(&huart3);
-	printf("%-20s Timeout waiting for ok (cmd: %.20s...)\r\n", "[printerController.c]", gcode_line);
+	LOG_W("Timeout waiting for ok (cmd: %.20s...)\r\n", gcode_line);
 	return false;
 }
 
 void PC_init(void) {
-	PC_RegCallback();
 	pcParameter.nozzleTemp = 0;
 	pcParameter.bedTemp = 0;
 	pcParameter.filamentWeight = 0;
@@ -186,24 +204,11 @@ void PC_init(void) {
 	printerRxSemaphore = NULL;
 }
 
-void PC_RegCallback(void) {
-	register_command(CMD_Start_To_Print, StartToPrintHandler);
-	register_command(CMD_Pause_Printing, PausePrintingHandler);
-	register_command(CMD_Stop_printing, StopPrintingHandler);
-	register_command(CMD_Go_Home, GoHomeHandler);
-	register_command(CMD_Get_Remainning_time, GetRemainingTimeHandler);
-	register_command(CMD_Get_Progress, GetProgressHandler);
-	register_command(CMD_Get_Nozzle_Temp, GetNozzleTempHandler);
-	register_command(CMD_Get_Bed_Temp, GetBedTempHandler);
-	register_command(CMD_Set_Nozzle_Temp, SetNozzleTempHandler);
-	register_command(CMD_Set_Bed_Temp, SetBedTempHandler);
-	register_command(CMD_GetFilament_Weight, GetFilamentWeightHandler);
-	register_command(CMD_Emergency_Stop, EmergencyStopHandler);
-	register_command(CMD_GET_ALL_FILES, GetAllFilesHandler);
-}
-
 void PC_Print_Task(void *argument) {
 	FIL file;
+	FileReader_TypeDef reader;
+	BYTE *readBuf = NULL;
+	UINT readBufSize;
 	FRESULT f_res;
 
 	bool file_opened = false;
@@ -218,30 +223,45 @@ void PC_Print_Task(void *argument) {
 	if (printerRxSemaphore == NULL) {
 		printerRxSemaphore = xSemaphoreCreateBinary();
 		if (printerRxSemaphore == NULL) {
-			printf("%-20s Failed to create semaphore\r\n", "[printerController.c]");
+			LOG_E("Failed to create semaphore\r\n");
 			goto CleanRes;
 		}
 	}
 
 	//================ 錯誤處理 ================//
 	if (strlen(curFileName) <= 0) {
-		printf("%-20s no file selected\r\n", "[printerController.c]");
+		LOG_W("no file selected\r\n");
 		goto CleanRes;
 	}
 	f_res = f_open(&file, curFileName, FA_READ);
 	if (f_res != FR_OK) {
-		printf("%-20s Failed to open file: %s\r\n", "[printerController.c]", curFileName);
+		LOG_E("Failed to open file: %s\r\n", curFileName);
 		printf_fatfs_error(f_res);
 		goto CleanRes;
 	}
 	file_opened = true;
 	if (f_size(&file) <= 0) {
-		printf("%-20s file has no content\r\n", "[printerController.c]");
+		LOG_W("file has no content\r\n");
+		goto CleanRes;
+	}
+
+	// 讀取緩衝區只在列印期間佔用堆積，每次補充數個磁區 (一個 CMD18)
+	// 長度依可配置的大小而定 (4096 → 2048 → 1024 → 512)
+	for (readBufSize = FILE_READER_BUF_SIZE; readBufSize >= 512U; readBufSize /= 2) {
+		readBuf = pvPortMalloc(readBufSize);
+		if (readBuf != NULL) {
+			break;
+		}
+	}
+	if (readBuf == NULL) {
+		LOG_E("no memory for read buffer\r\n");
 		goto CleanRes;
 	}
 
 	PC_SetState(PC_BUSY);
-	PC_ParseRemainingTime(&file); // 取得列印時間
+	PC_AttachSeekMap(&file); // 之後的 f_lseek 不需走訪 FAT 鏈
+	FileReader_Init(&reader, &file, readBuf, readBufSize);
+	PC_ParseRemainingTime(&reader); // 取得列印時間
 	initial_total_seconds = pcParameter.remainingTime.hours * 3600 + 
 	                        pcParameter.remainingTime.minutes * 60 + 
 	                        pcParameter.remainingTime.seconds;
@@ -250,34 +270,38 @@ void PC_Print_Task(void *argument) {
 
 	//================ 開始列印 ================//
 	UI_Update_Status("Printing...");
-	f_lseek(&file, 0);
+	FileReader_Seek(&reader, 0);
 	pause = false;
 	last_time_update = xTaskGetTickCount();
 	while (1) {
+		// 續印、跳層或預覽拖曳要求的位置，於行與行之間套用
+		if (seekRequest != PRINT_SEEK_NONE) {
+			DWORD target = seekRequest;
+			seekRequest = PRINT_SEEK_NONE;
+			PC_SeekToLine(&reader, target, gcode_line, sizeof(gcode_line));
+		}
 		memset(gcode_line, 0, sizeof(gcode_line));
-		if (f_gets(gcode_line, sizeof(gcode_line), &file) == NULL) {
-			if (f_eof(&file)) {
-				printf("\r\n%-20s printTask completed! line: %d file: %s\r\n", "[printerController.c]", line,
-				       curFileName);
-			} else if (f_error(&file)) {
-				printf("\r\n%-20s file read err:", "[printerController.c]");
-				printf_fatfs_error(f_error(&file));
+		if (FileReader_GetLine(&reader, gcode_line, sizeof(gcode_line)) == NULL) {
+			if (FileReader_Eof(&reader)) {
+				LOG_I("printTask completed! line: %lu file: %s\r\n", line, curFileName);
+			} else if (FileReader_Error(&reader)) {
+				LOG_E("file read err: %d\r\n", FileReader_Error(&reader));
 			}
 			break; // 正常列印完成
 		}
 		if (stopRequested) {
-			printf("%-20s Stop requested by user. Terminating task.\r\n", "[printerController.c]");
+			LOG_I("Stop requested by user. Terminating task.\r\n");
 			break;
 		}
 		while (pause) {
 			osDelay(pdMS_TO_TICKS(10));
 			if (stopRequested) {
-				printf("%-20s Stop requested during pause. Terminating task.\r\n", "[printerController.c]");
+				LOG_I("Stop requested during pause. Terminating task.\r\n");
 				goto CleanRes;
 			}
 		}
 		line++;
-		bytes_read = f_tell(&file); // 更新進度
+		bytes_read = FileReader_Tell(&reader); // 更新進度
 		if (file_size > 0) {
 			pcParameter.progress = (uint8_t)((bytes_read * 100) / file_size);
 		}
@@ -299,12 +323,15 @@ void PC_Print_Task(void *argument) {
 			continue;
 		}
 
-		// 發送 G-code 並等待 "ok" (根據 Marlin 協議)
-		if (!PC_SendGcodeAndWaitOk(gcode_line)) {
+		// 發送 G-code 並等待 "ok" (根據 Marlin 協議)，追蹤區段涵蓋整個來回
+		TRACE_SPAN_BEGIN(TRACE_SPAN_GCODE_SEND, line);
+		bool sent = PC_SendGcodeAndWaitOk(gcode_line);
+		TRACE_SPAN_END(TRACE_SPAN_GCODE_SEND);
+		if (!sent) {
 			if (stopRequested) {
-				printf("%-20s Stop requested, terminating.\r\n", "[printerController.c]");
+				LOG_I("Stop requested, terminating.\r\n");
 			} else {
-				printf("%-20s Failed at line %lu, continuing...\r\n", "[printerController.c]", line);
+				LOG_W("Failed at line %lu, continuing...\r\n", line);
 				// 可選：繼續列印還是停止？這裡選擇繼續
 			}
 		}
@@ -313,6 +340,7 @@ CleanRes:
 	if (file_opened) {
 		f_close(&file);
 	}
+	vPortFree(readBuf);
 	if (!stopRequested) {
 		pcParameter.progress = 100;
 		pcParameter.remainingTime.hours = 0;
@@ -362,7 +390,7 @@ void PC_QueryTemperature(void) {
 	printerOkReceived = false;
 
 	// 發送 M105 命令
-	HAL_UART_Transmit(&PRINTING_USART_PORT, (uint8_t*)"M105\r\n", 6, 100);
+	UART_SendString_DMA(&PRINTING_USART_PORT, "M105\r\n");
 
 	// 啟動 DMA 接收
 	HAL_UART_Receive_DMA(&PRINTING_USART_PORT, (uint8_t*)printerRxBuf, sizeof(printerRxBuf) - 1);
@@ -413,6 +441,9 @@ void PC_QueryFilamentWeight(void) {
 	if (ESP32_GetState() == ESP32_BUSY) {
 		return;
 	}
+	if (!Boot_IsDone(BOOT_STEP_HX711)) {
+		return; // 仍在穩定與歸零
+	}
 	float weight_g = Hx711_GetWeight(&hx711, 3);
 	pcParameter.filamentWeight = (int)weight_g;
 }
@@ -433,46 +464,88 @@ void PC_Param_Polling(void) {
 	}
 }
 
-void StartToPrintHandler(const char *args, ResStruct_t *_resStruct) {
+void PC_GetStatusRecord(PC_StatusRecord_TypeDef *record) {
+	PC_Parameter_TypeDef param;
+
+	if (record == NULL) {
+		return;
+	}
+
+	// 參數由多個任務更新，複製一份一致的快照
+	taskENTER_CRITICAL();
+	param = pcParameter;
+	taskEXIT_CRITICAL();
+
+	record->tag = PC_STATUS_TAG;
+	record->version = PC_STATUS_VERSION;
+	record->pcState = (uint8_t) PC_GetState();
+	record->espState = (uint8_t) ESP32_GetState();
+	record->flags = (isTransmittimg ? PC_STATUS_FLAG_UPLOADING : 0) |
+	                (pause ? PC_STATUS_FLAG_PAUSED : 0) |
+	                (isWebConnected ? PC_STATUS_FLAG_WEB : 0);
+	record->nozzleTemp = param.nozzleTemp;
+	record->bedTemp = param.bedTemp;
+	record->progress = param.progress;
+	record->filamentWeight = param.filamentWeight;
+	record->remainHours = param.remainingTime.hours;
+	record->remainMinutes = param.remainingTime.minutes;
+	record->remainSeconds = param.remainingTime.seconds;
+	record->uploadBytes = FileTask_GetUploadedBytes();
+}
+
+void StartToPrintHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
+	if (!Boot_StorageReady()) {
+		LOG_W("storage not ready, print rejected\r\n");
+		Link_SendString(LINK_CH_RSP, "Error: booting\n");
+		return;
+	}
+	if (SdBench_IsRunning()) {
+		LOG_W("SD bench running, print rejected\r\n");
+		Link_SendString(LINK_CH_RSP, "Error: busy\n");
+		return;
+	}
 	// 從參數中提取檔名
-	if (!extract_parameter(args, curFileName, FILENAME_SIZE)) {
-		printf("%-20s Invalid filename format\r\n", "[printerController.c]");
+	if (!extract_parameter(args, len, curFileName, FILENAME_SIZE)) {
+		LOG_W("Invalid filename format\r\n");
 		return;
 	}
-	printf("%-20s Start printing: %s\r\n", "[printerController.c]", curFileName);
+	LOG_I("Start printing: %s\r\n", curFileName);
 	
 	stopRequested = false;
+	seekRequest = PRINT_SEEK_NONE;
+	// 上傳或前一次列印仍在進行時其配置必然存活，只重設基準
+	HeapStats_JobMark("print", pcTaskHandle == NULL && gcodeRxTaskHandle == NULL);
 	pcTaskHandle = osThreadNew(PC_Print_Task, NULL, &pcTask_attributes);
 	if (pcTaskHandle == NULL) {
-		printf("%-20s Error creating pcPrintTask\r\n", "[printerController.c]");
+		LOG_E("Error creating pcPrintTask\r\n");
 		ESP32_SetState(ESP32_IDLE);
 	}
 }
 
-void PausePrintingHandler(const char *args, ResStruct_t *_resStruct) {
+void PausePrintingHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
 	static bool i = 0;
 	//通知印表機控制器暫停發送gcode
 	i = !i;
 	pause = i;
 }
 
-void StopPrintingHandler(const char *args, ResStruct_t *_resStruct) {
+void StopPrintingHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
 	pause = false;
 	ESP32_SetState(ESP32_IDLE);
 
 	if (pcTaskHandle != NULL) {
-		printf("%-20s Sending stop request to print task...\r\n", "[printerController.c]");
+		LOG_I("Sending stop request to print task...\r\n");
 		stopRequested = true;
 	}
 	UART_SendString_DMA(&PRINTING_USART_PORT, "G28\r\nM104 S0\r\nM140 S0\r\n");
 }
 
-void GoHomeHandler(const char *args, ResStruct_t *_resStruct) {
+void GoHomeHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
 	/*       回原點       */
 	UART_SendString_DMA(&PRINTING_USART_PORT, "G28\r\n");
 }
 
-void GetRemainingTimeHandler(const char *args, ResStruct_t *_resStruct) {
+void GetRemainingTimeHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
 	// 直接回傳快取值（非阻塞）
 	if (_resStruct != NULL) {
 		int total_seconds = pcParameter.remainingTime.hours * 3600 + 
@@ -482,14 +555,14 @@ void GetRemainingTimeHandler(const char *args, ResStruct_t *_resStruct) {
 	}
 }
 
-void GetProgressHandler(const char *args, ResStruct_t *_resStruct) {
+void GetProgressHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
 	// 直接回傳快取值（非阻塞）
 	if (_resStruct != NULL) {
 		sprintf(_resStruct->resBuf, "Progress:%d\n", pcParameter.progress);
 	}
 }
 
-void GetNozzleTempHandler(const char *args, ResStruct_t *_resStruct) {
+void GetNozzleTempHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
 	// 直接回傳快取值（非阻塞）
 	// 溫度會由 PC_QueryTemperature() 在背景定期更新
 	if (_resStruct != NULL) {
@@ -497,14 +570,14 @@ void GetNozzleTempHandler(const char *args, ResStruct_t *_resStruct) {
 	}
 }
 
-void GetBedTempHandler(const char *args, ResStruct_t *_resStruct) {
+void GetBedTempHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
 	// 直接回傳快取值（非阻塞）
 	if (_resStruct != NULL) {
 		sprintf(_resStruct->resBuf, "BedTemp:%d\n", pcParameter.bedTemp);
 	}
 }
 
-void GetFilamentWeightHandler(const char *args, ResStruct_t *_resStruct) {
+void GetFilamentWeightHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
 	// 直接回傳快取的重量值（非阻塞）
 	// 重量會由 PC_QueryFilamentWeight() 在背景定期更新
 	if (_resStruct != NULL) {
@@ -512,59 +585,70 @@ void GetFilamentWeightHandler(const char *args, ResStruct_t *_resStruct) {
 	}
 }
 
-void SetNozzleTempHandler(const char *args, ResStruct_t *_resStruct) {
-	char tmp[10] = {0};
+void SetNozzleTempHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
+	uint32_t temp = 0;
 	char gcode_cmd[32] = {0};
 
-	extract_parameter(args, tmp, sizeof(tmp) - 1);
-	int temp = atoi(tmp);
+	// 格式錯誤時不可送出 S0，否則會在列印中關閉加熱
+	if (!get_uint_parameter(args, len, &temp)) {
+		LOG_W("Invalid nozzle temp\r\n");
+		Link_SendString(LINK_CH_RSP, "Error: invalid temperature\n");
+		return;
+	}
 	
 	// 限制溫度範圍 (安全性)
-	if (temp < 0) temp = 0;
 	if (temp > 280) temp = 280;
 	
 	pcParameter.nozzleTemp = (uint8_t)temp;
 	
 	// 發送 M104 設定噴嘴溫度
-	snprintf(gcode_cmd, sizeof(gcode_cmd), "M104 S%d\r\n", temp);
+	snprintf(gcode_cmd, sizeof(gcode_cmd), "M104 S%u\r\n", (unsigned int) temp);
 	UART_SendString_DMA(&PRINTING_USART_PORT, gcode_cmd);
 	
-	printf("%-20s set nozzle temp to %d deg.\r\n", "[printerController.c]", pcParameter.nozzleTemp);
+	LOG_I("set nozzle temp to %d deg.\r\n", pcParameter.nozzleTemp);
 }
 
-void SetBedTempHandler(const char *args, ResStruct_t *_resStruct) {
-	char tmp[10] = {0};
+void SetBedTempHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
+	uint32_t temp = 0;
 	char gcode_cmd[32] = {0};
 
-	extract_parameter(args, tmp, sizeof(tmp) - 1);
-	int temp = atoi(tmp);
+	// 格式錯誤時不可送出 S0，否則會在列印中關閉加熱
+	if (!get_uint_parameter(args, len, &temp)) {
+		LOG_W("Invalid bed temp\r\n");
+		Link_SendString(LINK_CH_RSP, "Error: invalid temperature\n");
+		return;
+	}
 	
 	// 限制溫度範圍 (安全性)
-	if (temp < 0) temp = 0;
 	if (temp > 120) temp = 120;
 	
 	pcParameter.bedTemp = (uint8_t)temp;
 	
 	// 發送 M140 設定熱床溫度
-	snprintf(gcode_cmd, sizeof(gcode_cmd), "M140 S%d\r\n", temp);
+	snprintf(gcode_cmd, sizeof(gcode_cmd), "M140 S%u\r\n", (unsigned int) temp);
 	UART_SendString_DMA(&PRINTING_USART_PORT, gcode_cmd);
 	
-	printf("%-20s set bed temp to %d deg.\r\n", "[printerController.c]", pcParameter.bedTemp);
+	LOG_I("set bed temp to %d deg.\r\n", pcParameter.bedTemp);
 }
 
-void EmergencyStopHandler(const char *args, ResStruct_t *_resStruct) {
-	// 發送 M112 緊急停止命令
-	UART_SendString_DMA(&PRINTING_USART_PORT, "M112\r\n");
-	
+void EmergencyStopHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
+	// M112 由緊急停止任務搶先送出，不與一般 G-code 排隊
+	Estop_Trigger();
+}
+
+void PC_OnEmergencyStop(void) {
+	uint16_t dropped;
+
 	// 停止列印任務
 	stopRequested = true;
 	pause = false;
-	
-	// 關閉加熱器
+
+	// 丟棄排在 M112 後面的 G-code，關閉加熱器的命令不必排在它們之後
+	dropped = UART_DiscardPending(&PRINTING_USART_PORT);
 	UART_SendString_DMA(&PRINTING_USART_PORT, "M104 S0\r\nM140 S0\r\n");
-	
+
 	PC_SetState(PC_ERROR);
-	printf("%-20s EMERGENCY STOP activated!\r\n", "[printerController.c]");
+	LOG_W("EMERGENCY STOP activated, %u queued bytes dropped\r\n", dropped);
 }
 
 /**
@@ -575,123 +659,130 @@ static void extMrlResToMem(const char *args) {
 }
 
 /**
- * @brief 從 G-code 檔案開頭解析預估的列印時間
- * @param file 指向已開啟檔案的 FIL 物件指標
- * @note 會直接更新全域的 pcParameter.remainingTime
+ * @brief 為列印檔設定 fast-seek 叢集對照表
+ *        先嘗試載入已保存的對照表，檔案不同或沒有保存時走訪一次 FAT 鏈建立並保存；
+ *        檔案過於破碎 (超過 PRINT_CLMT_WORDS) 時維持一般 seek
  */
-static void PC_ParseRemainingTime(FIL *file) {
-	char gcode_line[256] = {0};
-	UINT fnum = 0;
-
-	f_read(file, gcode_line, sizeof(gcode_line) - 1, &fnum);
-	gcode_line[sizeof(gcode_line) - 1] = '\0';
-
-	const char *search_string = ";Print time: ";
-	char *pos = strstr(gcode_line, search_string);
-
-	if (pos != NULL) {
-		pos += strlen(search_string);
-		// 解析時間格式，可能是 "HH:MM:SS" 或 "MM:SS" 或只有秒數
-		int hours = 0, minutes = 0, seconds = 0;
-		int parsed = sscanf(pos, "%d:%d:%d", &hours, &minutes, &seconds);
-		if (parsed == 3) {
-			pcParameter.remainingTime.hours = (uint8_t)hours;
-			pcParameter.remainingTime.minutes = (uint8_t)minutes;
-			pcParameter.remainingTime.seconds = (uint8_t)seconds;
-		} else if (parsed == 2) {
-			pcParameter.remainingTime.hours = 0;
-			pcParameter.remainingTime.minutes = (uint8_t)hours;
-			pcParameter.remainingTime.seconds = (uint8_t)minutes;
-		} else {
-			int total_seconds = atoi(pos);
-			pcParameter.remainingTime.hours = total_seconds / 3600;
-			pcParameter.remainingTime.minutes = (total_seconds % 3600) / 60;
-			pcParameter.remainingTime.seconds = total_seconds % 60;
-		}
-		printf("%-20s remaining time: %02d:%02d:%02d\r\n", "[printerController.c]", 
-		       pcParameter.remainingTime.hours, 
-		       pcParameter.remainingTime.minutes, 
-		       pcParameter.remainingTime.seconds);
-	} else {
-		printf("%-20s Did not find ';Print time: ' in G-code header\r\n", "[printerController.c]", 
-		       pcParameter.remainingTime.hours, 
-		       pcParameter.remainingTime.minutes, 
-		       pcParameter.remainingTime.seconds);
+static void PC_AttachSeekMap(FIL *file) {
+	CatalogSeekMap_TypeDef key;
+	FILINFO fno;
+	TickType_t start = xTaskGetTickCount();
+	FRESULT res;
+
+	fno.lfname = NULL;
+	fno.lfsize = 0;
+	if (file->sclust == 0 || f_stat(curFileName, &fno) != FR_OK) {
+		return;
+	}
+	key.sclust = file->sclust;
+	key.size = f_size(file);
+	key.fdate = fno.fdate;
+	key.ftime = fno.ftime;
+
+	if (Catalog_LoadSeekMap(&key, printClmt, PRINT_CLMT_WORDS)) {
+		file->cltbl = printClmt;
+		LOG_I("seek map loaded, %lu words, %lums\r\n", (unsigned long) printClmt[0],
+		      (unsigned long) (xTaskGetTickCount() - start));
+		return;
 	}
-}
 
-void GetAllFilesHandler(const char *args, ResStruct_t *_resStruct) {
-	DIR dir;
-	static FILINFO fno;  // 靜態避免堆疊溢出
-	static char lfnBuf[_MAX_LFN + 1];  // 長檔名緩衝區
-	FRESULT res;
-	static char fileListBuf[512];  // 靜態緩衝區存放檔案列表
-	uint16_t bufPos = 0;
-	
-	memset(fileListBuf, 0, sizeof(fileListBuf));
-	
-	// 設置長檔名緩衝區
-	fno.lfname = lfnBuf;
-	fno.lfsize = sizeof(lfnBuf);
-	
-	// 開啟根目錄
-	res = f_opendir(&dir, "/");
+	printClmt[0] = PRINT_CLMT_WORDS;
+	file->cltbl = printClmt;
+	res = f_lseek(file, CREATE_LINKMAP);
 	if (res != FR_OK) {
-		printf("%-20s Failed to open root dir, err=%d\r\n", "[printerController.c]", res);
-		if (_resStruct != NULL) {
-			sprintf(_resStruct->resBuf, "Error\n");
-		}
+		// FR_NOT_ENOUGH_CORE 時 printClmt[0] 為所需長度
+		LOG_W("seek map unavailable (res=%d, need %lu words)\r\n", res, (unsigned long) printClmt[0]);
+		file->cltbl = NULL;
 		return;
 	}
-	
-	// 讀取目錄中的所有檔案
-	for (;;) {
-		memset(lfnBuf, 0, sizeof(lfnBuf));
-		res = f_readdir(&dir, &fno);
-		if (res != FR_OK) {
-			printf("%-20s readdir err=%d\r\n", "[printerController.c]", res);
-			break;
-		}
-		if (fno.fname[0] == 0) {
-			break;  // 讀取結束
-		}
-		
-		// 跳過目錄和隱藏檔案
-		if (fno.fattrib & (AM_DIR | AM_HID | AM_SYS)) {
-			continue;
-		}
-		
-		// 優先使用長檔名，否則使用短檔名
-		char *fileName = (fno.lfname[0] != 0) ? fno.lfname : fno.fname;
-		
-		// 檢查緩衝區是否還有空間
-		size_t nameLen = strlen(fileName);
-		if (bufPos + nameLen + 2 >= sizeof(fileListBuf)) {
-			break;  // 緩衝區已滿
-		}
-		
-		// 添加檔名（用空格分隔）
-		if (bufPos > 0) {
-			fileListBuf[bufPos++] = ' ';
+	LOG_I("seek map built, %lu words, %lums\r\n", (unsigned long) printClmt[0],
+	      (unsigned long) (xTaskGetTickCount() - start));
+	Catalog_SaveSeekMap(&key, printClmt);
+}
+
+/**
+ * @brief 移動到 offset 所在行的下一行開頭 (offset 恰為行首時即該行)
+ * @param lineBuf 借用列印迴圈的行緩衝區丟棄不完整的行
+ */
+static void PC_SeekToLine(FileReader_TypeDef *reader, DWORD offset, char *lineBuf, UINT lineSize) {
+	char prev = '\n';
+
+	if (offset > f_size(reader->fp)) {
+		offset = f_size(reader->fp);
+	}
+	if (offset > 0) {
+		// 前一個位元組與 offset 通常在同一塊緩衝區內，第二次 seek 不需讀卡
+		if (FileReader_Seek(reader, offset - 1) != FR_OK || FileReader_Peek(reader, &prev, 1) != 1 ||
+		    FileReader_Seek(reader, offset) != FR_OK) {
+			LOG_E("seek to %lu failed\r\n", (unsigned long) offset);
+			return;
 		}
-		strcpy(&fileListBuf[bufPos], fileName);
-		bufPos += nameLen;
+	} else {
+		FileReader_Seek(reader, 0);
 	}
-	
-	f_closedir(&dir);
-	
-	// 如果沒有檔案，返回空
-	if (bufPos == 0) {
-		strcpy(fileListBuf, "NoFiles\n");
-		bufPos = strlen(fileListBuf);
+	// 不在行首時丟棄剩下的部分 (一行可能超過緩衝區長度)
+	while (prev != '\n' && FileReader_GetLine(reader, lineBuf, lineSize) != NULL) {
+		size_t n = strlen(lineBuf);
+		prev = (n > 0) ? lineBuf[n - 1] : '\n';
+	}
+	LOG_I("seek to %lu, resume at %lu\r\n", (unsigned long) offset, (unsigned long) FileReader_Tell(reader));
+}
+
+/**
+ * @brief 取得預估的列印時間，優先使用檔案目錄索引，查無紀錄時解析檔頭
+ * @param reader 位於檔頭的讀取器，檔頭只預覽不取出，列印迴圈從同一塊緩衝區開始
+ * @note 會直接更新全域的 pcParameter.remainingTime
+ */
+static void PC_ParseRemainingTime(FileReader_TypeDef *reader) {
+	static CatalogRecord_TypeDef rec; // 靜態避免堆疊溢出
+	char gcode_line[256] = {0};
+
+	if (!Catalog_Lookup(curFileName, &rec) || rec.printSeconds == CATALOG_UNKNOWN) {
+		FileReader_Peek(reader, gcode_line, sizeof(gcode_line) - 1);
+		gcode_line[sizeof(gcode_line) - 1] = '\0';
+		Catalog_ParseHeader(gcode_line, &rec);
+	}
+
+	if (rec.printSeconds != CATALOG_UNKNOWN) {
+		pcParameter.remainingTime.hours = rec.printSeconds / 3600;
+		pcParameter.remainingTime.minutes = (rec.printSeconds % 3600) / 60;
+		pcParameter.remainingTime.seconds = rec.printSeconds % 60;
+		LOG_I("remaining time: %02d:%02d:%02d\r\n", pcParameter.remainingTime.hours, pcParameter.remainingTime.minutes,
+		      pcParameter.remainingTime.seconds);
 	} else {
-		// 添加換行符
-		fileListBuf[bufPos++] = '\n';
-		fileListBuf[bufPos] = '\0';
+		LOG_W("Did not find print time in G-code header\r\n");
 	}
-	
-	printf("%-20s Files: %s", "[printerController.c]", fileListBuf);
-	
-	// 使用 DMA 發送（與其他 ESP32 通訊一致）
-	UART_SendString_DMA(&ESP32_USART_PORT, fileListBuf);
+}
+
+void GetStatusHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
+	PC_StatusRecord_TypeDef record;
+
+	// 二進位快照不經 resBuf，直接以單一封包送出
+	PC_GetStatusRecord(&record);
+	Link_Send(LINK_CH_RSP, &record, sizeof(record));
+}
+
+void GetAllFilesHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
+	int32_t cursor = 0;
+
+	// 以分頁引擎逐頁送出整個清單，每頁結尾皆有摘要行，最後一頁的 next 為 -1
+	do {
+		cursor = FileList_SendPage((uint32_t) cursor);
+	} while (cursor >= 0);
+}
+
+void SeekPrintHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
+	uint32_t offset;
+
+	if (!get_uint_parameter(args, len, &offset) || offset == PRINT_SEEK_NONE) {
+		LOG_W("Invalid seek offset\r\n");
+		Link_SendString(LINK_CH_RSP, "Error: invalid offset\n");
+		return;
+	}
+	if (pcTaskHandle == NULL) {
+		Link_SendString(LINK_CH_RSP, "Error: not printing\n");
+		return;
+	}
+	seekRequest = offset; // 列印任務於下一行之前套用
+	Link_SendString(LINK_CH_RSP, "ok\n");
 }
@@ -24,9 +24,10 @@
 #include "GUI.h"
 #include "task.h"
 #include "UITask.h"
-#include "fileTask.h"
 #include "usart.h"
+#include "link.h"
 #include "printerController.h"
+#include "trace.h"
 #include <string.h>
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
@@ -180,42 +181,54 @@ void SysTick_Handler(void) {
   * @brief This function handles DMA1 channel2 global interrupt.
   */
 void DMA1_Channel2_IRQHandler(void) {
+	TRACE_ISR_ENTER(TRACE_IRQ_DMA1_CH2);
 	HAL_DMA_IRQHandler(&hdma_usart3_tx);
+	TRACE_ISR_EXIT(TRACE_IRQ_DMA1_CH2);
 }
 
 /**
   * @brief This function handles DMA1 channel3 global interrupt.
   */
 void DMA1_Channel3_IRQHandler(void) {
+	TRACE_ISR_ENTER(TRACE_IRQ_DMA1_CH3);
 	HAL_DMA_IRQHandler(&hdma_usart3_rx);
+	TRACE_ISR_EXIT(TRACE_IRQ_DMA1_CH3);
 }
 
 /**
   * @brief This function handles DMA1 channel4 global interrupt.
   */
 void DMA1_Channel4_IRQHandler(void) {
+	TRACE_ISR_ENTER(TRACE_IRQ_DMA1_CH4);
 	HAL_DMA_IRQHandler(&hdma_usart1_tx);
+	TRACE_ISR_EXIT(TRACE_IRQ_DMA1_CH4);
 }
 
 /**
   * @brief This function handles DMA1 channel5 global interrupt.
   */
 void DMA1_Channel5_IRQHandler(void) {
+	TRACE_ISR_ENTER(TRACE_IRQ_DMA1_CH5);
 	HAL_DMA_IRQHandler(&hdma_usart1_rx);
+	TRACE_ISR_EXIT(TRACE_IRQ_DMA1_CH5);
 }
 
 /**
   * @brief This function handles DMA1 channel6 global interrupt.
   */
 void DMA1_Channel6_IRQHandler(void) {
+	TRACE_ISR_ENTER(TRACE_IRQ_DMA1_CH6);
 	HAL_DMA_IRQHandler(&hdma_usart2_rx);
+	TRACE_ISR_EXIT(TRACE_IRQ_DMA1_CH6);
 }
 
 /**
   * @brief This function handles DMA1 channel7 global interrupt.
   */
 void DMA1_Channel7_IRQHandler(void) {
+	TRACE_ISR_ENTER(TRACE_IRQ_DMA1_CH7);
 	HAL_DMA_IRQHandler(&hdma_usart2_tx);
+	TRACE_ISR_EXIT(TRACE_IRQ_DMA1_CH7);
 }
 
 /**
@@ -229,46 +242,14 @@ void USART1_IRQHandler(void) {
   * @brief This function handles USART2 global interrupt.
   */
 void USART2_IRQHandler(void) {
-	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-
+	TRACE_ISR_ENTER(TRACE_IRQ_USART2);
 	if (__HAL_UART_GET_FLAG(&ESP32_USART_PORT, UART_FLAG_IDLE)) {
 		__HAL_UART_CLEAR_IDLEFLAG(&ESP32_USART_PORT);
-		HAL_UART_AbortReceive(&ESP32_USART_PORT);
-		pCurrentRxBuf->len = UART_RX_BUFFER_SIZE - __HAL_DMA_GET_COUNTER(ESP32_USART_PORT.hdmarx);
-
-		if (pCurrentRxBuf->len) {
-			//判斷數據是不是命令
-			if (pCurrentRxBuf->data[0] == 'c') {
-				xQueueSendFromISR(xCmdQueue, &pCurrentRxBuf->data, &xHigherPriorityTaskWoken);
-				// Reuse buffer for commands
-				memset(pCurrentRxBuf->data, 0, UART_RX_BUFFER_SIZE);
-				HAL_UART_Receive_DMA(&ESP32_USART_PORT, (uint8_t*)pCurrentRxBuf->data, sizeof(pCurrentRxBuf->data));
-			} else if (isTransmittimg) {
-				xQueueSendFromISR(xFileQueue, &pCurrentRxBuf, &xHigherPriorityTaskWoken);
-				
-				// 嘗試獲取新的緩衝區
-				uartRxBuf_TypeDef *pNewBuf = NULL;
-				if (xQueueReceiveFromISR(xFreeBufferQueue, &pNewBuf, &xHigherPriorityTaskWoken) == pdTRUE) {
-					pCurrentRxBuf = pNewBuf;
-					memset(pCurrentRxBuf->data, 0, UART_RX_BUFFER_SIZE);
-					HAL_UART_Receive_DMA(&ESP32_USART_PORT, (uint8_t*)pCurrentRxBuf->data, sizeof(pCurrentRxBuf->data));
-				} else {
-					// No free buffer, pause reception (RTS will go high when hardware FIFO/DR is full)
-					uartRxPaused = true;
-				}
-			} else {
-				// Not command, not transmitting (unexpected data), reuse buffer
-				memset(pCurrentRxBuf->data, 0, UART_RX_BUFFER_SIZE);
-				HAL_UART_Receive_DMA(&ESP32_USART_PORT, (uint8_t*)pCurrentRxBuf->data, sizeof(pCurrentRxBuf->data));
-			}
-		} else {
-			// Length 0, restart reception
-			memset(pCurrentRxBuf->data, 0, UART_RX_BUFFER_SIZE);
-			HAL_UART_Receive_DMA(&ESP32_USART_PORT, (uint8_t*)pCurrentRxBuf->data, sizeof(pCurrentRxBuf->data));
-		}
-		portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+		// 解析封包並依通道分派 (見 link.c)
+		Link_RxIdleCallback();
 	}
 	HAL_UART_IRQHandler(&ESP32_USART_PORT); // 讓 HAL 處理其他 UART 相關的中斷
+	TRACE_ISR_EXIT(TRACE_IRQ_USART2);
 }
 
 /**
@@ -277,6 +258,7 @@ void USART2_IRQHandler(void) {
 void USART3_IRQHandler(void) {
 	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 	
+	TRACE_ISR_ENTER(TRACE_IRQ_USART3);
 	// 處理空閒中斷 - 用於接收印表機回應
 	if (__HAL_UART_GET_FLAG(&huart3, UART_FLAG_IDLE)) {
 		__HAL_UART_CLEAR_IDLEFLAG(&huart3);
@@ -306,6 +288,7 @@ void USART3_IRQHandler(void) {
 		portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 	}
 	HAL_UART_IRQHandler(&huart3);
+	TRACE_ISR_EXIT(TRACE_IRQ_USART3);
 }
 
 /* USER CODE BEGIN 1 */
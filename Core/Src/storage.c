@@ -0,0 +1,192 @@
+/**
+ * @file    storage.c
+ * @brief   SD 卡剩餘空間統計，說明見 storage.h
+ */
+
+#include "storage.h"
+#include <stdio.h>
+#include <string.h>
+#include "cmsis_os2.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "diskio.h"
+#include "Fatfs_SDIO.h"
+#include "link.h"
+
+#define LOG_MODULE STORAGE
+#include "logger.h"
+
+#define STORAGE_SECTOR_SIZE      512U
+
+static volatile bool scanning = false;
+static volatile bool scanDone = false;
+static DWORD scanPos = 0;          // 已掃描的 FAT 項目數 (叢集編號上限)
+static int32_t scanDelta = 0;      // 掃描期間已掃過區域的空閒叢集變化
+static uint32_t scanMs = 0;
+
+static osThreadId_t storageTaskHandle = NULL;
+static const osThreadAttr_t storageTask_attributes = {
+	.name = "Storage_Task",
+	.stack_size = configMINIMAL_STACK_SIZE * 8,
+	.priority = (osPriority_t) osPriorityLow,
+};
+
+/**
+ * @brief (FatFs 內，已持有卷冊鎖) 叢集被配置或釋放
+ * @note  掃描完成後 FatFs 自行維護 free_clust，此處只處理掃描期間的變化：
+ *        尚未掃描的區域稍後會被掃到，已掃過的區域則記錄差量
+ */
+void ff_free_changed(FATFS *fsp, DWORD clst, int delta) {
+	if (scanning && fsp == &fs && clst < scanPos) {
+		scanDelta += delta;
+	}
+}
+
+/**
+ * @brief 計算一批 FAT 磁區內的空閒項目，只計入 [first, last) 範圍
+ */
+static DWORD count_free(const BYTE *buf, DWORD firstEnt, DWORD first, DWORD last, BYTE fsType) {
+	DWORD n = 0;
+
+	for (DWORD e = first; e < last; e++) {
+		DWORD i = e - firstEnt;
+		if (fsType == FS_FAT16) {
+			if ((buf[i * 2] | buf[i * 2 + 1]) == 0) n++;
+		} else {
+			if (((buf[i * 4] | buf[i * 4 + 1] | buf[i * 4 + 2]) == 0) && (buf[i * 4 + 3] & 0x0F) == 0) n++;
+		}
+	}
+	return n;
+}
+
+static bool scan_fat(void) {
+	UINT batch = STORAGE_SCAN_BATCH;
+	BYTE *buf = pvPortMalloc(batch * STORAGE_SECTOR_SIZE);
+	DWORD entPerSect = STORAGE_SECTOR_SIZE / ((fs.fs_type == FS_FAT16) ? 2 : 4);
+	DWORD fatSects = (fs.n_fatent + entPerSect - 1) / entPerSect;
+	DWORD freeCnt = 0;
+	bool ok = true;
+
+	if (buf == NULL) {
+		batch = 1;
+		buf = pvPortMalloc(STORAGE_SECTOR_SIZE);
+		if (buf == NULL) {
+			return false;
+		}
+	}
+
+	scanPos = 0;
+	scanDelta = 0;
+	scanning = true;
+	DWORD s = 0;
+	while (s < fatSects && ok) {
+		UINT k = (fatSects - s < batch) ? (UINT) (fatSects - s) : batch;
+		DWORD firstEnt = s * entPerSect;
+		DWORD endEnt = firstEnt + k * entPerSect;
+
+		if (endEnt > fs.n_fatent) {
+			endEnt = fs.n_fatent;
+		}
+		if (!ff_req_grant(fs.sobj)) {
+			vTaskDelay(pdMS_TO_TICKS(10)); // 卷冊忙碌，稍後重試同一批
+			continue;
+		}
+		ok = disk_read(fs.drv, buf, fs.fatbase + s, k) == RES_OK;
+		if (ok) {
+			// win 內可能有尚未寫回的 FAT 磁區，以 win 為準
+			if (fs.winsect >= fs.fatbase + s && fs.winsect < fs.fatbase + s + k) {
+				memcpy(buf + (fs.winsect - fs.fatbase - s) * STORAGE_SECTOR_SIZE, fs.win.d8, STORAGE_SECTOR_SIZE);
+			}
+			freeCnt += count_free(buf, firstEnt, (firstEnt < 2) ? 2 : firstEnt, endEnt, fs.fs_type);
+			scanPos = endEnt;
+		}
+		if (ok && scanPos >= fs.n_fatent) {
+			// 最後一批：在同一次持有鎖內交給 FatFs，之後由 FatFs 增減
+			fs.free_clust = (DWORD) ((int32_t) freeCnt + scanDelta);
+			fs.fsi_flag |= 1;
+			scanning = false;
+		}
+		ff_rel_grant(fs.sobj);
+		s += k;
+		vTaskDelay(1); // 讓出 SD 卡給其他任務
+	}
+	scanning = false;
+	vPortFree(buf);
+	return ok;
+}
+
+static void Storage_Task(void *argument) {
+	TickType_t start = xTaskGetTickCount();
+
+	if (fs.fs_type == 0) {
+		LOG_W("volume not mounted\r\n");
+	} else if (fs.fs_type == FS_FAT12 || fs.free_clust <= fs.n_fatent - 2) {
+		// FAT12 或已有可信的計數，直接交給 f_getfree
+		DWORD n;
+		FATFS *pfs;
+		scanDone = f_getfree(SDPath, &n, &pfs) == FR_OK;
+	} else {
+		scanDone = scan_fat();
+		if (!scanDone) {
+			LOG_E("FAT scan failed\r\n");
+		}
+	}
+	scanMs = (xTaskGetTickCount() - start) * portTICK_PERIOD_MS;
+	if (scanDone) {
+		LOG_I("free clusters: %lu / %lu, scan %lums\r\n", (unsigned long) fs.free_clust,
+		      (unsigned long) (fs.n_fatent - 2), (unsigned long) scanMs);
+	}
+	storageTaskHandle = NULL;
+	vTaskDelete(NULL);
+}
+
+void Storage_Init(void) {
+	if (storageTaskHandle != NULL) {
+		return;
+	}
+	storageTaskHandle = osThreadNew(Storage_Task, NULL, &storageTask_attributes);
+	if (storageTaskHandle == NULL) {
+		LOG_E("Storage task create failed!\r\n");
+	}
+}
+
+void Storage_GetInfo(StorageInfo_TypeDef *info) {
+	DWORD freeClust = fs.free_clust;
+	uint32_t clusterKB = fs.csize / 2U; // 每磁區 512 bytes
+
+	memset(info, 0, sizeof(*info));
+	if (fs.fs_type == 0) {
+		return;
+	}
+	info->clusterKB = clusterKB;
+	info->totalKB = (fs.n_fatent - 2) * clusterKB;
+	info->scanMs = scanMs;
+	info->ready = scanDone && freeClust <= fs.n_fatent - 2;
+	if (info->ready) {
+		info->freeKB = freeClust * clusterKB;
+	}
+}
+
+StorageFit_TypeDef Storage_CheckFits(uint32_t bytes) {
+	DWORD freeClust = fs.free_clust;
+	DWORD clusterBytes = (DWORD) fs.csize * STORAGE_SECTOR_SIZE;
+	DWORD need;
+
+	if (fs.fs_type == 0 || !scanDone || freeClust > fs.n_fatent - 2 || clusterBytes == 0) {
+		return STORAGE_UNKNOWN;
+	}
+	need = bytes / clusterBytes + ((bytes % clusterBytes) ? 1 : 0) + STORAGE_RESERVE_CLUSTERS;
+	return (need <= freeClust) ? STORAGE_FITS : STORAGE_NO_SPACE;
+}
+
+void GetStorageHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
+	StorageInfo_TypeDef info;
+	char buf[100];
+
+	Storage_GetInfo(&info);
+	int n = snprintf(buf, sizeof(buf), "Storage:ready=%d,totalKB=%lu,freeKB=%lu,clusterKB=%lu,scanMs=%lu\n",
+	                 info.ready, (unsigned long) info.totalKB, (unsigned long) info.freeKB,
+	                 (unsigned long) info.clusterKB, (unsigned long) info.scanMs);
+	LOG_D("%s", buf);
+	Link_Send(LINK_CH_RSP, buf, (uint16_t) n);
+}
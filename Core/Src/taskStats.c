@@ -0,0 +1,171 @@
+/**
+ * @file    taskStats.c
+ * @brief   各任務執行期統計，說明見 taskStats.h
+ */
+
+#include "taskStats.h"
+#include <stdio.h>
+#include <string.h>
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "link.h"
+
+#define LOG_MODULE RTOS
+#include "logger.h"
+
+#define TASKSTATS_STATUS_LEN     (TASKSTATS_MAX_TASKS + 4)  // 多留幾個位置給未配置槽位的任務
+
+/* 一次取樣：各槽位的擁有者 (uxTCBNumber) 與累計值 */
+typedef struct {
+	uint32_t total;                          // 取樣時的週期計數
+	uint32_t owner[TASKSTATS_MAX_TASKS];     // 0 表示槽位未使用
+	uint32_t run[TASKSTATS_MAX_TASKS];
+	uint32_t switches[TASKSTATS_MAX_TASKS];
+} TaskStatsSample_TypeDef;
+
+static volatile uint32_t slotSwitches[TASKSTATS_MAX_TASKS];
+static uint32_t slotMask;                    // 已配置的槽位
+
+static TaskStatsSample_TypeDef hist[TASKSTATS_WINDOW + 1];
+static uint8_t histHead;                     // 下一筆取樣寫入的位置
+static uint8_t histCount;
+static TaskStatus_t status[TASKSTATS_STATUS_LEN];
+
+static TaskStats_TypeDef result;
+
+void TaskStats_TimerInit(void) {
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+uint32_t TaskStats_TaskCreate(void) {
+	for (uint32_t slot = 1; slot < TASKSTATS_MAX_TASKS; slot++) {
+		if ((slotMask & (1UL << slot)) == 0) {
+			slotMask |= 1UL << slot;
+			slotSwitches[slot] = 0;
+			return slot;
+		}
+	}
+	return 0;
+}
+
+void TaskStats_TaskDelete(uint32_t slot) {
+	if (slot != 0 && slot < TASKSTATS_MAX_TASKS) {
+		slotMask &= ~(1UL << slot);
+	}
+}
+
+void TaskStats_TaskSwitchedIn(uint32_t slot) {
+	slotSwitches[slot]++; // 槽位 0 為未配置的任務共用，不回報
+}
+
+static char state_char(eTaskState state) {
+	switch (state) {
+		case eRunning:   return 'R';
+		case eReady:     return 'r';
+		case eBlocked:   return 'B';
+		case eSuspended: return 'S';
+		default:         return 'D';
+	}
+}
+
+void TaskStats_Sample(void) {
+	TaskStatsSample_TypeDef *cur = &hist[histHead];
+	const TaskStatsSample_TypeDef *base;
+	uint32_t total;
+	UBaseType_t n;
+	static TaskStats_TypeDef next; // 只由預設任務呼叫，不佔用其堆疊
+
+	n = uxTaskGetSystemState(status, TASKSTATS_STATUS_LEN, &total);
+	if (n == 0) {
+		LOG_W("more than %u tasks, stats skipped\r\n", (unsigned int) TASKSTATS_STATUS_LEN);
+		return;
+	}
+
+	memset(cur, 0, sizeof(*cur));
+	cur->total = total;
+	for (UBaseType_t i = 0; i < n; i++) {
+		uint32_t slot = TASKNUM_STATS_SLOT(uxTaskGetTaskNumber(status[i].xHandle));
+		if (slot != 0 && slot < TASKSTATS_MAX_TASKS) {
+			cur->owner[slot] = status[i].xTaskNumber;
+			cur->run[slot] = status[i].ulRunTimeCounter;
+			cur->switches[slot] = slotSwitches[slot];
+		}
+	}
+
+	// 視窗起點為 TASKSTATS_WINDOW 次之前的取樣；開機初期以最舊的現有取樣為準
+	base = &hist[(histHead + TASKSTATS_WINDOW + 1 - histCount) % (TASKSTATS_WINDOW + 1)];
+	histHead = (uint8_t) ((histHead + 1) % (TASKSTATS_WINDOW + 1));
+	if (histCount < TASKSTATS_WINDOW) {
+		histCount++;
+	}
+
+	uint32_t span = total - base->total;
+	memset(&next, 0, sizeof(next));
+	next.windowMs = span / (SystemCoreClock / 1000U);
+	for (UBaseType_t i = 0; i < n; i++) {
+		uint32_t slot = TASKNUM_STATS_SLOT(uxTaskGetTaskNumber(status[i].xHandle));
+		TaskStatsEntry_TypeDef *e;
+		uint32_t run;
+		uint32_t sw;
+
+		if (slot == 0 || slot >= TASKSTATS_MAX_TASKS) {
+			continue;
+		}
+		// 視窗內才建立 (或槽位被重新配置) 的任務從 0 起算
+		if (base->owner[slot] == cur->owner[slot]) {
+			run = cur->run[slot] - base->run[slot];
+			sw = cur->switches[slot] - base->switches[slot];
+		} else {
+			run = cur->run[slot];
+			sw = cur->switches[slot];
+		}
+
+		// 依 CPU 使用率插入排序
+		uint16_t permille = (span > 0) ? (uint16_t) (((uint64_t) run * 1000U) / span) : 0;
+		uint8_t pos = next.count;
+		while (pos > 0 && next.task[pos - 1].cpuPermille < permille) {
+			next.task[pos] = next.task[pos - 1];
+			pos--;
+		}
+		e = &next.task[pos];
+		strncpy(e->name, status[i].pcTaskName, TASKSTATS_NAME_LEN - 1);
+		e->name[TASKSTATS_NAME_LEN - 1] = '\0';
+		e->cpuPermille = permille;
+		e->stackFree = (uint16_t) (status[i].usStackHighWaterMark * sizeof(StackType_t));
+		e->switches = sw;
+		e->priority = (uint8_t) status[i].uxCurrentPriority;
+		e->state = state_char(status[i].eCurrentState);
+		next.switches += sw;
+		next.count++;
+	}
+
+	taskENTER_CRITICAL();
+	result = next;
+	taskEXIT_CRITICAL();
+}
+
+void TaskStats_Get(TaskStats_TypeDef *out) {
+	taskENTER_CRITICAL();
+	*out = result;
+	taskEXIT_CRITICAL();
+}
+
+void GetTaskStatsHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
+	static TaskStats_TypeDef stats;
+	char buf[64];
+	int n;
+
+	TaskStats_Get(&stats);
+	// 摘要：視窗長度 (ms)、任務數、總切換次數；之後每行為 名稱,CPU 千分比,堆疊剩餘,切換次數,優先權,狀態
+	n = snprintf(buf, sizeof(buf), "TaskStats:window=%lu,tasks=%u,switches=%lu\n",
+	             (unsigned long) stats.windowMs, stats.count, (unsigned long) stats.switches);
+	Link_Send(LINK_CH_RSP, buf, (uint16_t) n);
+	for (uint8_t i = 0; i < stats.count; i++) {
+		const TaskStatsEntry_TypeDef *e = &stats.task[i];
+		n = snprintf(buf, sizeof(buf), "Task:%s,%u,%u,%lu,%u,%c\n", e->name, e->cpuPermille, e->stackFree,
+		             (unsigned long) e->switches, e->priority, e->state);
+		Link_Send(LINK_CH_RSP, buf, (uint16_t) n);
+	}
+}
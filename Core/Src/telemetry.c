@@ -0,0 +1,223 @@
+/**
+ * @file    telemetry.c
+ * @brief   主動推送遙測資料給 ESP32，封包格式見 telemetry.h
+ */
+
+#include "telemetry.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include "cmsis_os2.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "esp32.h"
+#include "link.h"
+#include "printerController.h"
+
+#define LOG_MODULE TELEMETRY
+#include "logger.h"
+
+#define TELEM_PAYLOAD_MAX        (3 + sizeof(PC_StatusRecord_TypeDef))
+
+typedef struct {
+	uint8_t offset; // 在 PC_StatusRecord_TypeDef 中的位置
+	uint8_t size;
+} TelemetryFieldDesc_TypeDef;
+
+#define TELEM_FIELD(member, width) {offsetof(PC_StatusRecord_TypeDef, member), width}
+
+static const TelemetryFieldDesc_TypeDef fieldDesc[TELEM_FIELD_COUNT] = {
+	[TELEM_FIELD_PC_STATE]        = TELEM_FIELD(pcState, 1),
+	[TELEM_FIELD_ESP_STATE]       = TELEM_FIELD(espState, 1),
+	[TELEM_FIELD_FLAGS]           = TELEM_FIELD(flags, 1),
+	[TELEM_FIELD_NOZZLE_TEMP]     = TELEM_FIELD(nozzleTemp, 1),
+	[TELEM_FIELD_BED_TEMP]        = TELEM_FIELD(bedTemp, 1),
+	[TELEM_FIELD_PROGRESS]        = TELEM_FIELD(progress, 1),
+	[TELEM_FIELD_FILAMENT_WEIGHT] = TELEM_FIELD(filamentWeight, 2),
+	[TELEM_FIELD_REMAINING_TIME]  = TELEM_FIELD(remainHours, 3),
+	[TELEM_FIELD_UPLOAD_BYTES]    = TELEM_FIELD(uploadBytes, 4),
+};
+
+_Static_assert(TELEM_FIELD_COUNT <= 16, "telemetry mask is 16 bits");
+_Static_assert(TELEM_PAYLOAD_MAX <= LINK_MAX_TX_PAYLOAD, "telemetry frame exceeds link payload");
+
+static TelemetryConfig_TypeDef telemCfg = {
+	.enabled = true,
+	.heartbeatMs = TELEM_HEARTBEAT_MS,
+	.tempDelta = TELEM_TEMP_DELTA,
+	.weightDelta = TELEM_WEIGHT_DELTA,
+};
+
+static volatile bool keyframeRequested = true;
+
+static StaticTask_t telemTaskCb;
+static uint32_t telemTaskStack[configMINIMAL_STACK_SIZE * 2];
+static osThreadId_t telemTaskHandle = NULL;
+static const osThreadAttr_t telemTask_attributes = {
+	.name = "Telemetry_Task",
+	.cb_mem = &telemTaskCb,
+	.cb_size = sizeof(telemTaskCb),
+	.stack_mem = telemTaskStack,
+	.stack_size = sizeof(telemTaskStack),
+	.priority = (osPriority_t) osPriorityBelowNormal,
+};
+
+static uint32_t field_value(const PC_StatusRecord_TypeDef *record, TelemetryField_TypeDef field) {
+	const uint8_t *p = (const uint8_t *) record + fieldDesc[field].offset;
+	uint32_t value = 0;
+
+	for (uint8_t i = 0; i < fieldDesc[field].size; i++) {
+		value |= (uint32_t) p[i] << (8 * i);
+	}
+	return value;
+}
+
+static uint32_t field_threshold(TelemetryField_TypeDef field) {
+	switch (field) {
+		case TELEM_FIELD_NOZZLE_TEMP:
+		case TELEM_FIELD_BED_TEMP:
+			return telemCfg.tempDelta;
+		case TELEM_FIELD_FILAMENT_WEIGHT:
+			return telemCfg.weightDelta;
+		case TELEM_FIELD_UPLOAD_BYTES:
+			return TELEM_UPLOAD_DELTA;
+		default:
+			return 1; // 狀態類欄位任何變化都送出
+	}
+}
+
+/**
+ * @brief 比較目前與上次送出的快照，回傳超過門檻的欄位
+ */
+static uint16_t diff_mask(const PC_StatusRecord_TypeDef *cur, const PC_StatusRecord_TypeDef *sent) {
+	uint16_t mask = 0;
+
+	for (uint8_t f = 0; f < TELEM_FIELD_COUNT; f++) {
+		uint32_t a = field_value(cur, (TelemetryField_TypeDef) f);
+		uint32_t b = field_value(sent, (TelemetryField_TypeDef) f);
+		uint32_t delta = a > b ? a - b : b - a;
+		uint32_t threshold = field_threshold((TelemetryField_TypeDef) f);
+
+		// 門檻為 0 時視為 1，避免未變化的欄位被送出
+		if (delta != 0 && delta >= (threshold ? threshold : 1)) {
+			mask |= (uint16_t) (1U << f);
+		}
+	}
+
+	// 上傳結束時補送最後的位元組數，不受門檻限制
+	if ((cur->flags ^ sent->flags) & PC_STATUS_FLAG_UPLOADING) {
+		mask |= (uint16_t) (1U << TELEM_FIELD_UPLOAD_BYTES);
+	}
+	return mask;
+}
+
+static uint16_t encode_frame(uint8_t *out, uint8_t seq, uint16_t mask, const PC_StatusRecord_TypeDef *cur) {
+	uint16_t len = 0;
+
+	out[len++] = seq;
+	out[len++] = (uint8_t) mask;
+	out[len++] = (uint8_t) (mask >> 8);
+	for (uint8_t f = 0; f < TELEM_FIELD_COUNT; f++) {
+		if (mask & (1U << f)) {
+			memcpy(out + len, (const uint8_t *) cur + fieldDesc[f].offset, fieldDesc[f].size);
+			len += fieldDesc[f].size;
+		}
+	}
+	return len;
+}
+
+/**
+ * @brief 遙測任務：取樣、比較、送出差量
+ */
+static void Telemetry_Task(void *argument) {
+	PC_StatusRecord_TypeDef cur;
+	PC_StatusRecord_TypeDef sent;
+	uint8_t frame[TELEM_PAYLOAD_MAX];
+	uint8_t seq = 0;
+	TickType_t lastWake = xTaskGetTickCount();
+	TickType_t lastSent = lastWake;
+
+	memset(&sent, 0, sizeof(sent));
+
+	for (;;) {
+		vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(TELEM_SAMPLE_PERIOD_MS));
+
+		// WiFi 尚未連線時 ESP32 無處轉送，連線後從完整封包開始
+		if (!telemCfg.enabled || ESP32_GetState() == ESP32_INIT) {
+			keyframeRequested = true;
+			continue;
+		}
+
+		PC_GetStatusRecord(&cur);
+
+		uint16_t mask;
+		if (keyframeRequested || (xTaskGetTickCount() - lastSent) >= pdMS_TO_TICKS(telemCfg.heartbeatMs)) {
+			mask = TELEM_MASK_ALL;
+		} else {
+			mask = diff_mask(&cur, &sent);
+		}
+		if (mask == 0) {
+			continue;
+		}
+
+		uint16_t len = encode_frame(frame, seq, mask, &cur);
+		if (Link_Send(LINK_CH_TELEM, frame, len) != HAL_OK) {
+			continue; // 下個週期重新比較，變化不會遺失
+		}
+
+		// 只更新已送出的欄位，未達門檻的緩慢變化會持續累積
+		for (uint8_t f = 0; f < TELEM_FIELD_COUNT; f++) {
+			if (mask & (1U << f)) {
+				memcpy((uint8_t *) &sent + fieldDesc[f].offset,
+				       (const uint8_t *) &cur + fieldDesc[f].offset,
+				       fieldDesc[f].size);
+			}
+		}
+		seq++;
+		lastSent = xTaskGetTickCount();
+		keyframeRequested = false;
+	}
+}
+
+void Telemetry_Init(void) {
+	telemTaskHandle = osThreadNew(Telemetry_Task, NULL, &telemTask_attributes);
+	if (telemTaskHandle == NULL) {
+		LOG_E("Telemetry task create failed!\r\n");
+	}
+}
+
+void Telemetry_RequestKeyframe(void) {
+	keyframeRequested = true;
+}
+
+void SetTelemetryHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
+	char param[32] = {0};
+	unsigned long values[4];
+	uint8_t count = 0;
+
+	if (!extract_parameter(args, len, param, sizeof(param))) {
+		LOG_W("Invalid telemetry parameter\r\n");
+		return;
+	}
+
+	char *p = param;
+	while (count < 4 && *p != '\0') {
+		char *end;
+		values[count] = strtoul(p, &end, 10);
+		if (end == p) {
+			break;
+		}
+		count++;
+		p = (*end == ',') ? end + 1 : end;
+	}
+
+	if (count > 0) telemCfg.enabled = values[0] != 0;
+	if (count > 1 && values[1] >= TELEM_SAMPLE_PERIOD_MS && values[1] <= UINT16_MAX) telemCfg.heartbeatMs = (uint16_t) values[1];
+	if (count > 2 && values[2] <= UINT8_MAX) telemCfg.tempDelta = (uint8_t) values[2];
+	if (count > 3 && values[3] <= UINT8_MAX) telemCfg.weightDelta = (uint8_t) values[3];
+
+	keyframeRequested = true;
+	LOG_I("enabled:%d heartbeat:%ums temp:%u weight:%u\r\n", telemCfg.enabled, telemCfg.heartbeatMs,
+	      telemCfg.tempDelta, telemCfg.weightDelta);
+}
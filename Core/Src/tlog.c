@@ -0,0 +1,107 @@
+/**
+ * @file    tlog.c
+ * @brief   Token 化二進位日誌，說明見 tlog.h
+ */
+
+#include "tlog.h"
+#include <string.h>
+#include "main.h"
+#include "usart.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/**
+ * @brief 參數區剩餘空間不足 n 位元組時標記截斷
+ */
+static uint8_t *frame_reserve(TLogFrame_TypeDef *f, uint8_t n) {
+	uint8_t *p;
+
+	if (f->truncated || f->len + n > sizeof(f->buf)) {
+		f->truncated = 1;
+		return NULL;
+	}
+	p = f->buf + f->len;
+	f->len += n;
+	return p;
+}
+
+static void put_le32(uint8_t *p, uint32_t v) {
+	p[0] = (uint8_t) v;
+	p[1] = (uint8_t) (v >> 8);
+	p[2] = (uint8_t) (v >> 16);
+	p[3] = (uint8_t) (v >> 24);
+}
+
+void TLog_Begin(TLogFrame_TypeDef *f, uint16_t id) {
+	f->buf[0] = TLOG_SYNC;
+	f->buf[1] = (uint8_t) id;
+	f->buf[2] = (uint8_t) (id >> 8);
+	put_le32(&f->buf[3], HAL_GetTick());
+	f->len = TLOG_HDR_SIZE;
+	f->truncated = 0;
+}
+
+void TLog_PutU32(TLogFrame_TypeDef *f, uint32_t v) {
+	uint8_t *p = frame_reserve(f, 5);
+
+	if (p != NULL) {
+		p[0] = TLOG_TAG_U32;
+		put_le32(p + 1, v);
+	}
+}
+
+void TLog_PutU64(TLogFrame_TypeDef *f, uint64_t v) {
+	uint8_t *p = frame_reserve(f, 9);
+
+	if (p != NULL) {
+		p[0] = TLOG_TAG_U64;
+		put_le32(p + 1, (uint32_t) v);
+		put_le32(p + 5, (uint32_t) (v >> 32));
+	}
+}
+
+void TLog_PutF32(TLogFrame_TypeDef *f, double v) {
+	uint8_t *p = frame_reserve(f, 5);
+	float fv = (float) v;
+	uint32_t bits;
+
+	if (p != NULL) {
+		memcpy(&bits, &fv, sizeof(bits));
+		p[0] = TLOG_TAG_F32;
+		put_le32(p + 1, bits);
+	}
+}
+
+void TLog_PutStr(TLogFrame_TypeDef *f, const char *s) {
+	size_t n = (s != NULL) ? strnlen(s, TLOG_STR_MAX) : 0;
+	uint8_t *p = frame_reserve(f, (uint8_t) (2 + n));
+
+	if (p != NULL) {
+		p[0] = TLOG_TAG_STR;
+		p[1] = (uint8_t) n;
+		if (n > 0) {
+			memcpy(p + 2, s, n);
+		}
+	}
+}
+
+void TLog_PutPtr(TLogFrame_TypeDef *f, const void *ptr) {
+	uint8_t *p = frame_reserve(f, 5);
+
+	if (p != NULL) {
+		p[0] = TLOG_TAG_PTR;
+		put_le32(p + 1, (uint32_t) (uintptr_t) ptr);
+	}
+}
+
+void TLog_End(TLogFrame_TypeDef *f) {
+	uint8_t len = (uint8_t) (f->len - TLOG_HDR_SIZE);
+
+	f->buf[TLOG_HDR_SIZE - 1] = len | (f->truncated ? TLOG_LEN_TRUNCATED : 0);
+	if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) {
+		UartTxPart_TypeDef part = {f->buf, f->len};
+		UART_SendParts_DMA(&DEBUG_USART_PORT, &part, 1);
+	} else {
+		HAL_UART_Transmit(&DEBUG_USART_PORT, f->buf, f->len, HAL_MAX_DELAY);
+	}
+}
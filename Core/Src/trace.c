@@ -0,0 +1,213 @@
+/**
+ * @file    trace.c
+ * @brief   事件追蹤記錄器，說明見 trace.h
+ */
+
+#include "trace.h"
+#include <stdio.h>
+#include <string.h>
+#include "main.h"
+#include "cmsis_os2.h"
+#include "usart.h"
+#include "link.h"
+
+#define LOG_MODULE RTOS
+#include "logger.h"
+
+#if TRACE_ENABLE
+
+#define TRACE_DUMP_RETRY_MS      2      // 除錯 UART 緩衝區滿時的等待間隔
+
+typedef struct {
+	uint32_t cycles;
+	uint8_t type;
+	uint8_t id;
+	uint16_t arg;
+} TraceEntry_TypeDef;
+
+static TraceEntry_TypeDef ring[TRACE_RING_SIZE];
+static volatile uint32_t head;           // 累計寫入數，ring[head % SIZE] 為下一筆
+static volatile bool running;
+static uint8_t lastTask;                 // 最近切入的任務，重複切入同一任務不記錄
+
+static char taskName[TRACE_MAX_TASKS][TRACE_TASK_NAME_LEN];
+static uint32_t taskMask;                // 已配置的任務編號，0 保留給沒有空位的任務
+static uint8_t taskLast;                 // 最近配置的編號，下一次從其後開始找
+static uint8_t objectType[TRACE_MAX_OBJECTS];
+static const char *objectName[TRACE_MAX_OBJECTS];
+static uint8_t objectCount;              // 已配置的物件編號，0 保留為「不追蹤」
+
+#define TRACE_IRQ_NAME_(id, name)  name,
+static const char *const irqName[TRACE_IRQ_COUNT] = {
+	TRACE_IRQ_TABLE(TRACE_IRQ_NAME_)
+};
+#undef TRACE_IRQ_NAME_
+
+#define TRACE_SPAN_NAME_(id, name) name,
+static const char *const spanName[TRACE_SPAN_COUNT] = {
+	TRACE_SPAN_TABLE(TRACE_SPAN_NAME_)
+};
+#undef TRACE_SPAN_NAME_
+
+void Trace_Init(void) {
+	// 啟用 DWT 週期計數器 (Estop_Init 也會啟用，兩者都不重設計數值)
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	running = true;
+}
+
+void Trace_Record(uint8_t type, uint8_t id, uint16_t arg) {
+	uint32_t primask;
+	TraceEntry_TypeDef *e;
+
+	if (!running) {
+		return;
+	}
+	// 關中斷時間只有幾個指令；也會在 PendSV 與 BASEPRI 遮蔽的臨界區內被呼叫
+	primask = __get_PRIMASK();
+	__disable_irq();
+	e = &ring[head & (TRACE_RING_SIZE - 1U)];
+	head++;
+	e->cycles = DWT->CYCCNT;
+	e->type = type;
+	e->id = id;
+	e->arg = arg;
+	__set_PRIMASK(primask);
+}
+
+void Trace_TaskSwitchedIn(uint32_t number) {
+	if ((uint8_t) number != lastTask) {
+		lastTask = (uint8_t) number;
+		Trace_Record(TRACE_EV_TASK_IN, (uint8_t) number, 0);
+	}
+}
+
+uint8_t Trace_TaskCreate(const char *name) {
+	// 於核心臨界區內呼叫；輪流配置，剛釋放的編號不會立刻被下一個任務使用
+	for (uint8_t i = 0; i < TRACE_MAX_TASKS - 1; i++) {
+		uint8_t id = (uint8_t) (1U + (taskLast + i) % (TRACE_MAX_TASKS - 1U));
+		if ((taskMask & (1UL << id)) == 0) {
+			taskMask |= 1UL << id;
+			taskLast = id;
+			strncpy(taskName[id], name, TRACE_TASK_NAME_LEN - 1);
+			return id;
+		}
+	}
+	return 0;
+}
+
+void Trace_TaskDelete(uint32_t number) {
+	if (number != 0 && number < TRACE_MAX_TASKS) {
+		taskMask &= ~(1UL << number);
+	}
+}
+
+uint8_t Trace_ObjectCreate(uint8_t queueType) {
+	uint8_t number;
+
+	// hook 在核心臨界區外呼叫，可能有多個任務同時建立物件
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	if (objectCount + 1 >= TRACE_MAX_OBJECTS) {
+		__set_PRIMASK(primask);
+		return 0;
+	}
+	number = ++objectCount;
+	__set_PRIMASK(primask);
+	objectType[number] = queueType;
+	return number;
+}
+
+void Trace_ObjectName(uint32_t number, const char *name) {
+	if (number != 0 && number < TRACE_MAX_OBJECTS) {
+		objectName[number] = name;
+	}
+}
+
+/**
+ * @brief 以一次寫入送出一行到除錯 UART，緩衝區滿時等待後重試
+ */
+static void dump_line(const char *line, int n) {
+	UartTxPart_TypeDef part = {(const uint8_t *) line, (size_t) n};
+
+	while (UART_SendParts_DMA(&DEBUG_USART_PORT, &part, 1) == HAL_BUSY) {
+		osDelay(TRACE_DUMP_RETRY_MS);
+	}
+}
+
+/**
+ * @brief 輸出全部事件，格式見 tools/trace2perfetto.py
+ */
+static void dump(void) {
+	char line[48];
+	uint32_t end = head;
+	uint32_t start = (end > TRACE_RING_SIZE) ? end - TRACE_RING_SIZE : 0;
+	int n;
+
+	n = snprintf(line, sizeof(line), "TRC H %lu %lu %lu\n",
+	             (unsigned long) SystemCoreClock, (unsigned long) (end - start), (unsigned long) start);
+	dump_line(line, n);
+	for (int i = 1; i < TRACE_MAX_TASKS; i++) {
+		if (taskName[i][0] != '\0') {
+			n = snprintf(line, sizeof(line), "TRC T %d %s\n", i, taskName[i]);
+			dump_line(line, n);
+		}
+	}
+	for (int i = 1; i <= objectCount; i++) {
+		n = snprintf(line, sizeof(line), "TRC O %d %u %s\n", i, objectType[i],
+		             (objectName[i] != NULL) ? objectName[i] : "");
+		dump_line(line, n);
+	}
+	for (int i = 0; i < TRACE_IRQ_COUNT; i++) {
+		n = snprintf(line, sizeof(line), "TRC I %d %s\n", i, irqName[i]);
+		dump_line(line, n);
+	}
+	for (int i = 0; i < TRACE_SPAN_COUNT; i++) {
+		n = snprintf(line, sizeof(line), "TRC S %d %s\n", i, spanName[i]);
+		dump_line(line, n);
+	}
+	for (uint32_t i = start; i != end; i++) {
+		const TraceEntry_TypeDef *e = &ring[i & (TRACE_RING_SIZE - 1U)];
+		n = snprintf(line, sizeof(line), "TRC E %08lx %02x %02x %04x\n",
+		             (unsigned long) e->cycles, e->type, e->id, e->arg);
+		dump_line(line, n);
+	}
+	dump_line("TRC Z\n", 6);
+}
+
+void TraceHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
+	char param[8] = {0};
+	char buf[64];
+	int n;
+
+	if (extract_parameter(args, len, param, sizeof(param))) {
+		if (strcmp(param, "start") == 0) {
+			running = false;
+			head = 0;
+			lastTask = 0;
+			running = true;
+		} else if (strcmp(param, "stop") == 0) {
+			running = false;
+		} else if (strcmp(param, "dump") == 0) {
+			running = false;
+			LOG_I("trace dump, %lu events\r\n", (unsigned long) head);
+			dump();
+		} else {
+			Link_SendString(LINK_CH_RSP, "Trace:invalid\n");
+			return;
+		}
+	}
+
+	n = snprintf(buf, sizeof(buf), "Trace:%s,events=%lu,lost=%lu\n", running ? "running" : "stopped",
+	             (unsigned long) ((head > TRACE_RING_SIZE) ? TRACE_RING_SIZE : head),
+	             (unsigned long) ((head > TRACE_RING_SIZE) ? head - TRACE_RING_SIZE : 0));
+	Link_Send(LINK_CH_RSP, buf, (uint16_t) n);
+}
+
+#else
+
+void TraceHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
+	Link_SendString(LINK_CH_RSP, "Trace:disabled\n");
+}
+
+#endif /* TRACE_ENABLE */
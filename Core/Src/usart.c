@@ -9,6 +9,7 @@
 /* USER CODE END Header */
 /* Includes ------------------------------------------------------------------*/
 #include "usart.h"
+#include "link.h"
 #include <stdio.h>
 #include <string.h>
 #include "FreeRTOS.h"
@@ -16,21 +17,72 @@
 #include "task.h" // 為了 xTaskGetSchedulerState()
 #include "portmacro.h"
 
-#define UART_TX_BUFFER_SIZE 128
+#define LOG_MODULE USART
+#include "logger.h"
+
 #define UART_COUNT 3
 
+/*
+ * 每個 UART 一個位元組環形緩衝區，多個任務與中斷可無鎖寫入：
+ *
+ *   resv   低 16 位元為保留位置 (head)，高 16 位元為正在複製資料的寫入者數。
+ *          寫入者以 CAS 一次取得空間並將寫入者數加一，複製完再減一；
+ *          減到 0 的寫入者代表 head 之前的資料都已寫好，將 commit 推進到 head。
+ *   commit 已寫好、可送出的位置，只會前進 (被搶佔的寫入者晚一點更新也不會倒退)。
+ *   tail   DMA 已送出的位置，只由 DMA 完成中斷推進。
+ *
+ * 位置皆為 16 位元自由計數，環形長度須為 2 的次方。DMA 每次送出 tail 到 commit
+ * 之間的連續資料 (繞回時分兩次)，完成中斷立即接續下一段，期間累積的所有
+ * 寫入合併為一次傳輸。空間不足時整筆丟棄並計數，呼叫端不會等待。
+ *
+ * 印表機環形緩衝區 (lineSplit) 每次 DMA 最多送到一個 '\n'，傳輸間隙必落在
+ * G-code 行邊界，UART_SendUrgent 藉此在行與行之間插隊 (緊急停止用)。
+ */
 typedef struct {
 	UART_HandleTypeDef *huart;
-	SemaphoreHandle_t mutex;
-	uint8_t txBuf[UART_TX_BUFFER_SIZE];
-} UartSync_t;
+	uint8_t *buf;
+	uint16_t size;
+	volatile uint32_t resv;
+	volatile uint16_t commit;
+	volatile uint16_t tail;
+	volatile uint32_t dmaBusy;   // 取得者負責啟動 DMA，完成中斷釋放
+	uint16_t dmaLen;             // 傳輸中的位元組數
+	bool lineSplit;              // DMA 傳輸不跨越 '\n'
+	volatile bool atLineStart;   // 最後送出的位元組為 '\n' (lineSplit 才更新)
+	volatile uint32_t hold;      // 非 0 時在行邊界暫停啟動新傳輸
+	volatile bool discard;       // 傳輸中的 DMA 完成時丟棄到 discardTo 為止的資料
+	volatile uint16_t discardTo;
+	uint16_t highWater;
+	volatile uint32_t writes;
+	volatile uint32_t dropWrites;
+	volatile uint32_t dropBytes;
+	uint32_t dmaCount;
+	uint32_t dmaErrors;
+} UartTxRing_TypeDef;
+
+#define TX_RESV_HEAD(v)          ((uint16_t) (v))
+#define TX_RESV_WRITERS(v)       ((v) >> 16)
+#define TX_RESV(writers, head)   (((uint32_t) (writers) << 16) | (uint16_t) (head))
+
+_Static_assert((UART1_TX_RING_SIZE & (UART1_TX_RING_SIZE - 1)) == 0 && UART1_TX_RING_SIZE <= 32768, "ring size");
+_Static_assert((UART2_TX_RING_SIZE & (UART2_TX_RING_SIZE - 1)) == 0 && UART2_TX_RING_SIZE <= 32768, "ring size");
+_Static_assert((UART3_TX_RING_SIZE & (UART3_TX_RING_SIZE - 1)) == 0 && UART3_TX_RING_SIZE <= 32768, "ring size");
+_Static_assert(UART2_TX_RING_SIZE >= UART_TX_BUFFER_SIZE, "link frame must fit in the ESP32 ring");
+
+static uint8_t tx1Buf[UART1_TX_RING_SIZE];
+static uint8_t tx2Buf[UART2_TX_RING_SIZE];
+static uint8_t tx3Buf[UART3_TX_RING_SIZE];
+
+static UartTxRing_TypeDef gTxRing[UART_COUNT] = {
+	{.huart = &huart1, .buf = tx1Buf, .size = UART1_TX_RING_SIZE},
+	{.huart = &huart2, .buf = tx2Buf, .size = UART2_TX_RING_SIZE},
+	{.huart = &huart3, .buf = tx3Buf, .size = UART3_TX_RING_SIZE, .lineSplit = true, .atLineStart = true},
+};
+static const char *const txRingName[UART_COUNT] = {"dbg", "esp", "prn"};
 
-static UartSync_t gUartSync[UART_COUNT];
 // uartRxBuf_TypeDef uartRxBuf;
 uartRxBuf_TypeDef rxBufPool[RX_BUFFER_POOL_SIZE];
-uartRxBuf_TypeDef *pCurrentRxBuf;
 QueueHandle_t xFreeBufferQueue;
-volatile bool uartRxPaused = false;
 
 // 核心 DMA 傳輸函式 (內部使用)
 static HAL_StatusTypeDef _UART_SendBuffer_DMA(UART_HandleTypeDef *huart, const uint8_t *data, size_t len);
@@ -48,53 +100,54 @@ DMA_HandleTypeDef hdma_usart3_rx;
 
 
 /**
- * @brief 獲取 UART 同步對象的輔助函式
+ * @brief 獲取 UART 發送環形緩衝區的輔助函式
  */
-static UartSync_t *_get_sync_handle(UART_HandleTypeDef *huart) {
+static UartTxRing_TypeDef *_get_tx_ring(const UART_HandleTypeDef *huart) {
 	if (huart->Instance == USART1) {
-		return &gUartSync[0];
+		return &gTxRing[0];
 	} else if (huart->Instance == USART2) {
-		return &gUartSync[1];
+		return &gTxRing[1];
 	} else if (huart->Instance == USART3) {
-		return &gUartSync[2];
+		return &gTxRing[2];
 	}
 	return NULL;
 }
 
+static void _tx_dma_done(DMA_HandleTypeDef *hdma);
+static void _tx_dma_error(DMA_HandleTypeDef *hdma);
 
-void Uart_Sync_Init(void) {
-	gUartSync[0].huart = &huart1;
-	gUartSync[1].huart = &huart2;
-	gUartSync[2].huart = &huart3;
-
+void Uart_Tx_Init(void) {
 	for (int i = 0; i < UART_COUNT; i++) {
-		gUartSync[i].mutex = xSemaphoreCreateBinary();
-		if (gUartSync[i].mutex == NULL) {
-			printf("%-20s UART%d Sync Init Failed!\r\n", "usart.c", i + 1);
-			// Error_Handler();
-		} else {
-			xSemaphoreGive(gUartSync[i].mutex);
-		}
+		UART_HandleTypeDef *huart = gTxRing[i].huart;
+
+		// 傳輸由環形緩衝區直接驅動 DMA 通道，不經 HAL_UART_Transmit_DMA 的狀態機；
+		// DMAT 常駐開啟 (通道關閉時請求不會被處理)，避免每次傳輸讀改寫 CR3
+		huart->hdmatx->XferCpltCallback = _tx_dma_done;
+		huart->hdmatx->XferHalfCpltCallback = NULL;
+		huart->hdmatx->XferErrorCallback = _tx_dma_error;
+		huart->hdmatx->XferAbortCallback = NULL;
+		SET_BIT(huart->Instance->CR3, USART_CR3_DMAT);
 	}
 
-	printf("%-20s uart thread safe inited.\r\n", "usart.c");
+	LOG_D("uart tx rings inited.\r\n");
 }
 
 void Uart_Rx_Pool_Init(void) {
 	xFreeBufferQueue = xQueueCreate(RX_BUFFER_POOL_SIZE, sizeof(uartRxBuf_TypeDef *));
 	if (xFreeBufferQueue == NULL) {
-		printf("%-20s FreeBufferQueue Init Failed!\r\n", "usart.c");
+		LOG_E("FreeBufferQueue Init Failed!\r\n");
 		Error_Handler();
 	}
+	vQueueAddToRegistry(xFreeBufferQueue, "uartRxPool");
 
-	// 將緩衝區加入池中 (保留第一個給初始接收使用)
-	for (int i = 1; i < RX_BUFFER_POOL_SIZE; i++) {
+	// 所有緩衝區皆放入池中，由鏈路層 (link.c) 取出第一個開始接收
+	for (int i = 0; i < RX_BUFFER_POOL_SIZE; i++) {
 		uartRxBuf_TypeDef *pBuf = &rxBufPool[i];
+		pBuf->refCnt = 0;
 		xQueueSend(xFreeBufferQueue, &pBuf, 0);
 	}
 
-	pCurrentRxBuf = &rxBufPool[0];
-	printf("%-20s Rx Pool inited.\r\n", "usart.c");
+	LOG_D("Rx Pool inited.\r\n");
 }
 
 /* USART1 init function */
@@ -362,62 +415,180 @@ void HAL_UART_MspDeInit(UART_HandleTypeDef *uartHandle) {
 	}
 }
 
+/* USER CODE BEGIN 1 */
+
 /**
-  * @brief  Tx Transfer completed callback.
-  * @note   DMA 傳輸完成後，此中斷被觸發，負責釋放 Mutex。
-  */
-void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
-	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+ * @brief 由取得 dmaBusy 的一方送出 tail 到 commit 之間的連續資料
+ * @note  任務與 DMA 完成中斷都會呼叫；釋放 dmaBusy 後再檢查一次 commit，
+ *        避免另一方在我們持有期間寫入資料卻因取不到 dmaBusy 而沒有送出。
+ */
+static void _tx_kick(UartTxRing_TypeDef *r) {
+	for (;;) {
+		uint32_t idle = 0;
+		if (!__atomic_compare_exchange_n(&r->dmaBusy, &idle, 1U, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+			return; // DMA 傳輸中，完成中斷會接續
+		}
+		if (r->hold != 0 && r->atLineStart) {
+			// UART_SendUrgent 等待行邊界，由它送完後再呼叫本函式
+			__atomic_store_n(&r->dmaBusy, 0U, __ATOMIC_SEQ_CST);
+			return;
+		}
 
-	UartSync_t *pSync = _get_sync_handle(huart);
-	if (pSync == NULL) {
+		uint16_t tail = r->tail;
+		uint16_t pending = (uint16_t) (__atomic_load_n(&r->commit, __ATOMIC_ACQUIRE) - tail);
+		if (pending != 0) {
+			uint16_t ofs = tail & (r->size - 1U);
+			uint16_t len = (pending < r->size - ofs) ? pending : (uint16_t) (r->size - ofs);
+
+			if (r->lineSplit) {
+				const uint8_t *nl = memchr(r->buf + ofs, '\n', len);
+				if (nl != NULL) {
+					len = (uint16_t) (nl - (r->buf + ofs) + 1);
+				}
+			}
+			r->dmaLen = len;
+			if (HAL_DMA_Start_IT(r->huart->hdmatx, (uint32_t) (r->buf + ofs),
+			                     (uint32_t) &r->huart->Instance->DR, len) == HAL_OK) {
+				r->dmaCount++;
+				return;
+			}
+			// 通道仍被占用：資料留在緩衝區，下一次寫入或完成中斷再送
+			r->dmaLen = 0;
+			r->dmaErrors++;
+			__atomic_store_n(&r->dmaBusy, 0U, __ATOMIC_RELEASE);
+			return;
+		}
+
+		__atomic_store_n(&r->dmaBusy, 0U, __ATOMIC_SEQ_CST);
+		if (__atomic_load_n(&r->commit, __ATOMIC_SEQ_CST) == r->tail) {
+			return;
+		}
+	}
+}
+
+static void _tx_dma_finish(DMA_HandleTypeDef *hdma, bool ok) {
+	UartTxRing_TypeDef *r = _get_tx_ring((UART_HandleTypeDef *) hdma->Parent);
+
+	if (r == NULL) {
 		return;
 	}
+	if (!ok) {
+		r->dmaErrors++; // 這段資料視為已送出，不重送
+	}
+	if (r->lineSplit && r->dmaLen != 0) {
+		r->atLineStart = (r->buf[(uint16_t) (r->tail + r->dmaLen - 1U) & (r->size - 1U)] == '\n');
+	}
+	uint16_t tail = (uint16_t) (r->tail + r->dmaLen);
+	if (r->discard) {
+		// UART_DiscardPending 當時已公開的資料不再送出，之後寫入的保留
+		if ((int16_t) (r->discardTo - tail) > 0) {
+			tail = r->discardTo;
+		}
+		r->discard = false;
+	}
+	__atomic_store_n(&r->tail, tail, __ATOMIC_RELEASE);
+	r->dmaLen = 0;
+	__atomic_store_n(&r->dmaBusy, 0U, __ATOMIC_SEQ_CST);
+	_tx_kick(r);
+}
 
-	xSemaphoreGiveFromISR(pSync->mutex, &xHigherPriorityTaskWoken);
-	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+static void _tx_dma_done(DMA_HandleTypeDef *hdma) {
+	_tx_dma_finish(hdma, true);
 }
 
-/* USER CODE BEGIN 1 */
+static void _tx_dma_error(DMA_HandleTypeDef *hdma) {
+	_tx_dma_finish(hdma, false);
+}
 
 /**
- * @brief 核心 DMA 傳輸函式 (非阻塞)
- * @note  這是唯一能存取 Mutex 和啟動 DMA 的函式。
+ * @brief 核心傳輸函式 (非阻塞、無鎖，任務與中斷皆可呼叫)
+ * @note  多段資料保留為連續空間後依序複製，確保封包在串流中不被其他寫入者打斷。
+ * @retval HAL_BUSY 緩衝區空間不足，整筆丟棄
  */
-static HAL_StatusTypeDef _UART_SendBuffer_DMA(UART_HandleTypeDef *huart, const uint8_t *data, size_t len) {
-	HAL_StatusTypeDef dmaStatus = HAL_ERROR;
-
-	if (data == NULL || len == 0) {
+static HAL_StatusTypeDef _UART_SendParts_DMA(UART_HandleTypeDef *huart, const UartTxPart_TypeDef *parts, uint8_t count) {
+	UartTxRing_TypeDef *r;
+	uint32_t old;
+	uint32_t next;
+	uint16_t head;
+	size_t len = 0;
+
+	if (parts == NULL || count == 0) {
 		return HAL_OK;
 	}
 
-	if (len >= UART_TX_BUFFER_SIZE) {
-		printf("_UART_SendBuffer_DMA: Data too long!\r\n");
-		return HAL_ERROR;
+	for (uint8_t i = 0; i < count; i++) {
+		len += parts[i].len;
+	}
+
+	if (len == 0) {
+		return HAL_OK;
 	}
 
-	UartSync_t *pSync = _get_sync_handle(huart);
-	if (pSync == NULL || pSync->mutex == NULL) {
+	r = _get_tx_ring(huart);
+	if (r == NULL) {
 		return HAL_ERROR;
 	}
+	__atomic_fetch_add(&r->writes, 1U, __ATOMIC_RELAXED);
+
+	// 保留空間並登記寫入者
+	old = __atomic_load_n(&r->resv, __ATOMIC_RELAXED);
+	do {
+		head = TX_RESV_HEAD(old);
+		uint16_t used = (uint16_t) (head - __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE));
+		if (len > (size_t) (r->size - used)) {
+			__atomic_fetch_add(&r->dropWrites, 1U, __ATOMIC_RELAXED);
+			__atomic_fetch_add(&r->dropBytes, (uint32_t) len, __ATOMIC_RELAXED);
+			return HAL_BUSY;
+		}
+		next = TX_RESV(TX_RESV_WRITERS(old) + 1U, head + len);
+	} while (!__atomic_compare_exchange_n(&r->resv, &old, next, true, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
 
-	if (xSemaphoreTake(pSync->mutex, portMAX_DELAY) == pdTRUE) {
-		// 複製資料到內部緩衝區，防止呼叫端緩衝區失效
-		memcpy((char *) pSync->txBuf, data, len);
+	uint16_t used = (uint16_t) (head + len - r->tail);
+	if (used > r->highWater) {
+		r->highWater = used; // 統計用，競爭時少記一點無妨
+	}
 
-		dmaStatus = HAL_UART_Transmit_DMA(pSync->huart, (uint8_t *) pSync->txBuf, len);
+	// 複製資料，繞回時分兩段
+	uint16_t pos = head;
+	for (uint8_t i = 0; i < count; i++) {
+		const uint8_t *src = parts[i].data;
+		size_t n = parts[i].len;
+		while (n > 0) {
+			uint16_t ofs = pos & (r->size - 1U);
+			size_t chunk = (n < (size_t) (r->size - ofs)) ? n : (size_t) (r->size - ofs);
+			memcpy(r->buf + ofs, src, chunk);
+			src += chunk;
+			pos += (uint16_t) chunk;
+			n -= chunk;
+		}
+	}
 
-		if (dmaStatus != HAL_OK) {
-			// DMA 啟動失敗，必須立即釋放鎖，否則死鎖
-			xSemaphoreGive(pSync->mutex);
-			printf("_UART_SendBuffer_DMA: HAL_UART_Transmit_DMA Failed!\r\n");
+	// 登出寫入者；最後一個離開的寫入者公開目前 head 之前的全部資料
+	old = __atomic_load_n(&r->resv, __ATOMIC_RELAXED);
+	do {
+		next = TX_RESV(TX_RESV_WRITERS(old) - 1U, TX_RESV_HEAD(old));
+	} while (!__atomic_compare_exchange_n(&r->resv, &old, next, true, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+	if (TX_RESV_WRITERS(next) == 0) {
+		uint16_t target = TX_RESV_HEAD(next);
+		uint16_t cur = __atomic_load_n(&r->commit, __ATOMIC_RELAXED);
+		// 只往前推：被搶佔而較晚執行的寫入者可能帶著較舊的 head
+		while ((int16_t) (target - cur) > 0 &&
+		       !__atomic_compare_exchange_n(&r->commit, &cur, target, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
 		}
-		// 成功：Mutex 將由 HAL_UART_TxCpltCallback 釋放
-	} else {
-		dmaStatus = HAL_ERROR;
 	}
 
-	return dmaStatus;
+	_tx_kick(r);
+	return HAL_OK;
+}
+
+static HAL_StatusTypeDef _UART_SendBuffer_DMA(UART_HandleTypeDef *huart, const uint8_t *data, size_t len) {
+	UartTxPart_TypeDef part = {data, len};
+
+	if (data == NULL) {
+		return HAL_OK;
+	}
+	return _UART_SendParts_DMA(huart, &part, 1);
 }
 
 
@@ -425,14 +596,15 @@ static HAL_StatusTypeDef _UART_SendBuffer_DMA(UART_HandleTypeDef *huart, const u
  * @brief 重定向 printf 到 USART1
  * @note  【架構核心】
  * 判斷 RTOS 內核是否運行：
- * 1. 運行前：使用阻塞式 HAL_UART_Transmit，此時為單執行緒，安全。
- * 2. 運行後：使用非阻塞 DMA 函式，與 G-code 等傳輸安全排隊，解決死鎖。
+ * 1. 運行前：使用阻塞式 HAL_UART_Transmit，此時為單執行緒，安全；
+ *    (建立任務後中斷被遮蔽到排程器啟動，DMA 完成中斷無法接續)。
+ * 2. 運行後：寫入環形緩衝區後立即返回，不再因前一筆 DMA 未完成而等待。
  */
 int _write(int fd, char *ptr, int len) {
 	// 假設 UART1 (huart1) 是調試端口
 
 	if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) {
-		// RTOS 運行中：使用執行緒安全的 DMA 函式
+		// RTOS 運行中：寫入環形緩衝區，空間不足時丟棄 (計入 dropBytes)
 		_UART_SendBuffer_DMA(&huart1, (const uint8_t *) ptr, len);
 	} else {
 		// RTOS 啟動前：使用阻塞式傳輸
@@ -442,7 +614,7 @@ int _write(int fd, char *ptr, int len) {
 }
 
 /**
- * @brief (公共 API) 執行緒安全的非阻塞(Non-Blocking) DMA 傳輸字串
+ * @brief (公共 API) 無鎖非阻塞(Non-Blocking) DMA 傳輸字串
  * @note  這是 _UART_SendBuffer_DMA 的字串包裝函式。
  */
 HAL_StatusTypeDef UART_SendString_DMA(UART_HandleTypeDef *huart, const char *str) {
@@ -454,6 +626,124 @@ HAL_StatusTypeDef UART_SendString_DMA(UART_HandleTypeDef *huart, const char *str
 	return _UART_SendBuffer_DMA(huart, (const uint8_t *) str, len);
 }
 
+HAL_StatusTypeDef UART_SendUrgent(UART_HandleTypeDef *huart, const char *str) {
+	UartTxRing_TypeDef *r = _get_tx_ring(huart);
+	USART_TypeDef *uart = huart->Instance;
+	DMA_Channel_TypeDef *ch = huart->hdmatx->Instance;
+	TickType_t start = xTaskGetTickCount();
+	HAL_StatusTypeDef status = HAL_OK;
+
+	if (r == NULL || !r->lineSplit || str == NULL) {
+		return HAL_ERROR;
+	}
+
+	// 擋下行邊界之後的傳輸，等傳輸中的一行送完
+	__atomic_store_n(&r->hold, 1U, __ATOMIC_SEQ_CST);
+	while (__atomic_load_n(&r->dmaBusy, __ATOMIC_SEQ_CST) != 0 || !r->atLineStart) {
+		bool dmaRunning = (ch->CCR & DMA_CCR_EN) != 0 && ch->CNDTR != 0;
+		if (xTaskGetTickCount() - start > pdMS_TO_TICKS(UART_URGENT_TIMEOUT_MS)) {
+			status = HAL_TIMEOUT;
+			if (dmaRunning) {
+				goto Release; // 直接寫 DR 會與 DMA 交錯
+			}
+			break; // 只寫了半行：仍然送出，由呼叫端記錄
+		}
+		// DMA 正在搬運時忙等；否則是被搶佔的啟動者，讓出 CPU
+		if (!dmaRunning) {
+			vTaskDelay(1);
+		}
+	}
+
+	// DMA 完成時最後一個位元組可能還在 DR，等 TXE 再寫
+	for (const char *p = str; *p != '\0'; p++) {
+		while ((uart->SR & USART_SR_TXE) == 0) {
+			if (xTaskGetTickCount() - start > pdMS_TO_TICKS(2 * UART_URGENT_TIMEOUT_MS)) {
+				status = HAL_TIMEOUT;
+				goto Release;
+			}
+		}
+		uart->DR = (uint8_t) *p;
+	}
+
+Release:
+	__atomic_store_n(&r->hold, 0U, __ATOMIC_SEQ_CST);
+	_tx_kick(r);
+	return status;
+}
+
+HAL_StatusTypeDef UART_SendParts_DMA(UART_HandleTypeDef *huart, const UartTxPart_TypeDef *parts, uint8_t count) {
+	return _UART_SendParts_DMA(huart, parts, count);
+}
+
+uint16_t UART_DiscardPending(UART_HandleTypeDef *huart) {
+	UartTxRing_TypeDef *r = _get_tx_ring(huart);
+	uint32_t idle = 0;
+	uint16_t commit;
+	uint16_t dropped;
+
+	if (r == NULL) {
+		return 0;
+	}
+	commit = __atomic_load_n(&r->commit, __ATOMIC_ACQUIRE);
+	if (__atomic_compare_exchange_n(&r->dmaBusy, &idle, 1U, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+		// 取得 dmaBusy：沒有傳輸中的資料，tail 只由本函式移動
+		dropped = (uint16_t) (commit - r->tail);
+		__atomic_store_n(&r->tail, commit, __ATOMIC_RELEASE);
+		__atomic_store_n(&r->dmaBusy, 0U, __ATOMIC_SEQ_CST);
+		_tx_kick(r); // 取得期間可能有寫入者放棄啟動
+	} else {
+		// 傳輸中的一段照常送完，由完成中斷丟棄其後的資料
+		taskENTER_CRITICAL();
+		dropped = (uint16_t) (commit - r->tail - r->dmaLen);
+		r->discardTo = commit;
+		r->discard = true;
+		taskEXIT_CRITICAL();
+	}
+	__atomic_fetch_add(&r->dropBytes, dropped, __ATOMIC_RELAXED);
+	return dropped;
+}
+
+void UART_GetTxStats(const UART_HandleTypeDef *huart, UartTxStats_TypeDef *stats) {
+	const UartTxRing_TypeDef *r = _get_tx_ring(huart);
+
+	memset(stats, 0, sizeof(*stats));
+	if (r == NULL) {
+		return;
+	}
+	stats->size = r->size;
+	stats->used = (uint16_t) (TX_RESV_HEAD(r->resv) - r->tail);
+	stats->highWater = r->highWater;
+	stats->writes = r->writes;
+	stats->dropWrites = r->dropWrites;
+	stats->dropBytes = r->dropBytes;
+	stats->dmaCount = r->dmaCount;
+	stats->dmaErrors = r->dmaErrors;
+}
+
+void GetUartTxHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
+	char buf[LINK_MAX_TX_PAYLOAD];
+	int n = snprintf(buf, sizeof(buf), "UartTx");
+
+	// 每個 UART：name=used/size,hw=,writes=,drops=,dropBytes=,dma=,dmaErr=
+	for (int i = 0; i < UART_COUNT && n < (int) sizeof(buf); i++) {
+		UartTxStats_TypeDef st;
+		UART_GetTxStats(gTxRing[i].huart, &st);
+		n += snprintf(buf + n, sizeof(buf) - (size_t) n,
+		              "%c%s=%u/%u,hw=%u,writes=%lu,drops=%lu,dropBytes=%lu,dma=%lu,dmaErr=%lu",
+		              (i == 0) ? ':' : ';', txRingName[i], st.used, st.size, st.highWater,
+		              (unsigned long) st.writes, (unsigned long) st.dropWrites, (unsigned long) st.dropBytes,
+		              (unsigned long) st.dmaCount, (unsigned long) st.dmaErrors);
+	}
+	if (n < (int) sizeof(buf) - 1) {
+		buf[n++] = '\n';
+		buf[n] = '\0';
+	} else {
+		n = (int) sizeof(buf) - 1;
+	}
+	LOG_D("%s", buf);
+	Link_Send(LINK_CH_RSP, buf, (uint16_t) n);
+}
+
 /**
  * @brief UART 錯誤回調函數
  * @note  當發生 Overrun, Noise, Framing 等錯誤時，HAL 會呼叫此函數。
@@ -467,36 +757,12 @@ void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) {
 		__HAL_UART_CLEAR_FEFLAG(huart);
 		__HAL_UART_CLEAR_PEFLAG(huart);
 
-		// 重新啟動 DMA 接收 (僅當未暫停時)
-		if (!uartRxPaused) {
-			HAL_UART_Receive_DMA(&ESP32_USART_PORT, (uint8_t*)pCurrentRxBuf->data, sizeof(pCurrentRxBuf->data));
-		}
+		// 丟棄半包並重新啟動 DMA 接收
+		Link_RxErrorCallback();
 		
 		// 可以選擇打印錯誤日誌，但在中斷中要小心
 		// printf("%-20s UART Error Recovered (Code: 0x%x)\r\n", "[usart.c]", huart->ErrorCode);
 	}
 }
 
-/**
- * @brief 恢復 UART 接收 (當有空閒緩衝區時調用)
- */
-void UART_Resume_Reception(void) {
-	uartRxBuf_TypeDef *pNewBuf = NULL;
-	
-	// 進入臨界區保護，避免與 ISR 衝突
-	taskENTER_CRITICAL();
-	
-	if (uartRxPaused) {
-		if (xQueueReceive(xFreeBufferQueue, &pNewBuf, 0) == pdTRUE) {
-			pCurrentRxBuf = pNewBuf;
-			memset(pCurrentRxBuf->data, 0, UART_RX_BUFFER_SIZE);
-			HAL_UART_Receive_DMA(&ESP32_USART_PORT, (uint8_t*)pCurrentRxBuf->data, sizeof(pCurrentRxBuf->data));
-			uartRxPaused = false;
-			// printf("UART Resumed\r\n");
-		}
-	}
-	
-	taskEXIT_CRITICAL();
-}
-
 /* USER CODE END 1 */
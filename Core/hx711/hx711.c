@@ -16,6 +16,9 @@
 
 #include "gpio.h"
 
+#define LOG_MODULE HX711
+#include "logger.h"
+
 hx711_t hx711;
 
 // Forward declaration
@@ -32,15 +35,15 @@ void Hx711_Init(hx711_t *hx711) {
     Hx711_SetScale(hx711, 417.960449f); // Default scale, should be calibrated
     Hx711_SetOffset(hx711, 0.0f);
 
-    printf("%-20s Auto-taring on initialization...\r\n", "[hx711.c]");
+    LOG_I("Auto-taring on initialization...\r\n");
     
     // Check if HX711 is connected before attempting tare
     osDelay(2000); // Brief wait for stabilization
     if (Hx711_IsReady(hx711)) {
         Hx711_Tare(hx711, 5); // Reduced times for faster init
-        printf("%-20s Initialization complete. Offset: %ld\r\n", "[hx711.c]", (long)hx711->Offset);
+        LOG_I("Initialization complete. Offset: %ld\r\n", (long)hx711->Offset);
     } else {
-        printf("%-20s HX711 not detected, skipping tare\r\n", "[hx711.c]");
+        LOG_W("HX711 not detected, skipping tare\r\n");
     }
 }
 
@@ -176,18 +179,18 @@ long Hx711_GetValue(hx711_t *hx711, uint8_t times) {
 }
 
 void Hx711_Tare(hx711_t *hx711, uint8_t times) {
-    printf("%-20s Tare start...\r\n", "[hx711.c]");
+    LOG_I("Tare start...\r\n");
     long sum = Hx711_ReadAverage(hx711, times);
     
     // Check if device is disconnected
     if (sum == 0x7FFFFFFF) {
-        printf("%-20s Tare failed: HX711 not responding\r\n", "[hx711.c]");
+        LOG_E("Tare failed: HX711 not responding\r\n");
         Hx711_SetOffset(hx711, 0.0f);
         return;
     }
     
     Hx711_SetOffset(hx711, (float)sum);
-    printf("%-20s Tare done. Offset: %ld\r\n", "[hx711.c]", (long)hx711->Offset);
+    LOG_I("Tare done. Offset: %ld\r\n", (long)hx711->Offset);
 }
 
 float Hx711_GetWeight(hx711_t *hx711, uint8_t times) {
@@ -213,9 +216,9 @@ void HX711_Calibration(void) {
      * 3. Copy the calculated 'Scale' value and update Hx711_SetScale() in Hx711_Init().
     */
 
-    printf("\r\n%-20s --- HX711 Calibration ---\r\n", "[hx711.c]");
-    printf("%-20s Ensure the scale is empty.\r\n", "[hx711.c]");
-    printf("%-20s Press USER button to start taring...\r\n", "[hx711.c]");
+    LOG_I("--- HX711 Calibration ---\r\n");
+    LOG_I("Ensure the scale is empty.\r\n");
+    LOG_I("Press USER button to start taring...\r\n");
     // Assuming USER_KEY is defined elsewhere, otherwise replace with your button logic
     // while (HAL_GPIO_ReadPin(USER_KEY_GPIO_PORT, USER_KEY_PIN) == GPIO_PIN_SET);
 
@@ -223,8 +226,8 @@ void HX711_Calibration(void) {
 
     Hx711_Tare(&hx711, 20);
 
-    printf("%-20s Place a known weight (%fg) on the scale.\r\n", "[hx711.c]", KNOWN_WEIGHT_VALUE_G);
-    printf("%-20s Press USER button when ready...\r\n", "[hx711.c]");
+    LOG_I("Place a known weight (%fg) on the scale.\r\n", KNOWN_WEIGHT_VALUE_G);
+    LOG_I("Press USER button when ready...\r\n");
     while (HAL_GPIO_ReadPin(USER_KEY_GPIO_PORT, USER_KEY_PIN) == GPIO_PIN_RESET);
 
     osDelay(1000); // Debounce
@@ -232,10 +235,10 @@ void HX711_Calibration(void) {
     long raw_reading = Hx711_GetValue(&hx711, 20);
     float new_scale = (float)(raw_reading - hx711.Offset) / KNOWN_WEIGHT_VALUE_G;
 
-    printf("%-20s Calibration complete!\r\n", "[hx711.c]");
-    printf("%-20s Raw reading with weight: %ld\r\n", "[hx711.c]", raw_reading);
-    printf("%-20s Calculated Scale: %f\r\n", "[hx711.c]", new_scale);
-    printf("%-20s -> Please update Hx711_SetScale() with this value.\r\n", "[hx711.c]");
+    LOG_I("Calibration complete!\r\n");
+    LOG_D("Raw reading with weight: %ld\r\n", raw_reading);
+    LOG_D("Calculated Scale: %f\r\n", new_scale);
+    LOG_I("-> Please update Hx711_SetScale() with this value.\r\n");
 
     Hx711_SetScale(&hx711, new_scale);
 }
@@ -16,6 +16,9 @@
 
 #include "bsp_ili9341_lcd.h"
 
+#define LOG_MODULE LCD
+#include "logger.h"
+
 static SRAM_HandleTypeDef SRAM_Handler;
 static FSMC_NORSRAM_TimingTypeDef Timing;
 
@@ -547,7 +550,7 @@ uint16_t ILI9341_ReadID(void) {
 	id |= ILI9341_Read_Data();
 
 	if (id == LCDID_ST7789V) {
-		printf("%-20s lcd drv ic: %s\r\n", "[bsp_lcd.c]", "ST7789V");
+		LOG_I("lcd drv ic: %s\r\n", "ST7789V");
 		return id;
 	} else {
 		ILI9341_Write_Cmd(0xD3);
@@ -557,7 +560,7 @@ uint16_t ILI9341_ReadID(void) {
 		id <<= 8;
 		id |= ILI9341_Read_Data();
 		if (id == LCDID_ILI9341) {
-			printf("%-20s lcd drv ic: %s\r\n", "[bsp_lcd.c]", "ILI9341");
+			LOG_I("lcd drv ic: %s\r\n", "ILI9341");
 			return id;
 		}
 	}
@@ -1,14 +1,14 @@
 #include "Fatfs_SDIO.h"
+#include "link.h"
+#include "option/syscall.h"
 
-#define TEST_FILE_NAME "test file.txt"
+#define LOG_MODULE SDCARD
+#include "logger.h"
 
 char SDPath[4]; /* SD卡邏輯裝置路徑 */
 FATFS fs; /* FatFs檔案系統物件 */
 FIL file; /* 檔案物件 */
 FRESULT f_res; /* 檔案操作結果 */
-UINT fnum; /* 成功讀寫的位元組數 */
-BYTE ReadBuffer[1024] = {0}; /* 讀取緩衝區 */
-BYTE WriteBuffer[] = "STM32/SDIO/FATFS讀寫測試，目前波特率2,000,000，新建檔案系統測試檔案\r\n";
 
 void SDIO_FatFs_init(void) {
 	if (FATFS_LinkDriver(&SD_Driver, SDPath) == 0) {
@@ -16,77 +16,139 @@ void SDIO_FatFs_init(void) {
 		printf_fatfs_error(f_res);
 
 		if (f_res == FR_NO_FILESYSTEM) {
-			printf("%-20s 》SD卡還沒有檔案系統，即將進行格式化...\r\n", "[Fatfs_SDIO.c]");
+			LOG_I("》SD卡還沒有檔案系統，即將進行格式化...\r\n");
 			f_res = f_mkfs((TCHAR const *) SDPath, 0, 0);
 			if (f_res == FR_OK) {
-				printf("%-20s 》SD卡已成功格式化檔案系統。\r\n", "[Fatfs_SDIO.c]");
+				LOG_I("》SD卡已成功格式化檔案系統。\r\n");
 				f_mount(NULL, (TCHAR const *) SDPath, 1);
 				f_mount(&fs, (TCHAR const *) SDPath, 1);
+				SD_Cache_Attach(&fs);
 			} else {
-				printf("%-20s 《《格式化失敗。》》\r\n", "[Fatfs_SDIO.c]");
+				LOG_E("《《格式化失敗。》》\r\n");
 				while (1);
 			}
 		} else if (f_res != FR_OK) {
-			printf("%-20s ！！SD卡掛載檔案系統失敗。(%d)\r\n", "[Fatfs_SDIO.c]", f_res);
+			LOG_E("！！SD卡掛載檔案系統失敗。(%d)\r\n", f_res);
 			printf_fatfs_error(f_res);
 			while (1);
 		} else {
-			printf("%-20s 》檔案系統掛載成功\r\n", "[Fatfs_SDIO.c]");
+			LOG_I("》檔案系統掛載成功\r\n");
+			BSP_SD_LinkInfo_TypeDef link;
+			BSP_SD_GetLinkInfo(&link);
+			LOG_I("》SDIO %u-bit%s read %lu kHz (div %u), write %lu kHz (div %u)\r\n", link.busWidth,
+			      link.highSpeed ? " HS" : "", (unsigned long) link.clockKHz, link.clockDiv,
+			      (unsigned long) link.writeKHz, link.writeDiv);
+			SD_Cache_Attach(&fs);
 		}
 	}
 }
 
-void SDIO_FatFs_RW_Test() {
-	printf("%-20s \r\r\n****** 這是一個SD卡 檔案系統實驗 ******\r\r\n", "[Fatfs_SDIO.c]");
-	printf("%-20s ****** 即將進行檔案寫入測試... ******\r\n", "[Fatfs_SDIO.c]");
-	f_res = f_open(&file, TEST_FILE_NAME, FA_CREATE_ALWAYS | FA_WRITE);
-	if (f_res == FR_OK) {
-		printf("%-20s 》開啟/創建 %s 檔案成功，向檔案寫入資料。\r\n", "[Fatfs_SDIO.c]", TEST_FILE_NAME);
-		f_res = f_write(&file, WriteBuffer, sizeof(WriteBuffer), &fnum);
-		if (f_res == FR_OK) {
-			printf("%-20s 》檔案寫入成功，寫入位元組數據：%d\r\n", "[Fatfs_SDIO.c]", fnum);
-			printf("%-20s 》寫入的資料為：\r\n%s\r\n", "[Fatfs_SDIO.c]", WriteBuffer);
-		} else {
-			printf("%-20s ！！檔案寫入失敗：(%d)\r\n", "[Fatfs_SDIO.c]", f_res);
-		}
-		f_close(&file);
-	} else {
-		printf("%-20s ！！開啟/創建檔案失敗。\r\n", "[Fatfs_SDIO.c]");
+/**
+ * @brief 每 MB 的週期數換算為微秒 (1 MB = 2048 個磁區)
+ */
+static unsigned long cycles_per_mb_us(uint64_t cycles, uint32_t sectors) {
+	uint32_t cyclesPerUs = SystemCoreClock / 1000000U;
+
+	if (sectors == 0 || cyclesPerUs == 0) {
+		return 0;
 	}
-	HAL_Delay(10); //不加延遲讀取不穩定
-	printf("%-20s ****** 即將進行檔案寫入測試... ******\r\n", "[Fatfs_SDIO.c]");
-	f_res = f_open(&file, TEST_FILE_NAME, FA_CREATE_ALWAYS | FA_WRITE);
-	if (f_res == FR_OK) {
-		printf("%-20s 》開啟/創建 %s 檔案成功，向檔案寫入資料。\r\n", "[Fatfs_SDIO.c]", TEST_FILE_NAME);
-		f_res = f_write(&file, WriteBuffer, sizeof(WriteBuffer), &fnum);
-		if (f_res == FR_OK) {
-			printf("%-20s 》檔案寫入成功，寫入位元組數據：%d\r\n", "[Fatfs_SDIO.c]", fnum);
-			printf("%-20s 》寫入的資料為：\r\n%s\r\n", "[Fatfs_SDIO.c]", WriteBuffer);
-		} else {
-			printf("%-20s ！！檔案寫入失敗：(%d)\r\n", "[Fatfs_SDIO.c]", f_res);
-		}
-		f_close(&file);
-	} else {
-		printf("%-20s ！！開啟/創建檔案失敗。\r\n", "[Fatfs_SDIO.c]");
+	return (unsigned long) (cycles * 2048U / sectors / cyclesPerUs);
+}
+
+void GetSdStatsHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
+	SD_IoStats_TypeDef stats;
+	char buf[200];
+
+	SD_GetIoStats(&stats);
+	int n = snprintf(buf, sizeof(buf),
+	                 "SdStats:dma=%d,rd=%lu/%lu,wr=%lu/%lu,preErase=%lu,pollUsPerMB=%lu,freedUsPerMB=%lu,bounce=%lu,timeouts=%lu,errors=%lu\n",
+	                 SD_IsDmaEnabled(),
+	                 (unsigned long) stats.readSectors, (unsigned long) stats.readCmds,
+	                 (unsigned long) stats.writeSectors, (unsigned long) stats.writeCmds,
+	                 (unsigned long) stats.preErases,
+	                 cycles_per_mb_us(stats.busyCycles, stats.pollSectors),
+	                 cycles_per_mb_us(stats.freedCycles, stats.dmaSectors),
+	                 (unsigned long) stats.bounceSectors, (unsigned long) stats.timeouts, (unsigned long) stats.errors);
+	LOG_D("%s", buf);
+	Link_Send(LINK_CH_RSP, buf, (uint16_t) n);
+}
+
+void SetSdDmaHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
+	uint32_t enable;
+
+	if (!get_uint_parameter(args, len, &enable)) {
+		LOG_W("Invalid SD DMA parameter\r\n");
+		return;
 	}
-	HAL_Delay(10); //不加延遲讀取不穩定
-	printf("%-20s ****** 即將進行檔案讀取測試... ******\r\n", "[Fatfs_SDIO.c]");
-	f_res = f_open(&file, TEST_FILE_NAME, FA_OPEN_EXISTING | FA_READ);
-	printf_fatfs_error(f_res);
-	if (f_res == FR_OK) {
-		printf("%-20s 》開啟檔案成功。\r\n", "[Fatfs_SDIO.c]");
-		f_res = f_read(&file, ReadBuffer, sizeof(ReadBuffer), &fnum);
-		if (f_res == FR_OK) {
-			printf("%-20s 》檔案讀取成功，讀取位元組數據：%d\r\n", "[Fatfs_SDIO.c]", fnum);
-			printf("%-20s 》讀取的檔案內容為：\r\n%s \r\n", "[Fatfs_SDIO.c]", ReadBuffer);
-		} else {
-			printf("%-20s ！！檔案讀取失敗：(%d)\r\n", "[Fatfs_SDIO.c]", f_res);
-		}
-	} else {
-		printf("%-20s ！！開啟檔案失敗。\r\n", "[Fatfs_SDIO.c]");
+	// 切換模式時清除統計，方便比較兩種模式
+	SD_SetDmaEnabled(enable != 0);
+	SD_ResetIoStats();
+	LOG_I("SD DMA %s\r\n", enable ? "enabled" : "disabled");
+}
+
+void GetFsLockHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
+	FF_LockStats_TypeDef stats;
+	uint32_t reset = 0;
+	char buf[120];
+
+	get_uint_parameter(args, len, &reset); // 參數可省略
+	FF_GetLockStats(0, &stats);
+	int n = snprintf(buf, sizeof(buf),
+	                 "FsLock:grants=%lu,contended=%lu,timeouts=%lu,waitMs=%lu,maxWaitMs=%lu\n",
+	                 (unsigned long) stats.grants, (unsigned long) stats.contended,
+	                 (unsigned long) stats.timeouts, (unsigned long) stats.totalWaitMs,
+	                 (unsigned long) stats.maxWaitMs);
+	LOG_D("%s", buf);
+	Link_Send(LINK_CH_RSP, buf, (uint16_t) n);
+	if (reset) {
+		FF_ResetLockStats();
+	}
+}
+
+/**
+ * @brief 命中率 (千分比)，無存取時回傳 0
+ */
+static unsigned long hit_permille(uint32_t hits, uint32_t misses) {
+	uint32_t total = hits + misses;
+	return total ? (unsigned long) ((uint64_t) hits * 1000U / total) : 0;
+}
+
+void GetSdCacheHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
+	SD_CacheStats_TypeDef stats;
+	uint32_t reset = 0;
+	char buf[200];
+
+	get_uint_parameter(args, len, &reset); // 參數可省略
+	SD_Cache_GetStats(&stats);
+	int n = snprintf(buf, sizeof(buf),
+	                 "SdCache:sectors=%u/%u/%u,fat=%lu/%lu,dir=%lu/%lu,data=%lu/%lu,hitPermille=%lu/%lu/%lu,writeUpd=%lu,evict=%lu\n",
+	                 SD_CACHE_FAT_SECTORS, SD_CACHE_DIR_SECTORS, SD_CACHE_DATA_SECTORS,
+	                 (unsigned long) stats.hits[SD_CACHE_FAT], (unsigned long) stats.misses[SD_CACHE_FAT],
+	                 (unsigned long) stats.hits[SD_CACHE_DIR], (unsigned long) stats.misses[SD_CACHE_DIR],
+	                 (unsigned long) stats.hits[SD_CACHE_DATA], (unsigned long) stats.misses[SD_CACHE_DATA],
+	                 hit_permille(stats.hits[SD_CACHE_FAT], stats.misses[SD_CACHE_FAT]),
+	                 hit_permille(stats.hits[SD_CACHE_DIR], stats.misses[SD_CACHE_DIR]),
+	                 hit_permille(stats.hits[SD_CACHE_DATA], stats.misses[SD_CACHE_DATA]),
+	                 (unsigned long) stats.writeUpdates, (unsigned long) stats.evictions);
+	LOG_D("%s", buf);
+	Link_Send(LINK_CH_RSP, buf, (uint16_t) n);
+	if (reset) {
+		SD_Cache_ResetStats();
 	}
-	f_close(&file);
+}
+
+void GetSdLinkHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
+	BSP_SD_LinkInfo_TypeDef link;
+	char buf[160];
 
-	// f_mount(NULL, (TCHAR const *) SDPath, 1);
-	// FATFS_UnLinkDriver(SDPath);
+	BSP_SD_GetLinkInfo(&link);
+	int n = snprintf(buf, sizeof(buf),
+	                 "SdLink:bus=%u,hs=%u,clkDiv=%u,kHz=%lu,wDiv=%u,wkHz=%lu,attempts=%lu,crcErrors=%lu,"
+	                 "otherErrors=%lu,writeErrors=%lu\n",
+	                 link.busWidth, link.highSpeed, link.clockDiv, (unsigned long) link.clockKHz,
+	                 link.writeDiv, (unsigned long) link.writeKHz, (unsigned long) link.attempts,
+	                 (unsigned long) link.crcErrors, (unsigned long) link.otherErrors,
+	                 (unsigned long) link.writeErrors);
+	LOG_D("%s", buf);
+	Link_Send(LINK_CH_RSP, buf, (uint16_t) n);
 }
@@ -5,20 +5,43 @@
 #include "ff.h"
 #include "ff_gen_drv.h"
 #include "sd_diskio.h"
+#include "sd_cache.h"
 #include "bsp_sdio_sdcard.h"
 #include "usart.h"
 #include "ff_print_err.h"
+#include "cmdHandler.h"
 
 extern char SDPath[4];					/* SD卡邏輯裝置路徑 */
 extern FATFS fs;						/* FatFs檔案系統物件 */
 extern FIL file;						/* 檔案物件 */
 extern FRESULT f_res;					/* 檔案操作結果 */
-extern UINT fnum;						/* 成功讀寫的位元組數 */
-extern BYTE ReadBuffer[1024];	        /* 讀取緩衝區 */
 
 void SDIO_FatFs_init(void);
 
-//用FATFS測試讀寫SD卡
-void SDIO_FatFs_RW_Test();
+/**
+ * @brief 命令：回報 SD 讀寫統計，含輪詢模式每 MB 佔用與 DMA 模式每 MB 讓出的 CPU 時間
+ * @note  rd/wr 欄位為 磁區數/命令數，比值即平均每次多磁區傳輸的長度
+ */
+void GetSdStatsHandler(const char *args, size_t len, ResStruct_t *_resStruct);
+
+/**
+ * @brief 命令：切換 SD DMA 模式 cSetSdDma<0|1>，並清除統計
+ */
+void SetSdDmaHandler(const char *args, size_t len, ResStruct_t *_resStruct);
+
+/**
+ * @brief 命令：回報檔案系統卷冊鎖的取得、爭用與逾時次數，cReqFsLock<1> 回報後清除
+ */
+void GetFsLockHandler(const char *args, size_t len, ResStruct_t *_resStruct);
+
+/**
+ * @brief 命令：回報磁區快取各類別 命中/未命中 次數與命中率，cReqSdCache<1> 回報後清除
+ */
+void GetSdCacheHandler(const char *args, size_t len, ResStruct_t *_resStruct);
+
+/**
+ * @brief 命令：回報開機時協商的 SDIO 匯流排寬度、高速模式與讀/寫時鐘，以及訓練與執行期寫入的錯誤次數
+ */
+void GetSdLinkHandler(const char *args, size_t len, ResStruct_t *_resStruct);
 
 #endif //FATFS_SDIO_TEST_H
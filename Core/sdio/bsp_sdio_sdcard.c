@@ -20,9 +20,16 @@
 
   
 SD_HandleTypeDef uSdHandle;
+static DMA_HandleTypeDef hdma_sdio;
+static BSP_SD_LinkInfo_TypeDef sdLink;
+static volatile uint8_t sdWriting;   /* the last transfer started was a write */
+static volatile uint8_t sdErrorSignaled; /* HAL_SD_ErrorCallback ran in this interrupt */
  
-uint8_t SD_DMAConfigRx(SD_HandleTypeDef *hsd);
-uint8_t SD_DMAConfigTx(SD_HandleTypeDef *hsd);
+static uint8_t SD_DMAInit(SD_HandleTypeDef *hsd);
+static void SD_DMASetDirection(SD_HandleTypeDef *hsd, uint32_t direction);
+static void SD_LinkTrain(void);
+static void SD_LinkUseClock(uint8_t write);
+static void SD_LinkWriteFailed(void);
 
 /**
   * @brief  Initializes the SD card device.
@@ -40,7 +47,7 @@ uint8_t BSP_SD_Init(void)
   uSdHandle.Init.ClockPowerSave      = SDIO_CLOCK_POWER_SAVE_DISABLE;
   uSdHandle.Init.BusWide             = SDIO_BUS_WIDE_1B;
   uSdHandle.Init.HardwareFlowControl = SDIO_HARDWARE_FLOW_CONTROL_ENABLE; // 啟用硬體流控制
-  uSdHandle.Init.ClockDiv            = 0x20; // 降低時鐘速度提高穩定性 (原 0x10)
+  uSdHandle.Init.ClockDiv            = SD_LINK_SAFE_CLKDIV; // 初始化與訓練用的保底時鐘，實際速度由 SD_LinkTrain 決定
   
 //  /* Check if the SD card is plugged in the slot */
 //  if(BSP_SD_IsDetected() != SD_PRESENT)
@@ -59,15 +66,19 @@ uint8_t BSP_SD_Init(void)
   /* Configure SD Bus width */
   if(state == MSD_OK)
   {
-    /* Enable wide operation */
-    if(HAL_SD_ConfigWideBusOperation(&uSdHandle, SDIO_BUS_WIDE_4B) != HAL_OK)
+    /* Enable wide operation, 卡片拒絕時維持 1-bit 繼續訓練 */
+    if(HAL_SD_ConfigWideBusOperation(&uSdHandle, SDIO_BUS_WIDE_4B) == HAL_OK)
     {
-      state = MSD_ERROR;
+      sdLink.busWidth = 4U;
     }
     else
     {
-      state = MSD_OK;
+      uSdHandle.ErrorCode = HAL_SD_ERROR_NONE;
+      sdLink.busWidth = 1U;
     }
+    
+    SD_LinkTrain();
+    state = SD_DMAInit(&uSdHandle);
   }
   
   return  state;
@@ -142,6 +153,7 @@ __weak void BSP_SD_DetectCallback(void)
   */
 uint8_t BSP_SD_ReadBlocks(uint32_t *pData, uint32_t ReadAddr, uint32_t NumOfBlocks, uint32_t Timeout)
 {
+  SD_LinkUseClock(0U);
   if(HAL_SD_ReadBlocks(&uSdHandle, (uint8_t *)pData, ReadAddr, NumOfBlocks, Timeout) != HAL_OK)
   {
     return MSD_ERROR;
@@ -162,8 +174,13 @@ uint8_t BSP_SD_ReadBlocks(uint32_t *pData, uint32_t ReadAddr, uint32_t NumOfBloc
   */
 uint8_t BSP_SD_WriteBlocks(uint32_t *pData, uint32_t WriteAddr, uint32_t NumOfBlocks, uint32_t Timeout)
 {
+  SD_LinkUseClock(1U);
   if(HAL_SD_WriteBlocks(&uSdHandle, (uint8_t *)pData, WriteAddr, NumOfBlocks, Timeout) != HAL_OK)
   {
+    if(uSdHandle.ErrorCode & (HAL_SD_ERROR_DATA_CRC_FAIL | HAL_SD_ERROR_TX_UNDERRUN))
+    {
+      SD_LinkWriteFailed();
+    }
     return MSD_ERROR;
   }
   else
@@ -175,53 +192,37 @@ uint8_t BSP_SD_WriteBlocks(uint32_t *pData, uint32_t WriteAddr, uint32_t NumOfBl
 /**
   * @brief  Reads block(s) from a specified address in an SD card, in DMA mode.
   * @param  pData: Pointer to the buffer that will contain the data to transmit
+  *                (must be 4-byte aligned, DMA uses word transfers)
   * @param  ReadAddr: Address from where data is to be read
   * @param  NumOfBlocks: Number of SD blocks to read 
   * @retval SD status
   */
 uint8_t BSP_SD_ReadBlocks_DMA(uint32_t *pData, uint32_t ReadAddr, uint32_t NumOfBlocks)
 { 
-  uint8_t state = MSD_OK;
-  
-  /* Invalidate the dma tx handle*/
-  uSdHandle.hdmatx = NULL;
-    
-  /* Prepare the dma channel for a read operation */
-  state = ((SD_DMAConfigRx(&uSdHandle) == MSD_OK) ? MSD_OK : MSD_ERROR);
-  
-  if(state == MSD_OK)
-  {
-    /* Read block(s) in DMA transfer mode */
-    state = ((HAL_SD_ReadBlocks_DMA(&uSdHandle, (uint8_t *)pData, ReadAddr, NumOfBlocks) == HAL_OK) ? MSD_OK : MSD_ERROR);
-  }
+  /* Point the shared channel at SDIO -> memory */
+  SD_DMASetDirection(&uSdHandle, DMA_PERIPH_TO_MEMORY);
+  SD_LinkUseClock(0U);
   
-  return state; 
+  /* Read block(s) in DMA transfer mode */
+  return ((HAL_SD_ReadBlocks_DMA(&uSdHandle, (uint8_t *)pData, ReadAddr, NumOfBlocks) == HAL_OK) ? MSD_OK : MSD_ERROR);
 }
 
 /**
   * @brief  Writes block(s) to a specified address in an SD card, in DMA mode.
   * @param  pData: Pointer to the buffer that will contain the data to transmit
+  *                (must be 4-byte aligned, DMA uses word transfers)
   * @param  WriteAddr: Address from where data is to be written
   * @param  NumOfBlocks: Number of SD blocks to write 
   * @retval SD status
   */
 uint8_t BSP_SD_WriteBlocks_DMA(uint32_t *pData, uint32_t WriteAddr, uint32_t NumOfBlocks)
 { 
-  uint8_t state = MSD_OK;
+  /* Point the shared channel at memory -> SDIO */
+  SD_DMASetDirection(&uSdHandle, DMA_MEMORY_TO_PERIPH);
+  SD_LinkUseClock(1U);
   
-  /* Invalidate the dma rx handle*/
-  uSdHandle.hdmarx = NULL;
-    
-  /* Prepare the dma channel for a read operation */
-  state = ((SD_DMAConfigTx(&uSdHandle) == MSD_OK) ? MSD_OK : MSD_ERROR);
-  
-  if(state == MSD_OK)
-  { 
-    /* Write block(s) in DMA transfer mode */
-    state = ((HAL_SD_WriteBlocks_DMA(&uSdHandle, (uint8_t *)pData, WriteAddr, NumOfBlocks) == HAL_OK) ? MSD_OK : MSD_ERROR);
-  }
-  
-  return state;  
+  /* Write block(s) in DMA transfer mode */
+  return ((HAL_SD_WriteBlocks_DMA(&uSdHandle, (uint8_t *)pData, WriteAddr, NumOfBlocks) == HAL_OK) ? MSD_OK : MSD_ERROR);
 }
 
 /**
@@ -242,6 +243,58 @@ uint8_t BSP_SD_Erase(uint32_t StartAddr, uint32_t EndAddr)
   }
 }
 
+/**
+  * @brief  Sends ACMD23 (SET_WR_BLK_ERASE_COUNT) ahead of a multi-block write.
+  *         The card may pre-erase NumOfBlocks blocks so the following CMD25
+  *         does not stall on erase between blocks. The value only applies to
+  *         the next multiple block write command.
+  * @param  NumOfBlocks: Number of blocks the next CMD25 will write (1..0x7FFFFF)
+  * @retval SD status
+  */
+uint8_t BSP_SD_SetWriteEraseCount(uint32_t NumOfBlocks)
+{
+  SDIO_CmdInitTypeDef sdmmc_cmdinit;
+  uint32_t tickstart;
+
+  if((NumOfBlocks == 0U) || (NumOfBlocks > 0x7FFFFFU))
+  {
+    return MSD_ERROR;
+  }
+
+  /* CMD55 with the card's RCA */
+  if(SDMMC_CmdAppCommand(uSdHandle.Instance, (uint32_t)(uSdHandle.SdCard.RelCardAdd << 16U)) != SDMMC_ERROR_NONE)
+  {
+    return MSD_ERROR;
+  }
+
+  /* ACMD23, the LL driver has no wrapper for the application form */
+  sdmmc_cmdinit.Argument         = NumOfBlocks;
+  sdmmc_cmdinit.CmdIndex         = SDMMC_CMD_SET_BLOCK_COUNT;
+  sdmmc_cmdinit.Response         = SDIO_RESPONSE_SHORT;
+  sdmmc_cmdinit.WaitForInterrupt = SDIO_WAIT_NO;
+  sdmmc_cmdinit.CPSM             = SDIO_CPSM_ENABLE;
+  SDIO_SendCommand(uSdHandle.Instance, &sdmmc_cmdinit);
+
+  tickstart = HAL_GetTick();
+  while(!__SDIO_GET_FLAG(uSdHandle.Instance, SDIO_FLAG_CCRCFAIL | SDIO_FLAG_CMDREND | SDIO_FLAG_CTIMEOUT))
+  {
+    if((HAL_GetTick() - tickstart) > SDIO_CMDTIMEOUT)
+    {
+      return MSD_ERROR;
+    }
+  }
+
+  if(__SDIO_GET_FLAG(uSdHandle.Instance, SDIO_FLAG_CTIMEOUT | SDIO_FLAG_CCRCFAIL) ||
+     (SDIO_GetCommandResponse(uSdHandle.Instance) != SDMMC_CMD_SET_BLOCK_COUNT))
+  {
+    __SDIO_CLEAR_FLAG(uSdHandle.Instance, SDIO_STATIC_FLAGS);
+    return MSD_ERROR;
+  }
+  __SDIO_CLEAR_FLAG(uSdHandle.Instance, SDIO_STATIC_FLAGS);
+
+  return ((SDIO_GetResponse(uSdHandle.Instance, SDIO_RESP1) & SDMMC_OCR_ERRORBITS) == 0U) ? MSD_OK : MSD_ERROR;
+}
+
 /**
   * @brief  Gets the current SD card data status.
   * @retval Data transfer state.
@@ -266,6 +319,16 @@ void BSP_SD_GetCardInfo(HAL_SD_CardInfoTypeDef *CardInfo)
   HAL_SD_GetCardInfo(&uSdHandle, CardInfo);
 }
 
+/**
+  * @brief  Get the result of the last link training.
+  * @param  LinkInfo: Pointer to BSP_SD_LinkInfo_TypeDef structure
+  * @retval None 
+  */
+void BSP_SD_GetLinkInfo(BSP_SD_LinkInfo_TypeDef *LinkInfo)
+{
+  *LinkInfo = sdLink;
+}
+
 /**
   * @}
   */  
@@ -323,99 +386,427 @@ __weak void BSP_SD_MspInit(void *Params)
 }
 
 /**
-  * @brief SD_DMAConfigRx
+  * @brief SD_DMAInit
   * @par Function Description
-  *   This function configure the DMA to receive data from the SD card
+  *   RX and TX share DMA2 channel 4, so a single handle is configured once
+  *   and only the direction bit is switched per transfer (SD_DMASetDirection).
   * @retval
   *  SD_ERROR or SD_OK
   */
-uint8_t SD_DMAConfigRx(SD_HandleTypeDef *hsd)
+static uint8_t SD_DMAInit(SD_HandleTypeDef *hsd)
 {
-  static DMA_HandleTypeDef hdma_rx;
-  HAL_StatusTypeDef status = HAL_ERROR;
+  HAL_StatusTypeDef status;
   
-  if(hsd->hdmarx == NULL)
+  hdma_sdio.Init.Direction           = DMA_PERIPH_TO_MEMORY;
+  hdma_sdio.Init.PeriphInc           = DMA_PINC_DISABLE;
+  hdma_sdio.Init.MemInc              = DMA_MINC_ENABLE;
+  hdma_sdio.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+  hdma_sdio.Init.MemDataAlignment    = DMA_MDATAALIGN_WORD;
+  hdma_sdio.Init.Mode                = DMA_NORMAL;
+  hdma_sdio.Init.Priority            = DMA_PRIORITY_VERY_HIGH;
+  hdma_sdio.Instance                 = SD_DMAx_Tx_INSTANCE;
+  
+  /* Both links point at the same handle, so HAL error/abort paths never
+     dereference a NULL channel */
+  __HAL_LINKDMA(hsd, hdmarx, hdma_sdio);
+  __HAL_LINKDMA(hsd, hdmatx, hdma_sdio);
+  
+  HAL_DMA_DeInit(&hdma_sdio);
+  status = HAL_DMA_Init(&hdma_sdio);
+  
+  /* DMA completes reads, SDIO DATAEND completes writes; both call into
+     FreeRTOS, so they must stay at or below configMAX_SYSCALL_INTERRUPT_PRIORITY */
+  HAL_NVIC_SetPriority(SD_DMAx_Tx_IRQn, 0xD, 0);
+  HAL_NVIC_EnableIRQ(SD_DMAx_Tx_IRQn);
+  HAL_NVIC_SetPriority(SDIO_IRQn, 0xC, 0);
+  HAL_NVIC_EnableIRQ(SDIO_IRQn);
+  
+  return (status != HAL_OK? MSD_ERROR : MSD_OK);
+}
+
+/**
+  * @brief SD_DMASetDirection
+  * @par Function Description
+  *   Switches the shared channel between RX and TX by rewriting CCR.DIR,
+  *   instead of a full DeInit/Init cycle on every direction change.
+  * @param hsd: SD handle
+  * @param direction: DMA_PERIPH_TO_MEMORY or DMA_MEMORY_TO_PERIPH
+  */
+static void SD_DMASetDirection(SD_HandleTypeDef *hsd, uint32_t direction)
+{
+  /* HAL abort paths clear the links, restore them */
+  hsd->hdmarx = &hdma_sdio;
+  hsd->hdmatx = &hdma_sdio;
+  
+  if(hdma_sdio.Init.Direction != direction)
   {
-    /* Configure DMA Rx parameters */
-    hdma_rx.Init.Direction           = DMA_PERIPH_TO_MEMORY;
-    hdma_rx.Init.PeriphInc           = DMA_PINC_DISABLE;
-    hdma_rx.Init.MemInc              = DMA_MINC_ENABLE;
-    hdma_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
-    hdma_rx.Init.MemDataAlignment    = DMA_MDATAALIGN_WORD;
-    hdma_rx.Init.Priority            = DMA_PRIORITY_VERY_HIGH;
+    /* DIR may only change while the channel is disabled */
+    __HAL_DMA_DISABLE(&hdma_sdio);
+    MODIFY_REG(hdma_sdio.Instance->CCR, DMA_CCR_DIR, direction);
+    hdma_sdio.Init.Direction = direction;
+  }
+}
 
-    hdma_rx.Instance = SD_DMAx_Rx_INSTANCE;
+/**
+  * @brief SD_LinkSetClockDiv
+  * @par Function Description
+  *   Changes only CLKCR.CLKDIV and keeps the handle in sync, so a later
+  *   HAL_SD_ConfigWideBusOperation does not fall back to the old divider.
+  * @param div: CLKDIV value, SDIO_CK = HCLK / (div + 2)
+  */
+static void SD_LinkSetClockDiv(uint32_t div)
+{
+  MODIFY_REG(uSdHandle.Instance->CLKCR, SDIO_CLKCR_CLKDIV, div);
+  uSdHandle.Init.ClockDiv = div;
+}
 
-    /* Associate the DMA handle */
-    __HAL_LINKDMA(hsd, hdmarx, hdma_rx);
+/**
+  * @brief SD_LinkUseClock
+  * @par Function Description
+  *   Selects the read or the write divider before a transfer. Reads run at
+  *   the trained clock, writes at sdLink.writeDiv; CLKDIV is only rewritten
+  *   when it changes and the data path is idle at this point.
+  * @param write: 1 before a write, 0 before a read
+  */
+static void SD_LinkUseClock(uint8_t write)
+{
+  uint32_t div = write ? sdLink.writeDiv : sdLink.clockDiv;
+  
+  sdWriting = write;
+  if((uSdHandle.Instance->CLKCR & SDIO_CLKCR_CLKDIV) != div)
+  {
+    SD_LinkSetClockDiv(div);
+  }
+}
 
-    /* Stop any ongoing transfer and reset the state*/
-    HAL_DMA_Abort(&hdma_rx);
-    
-    /* Deinitialize the Channel for new transfer */
-    HAL_DMA_DeInit(&hdma_rx);
+/**
+  * @brief SD_LinkWriteFailed
+  * @par Function Description
+  *   A write ended with a data CRC error or a TX FIFO underrun. Steps the
+  *   write divider down by one so the retry in the disk layer runs slower;
+  *   reads keep their trained clock. Called from the SDIO interrupt too.
+  */
+static void SD_LinkWriteFailed(void)
+{
+  sdLink.writeErrors++;
+  if(sdLink.writeDiv < SD_LINK_SAFE_CLKDIV)
+  {
+    sdLink.writeDiv++;
+    sdLink.writeKHz = HAL_RCC_GetHCLKFreq() / (sdLink.writeDiv + 2U) / 1000U;
+  }
+}
 
-    /* Configure the DMA Channel */
-    status = HAL_DMA_Init(&hdma_rx);
-    
-    /* NVIC configuration for DMA transfer complete interrupt */
-    HAL_NVIC_SetPriority(SD_DMAx_Rx_IRQn, 0xD, 0);
-    HAL_NVIC_EnableIRQ(SD_DMAx_Rx_IRQn);
+/**
+  * @brief SD_LinkWaitTransfer
+  * @par Function Description
+  *   Waits for the card to return to the transfer state after a failed
+  *   read, a broken block still finishes on the card side.
+  */
+static void SD_LinkWaitTransfer(void)
+{
+  uint32_t tickstart = HAL_GetTick();
+  
+  while(HAL_SD_GetCardState(&uSdHandle) != HAL_SD_CARD_TRANSFER)
+  {
+    if((HAL_GetTick() - tickstart) >= SD_LINK_TIMEOUT_MS)
+    {
+      break;
+    }
   }
-  else
+  uSdHandle.ErrorCode = HAL_SD_ERROR_NONE;
+  __SDIO_CLEAR_FLAG(uSdHandle.Instance, SDIO_STATIC_FLAGS);
+}
+
+/**
+  * @brief SD_LinkSwitchHighSpeed
+  * @par Function Description
+  *   CMD6 mode 1, function group 1 = high speed. The card answers with a
+  *   64-byte status block; byte 13 bit 1 tells whether high speed is
+  *   supported and the low nibble of byte 16 which function was selected.
+  * @retval HAL_SD_ERROR_NONE when the card runs with high-speed timing
+  */
+static uint32_t SD_LinkSwitchHighSpeed(void)
+{
+  SDIO_DataInitTypeDef config;
+  uint32_t errorstate;
+  uint32_t tickstart;
+  uint32_t status[16] = {0U};
+  uint32_t index = 0U;
+  
+  /* Command class 10 (switch) is optional before SD 1.10 */
+  if((uSdHandle.SdCard.Class & (1U << 10)) == 0U)
   {
-    status = HAL_OK;
+    return HAL_SD_ERROR_UNSUPPORTED_FEATURE;
   }
   
-  return (status != HAL_OK? MSD_ERROR : MSD_OK);
+  errorstate = SDMMC_CmdBlockLength(uSdHandle.Instance, sizeof(status));
+  if(errorstate != HAL_SD_ERROR_NONE)
+  {
+    return errorstate;
+  }
+  
+  config.DataTimeOut   = SDMMC_DATATIMEOUT;
+  config.DataLength    = sizeof(status);
+  config.DataBlockSize = SDIO_DATABLOCK_SIZE_64B;
+  config.TransferDir   = SDIO_TRANSFER_DIR_TO_SDIO;
+  config.TransferMode  = SDIO_TRANSFER_MODE_BLOCK;
+  config.DPSM          = SDIO_DPSM_ENABLE;
+  SDIO_ConfigData(uSdHandle.Instance, &config);
+  
+  errorstate = SDMMC_CmdSwitch(uSdHandle.Instance, 0x80FFFFF1U);
+  if(errorstate != HAL_SD_ERROR_NONE)
+  {
+    __SDIO_CLEAR_FLAG(uSdHandle.Instance, SDIO_STATIC_FLAGS);
+    return errorstate;
+  }
+  
+  tickstart = HAL_GetTick();
+  while(!__SDIO_GET_FLAG(uSdHandle.Instance, SDIO_FLAG_RXOVERR | SDIO_FLAG_DCRCFAIL | SDIO_FLAG_DTIMEOUT | SDIO_FLAG_DATAEND))
+  {
+    if(__SDIO_GET_FLAG(uSdHandle.Instance, SDIO_FLAG_RXDAVL) && (index < 16U))
+    {
+      status[index++] = SDIO_ReadFIFO(uSdHandle.Instance);
+    }
+    if((HAL_GetTick() - tickstart) >= SD_LINK_TIMEOUT_MS)
+    {
+      __SDIO_CLEAR_FLAG(uSdHandle.Instance, SDIO_STATIC_FLAGS);
+      return HAL_SD_ERROR_TIMEOUT;
+    }
+  }
+  while(__SDIO_GET_FLAG(uSdHandle.Instance, SDIO_FLAG_RXDAVL) && (index < 16U))
+  {
+    status[index++] = SDIO_ReadFIFO(uSdHandle.Instance);
+  }
+  
+  if(__SDIO_GET_FLAG(uSdHandle.Instance, SDIO_FLAG_DCRCFAIL))
+  {
+    errorstate = HAL_SD_ERROR_DATA_CRC_FAIL;
+  }
+  else if(__SDIO_GET_FLAG(uSdHandle.Instance, SDIO_FLAG_DTIMEOUT))
+  {
+    errorstate = HAL_SD_ERROR_DATA_TIMEOUT;
+  }
+  else if(__SDIO_GET_FLAG(uSdHandle.Instance, SDIO_FLAG_RXOVERR))
+  {
+    errorstate = HAL_SD_ERROR_RX_OVERRUN;
+  }
+  __SDIO_CLEAR_FLAG(uSdHandle.Instance, SDIO_STATIC_FLAGS);
+  
+  /* Back to 512-byte blocks for every later transfer */
+  (void)SDMMC_CmdBlockLength(uSdHandle.Instance, BLOCKSIZE);
+  
+  if(errorstate != HAL_SD_ERROR_NONE)
+  {
+    return errorstate;
+  }
+  
+  /* FIFO words hold the status bytes in little-endian order */
+  if((((status[3] >> 8) & 0x02U) == 0U) || ((status[4] & 0x0FU) != 0x01U))
+  {
+    return HAL_SD_ERROR_UNSUPPORTED_FEATURE;
+  }
+  
+  /* The new timing applies 8 clocks after the status block */
+  HAL_Delay(1);
+  return HAL_SD_ERROR_NONE;
 }
 
 /**
-  * @brief SD_DMAConfigTx
+  * @brief SD_LinkReadHash
   * @par Function Description
-  *   This function configure the DMA to transmit data to the SD card
-  * @retval
-  *  SD_ERROR or SD_OK
+  *   Single-block polling read that folds the FIFO words into an FNV-1a
+  *   hash instead of storing them, so training needs no sector buffer and
+  *   can run again on any task stack when FatFs re-initializes the disk.
+  *   Hardware flow control holds SDIO_CK while the FIFO is full.
+  * @param block: block number
+  * @param hash: receives the hash of the block data
+  * @retval HAL_SD_ERROR_NONE or the command/data error
   */
-uint8_t SD_DMAConfigTx(SD_HandleTypeDef *hsd)
+static uint32_t SD_LinkReadHash(uint32_t block, uint32_t *hash)
 {
-  static DMA_HandleTypeDef hdma_tx;
-  HAL_StatusTypeDef status;
+  SDIO_DataInitTypeDef config;
+  uint32_t errorstate;
+  uint32_t tickstart;
+  uint32_t h = 2166136261U;
+  uint32_t i;
+  
+  config.DataTimeOut   = SDMMC_DATATIMEOUT;
+  config.DataLength    = BLOCKSIZE;
+  config.DataBlockSize = SDIO_DATABLOCK_SIZE_512B;
+  config.TransferDir   = SDIO_TRANSFER_DIR_TO_SDIO;
+  config.TransferMode  = SDIO_TRANSFER_MODE_BLOCK;
+  config.DPSM          = SDIO_DPSM_ENABLE;
+  SDIO_ConfigData(uSdHandle.Instance, &config);
   
-  if(hsd->hdmatx == NULL)
+  if(uSdHandle.SdCard.CardType != CARD_SDHC_SDXC)
   {
-    /* Configure DMA Tx parameters */
-    hdma_tx.Init.Direction           = DMA_MEMORY_TO_PERIPH;
-    hdma_tx.Init.PeriphInc           = DMA_PINC_DISABLE;
-    hdma_tx.Init.MemInc              = DMA_MINC_ENABLE;
-    hdma_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
-    hdma_tx.Init.MemDataAlignment    = DMA_MDATAALIGN_WORD;
-    hdma_tx.Init.Priority            = DMA_PRIORITY_VERY_HIGH;
-    
-    hdma_tx.Instance = SD_DMAx_Tx_INSTANCE;
-    
-    /* Associate the DMA handle */
-    __HAL_LINKDMA(hsd, hdmatx, hdma_tx);
-    
-    /* Stop any ongoing transfer and reset the state*/
-    HAL_DMA_Abort(&hdma_tx);
-    
-    /* Deinitialize the Channel for new transfer */
-    HAL_DMA_DeInit(&hdma_tx);
+    block *= BLOCKSIZE;
+  }
+  errorstate = SDMMC_CmdReadSingleBlock(uSdHandle.Instance, block);
+  if(errorstate != HAL_SD_ERROR_NONE)
+  {
+    __SDIO_CLEAR_FLAG(uSdHandle.Instance, SDIO_STATIC_FLAGS);
+    return errorstate;
+  }
+  
+  tickstart = HAL_GetTick();
+  while(!__SDIO_GET_FLAG(uSdHandle.Instance, SDIO_FLAG_RXOVERR | SDIO_FLAG_DCRCFAIL | SDIO_FLAG_DTIMEOUT | SDIO_FLAG_DATAEND))
+  {
+    if(__SDIO_GET_FLAG(uSdHandle.Instance, SDIO_FLAG_RXFIFOHF))
+    {
+      for(i = 0U; i < 8U; i++)
+      {
+        h = (h ^ SDIO_ReadFIFO(uSdHandle.Instance)) * 16777619U;
+      }
+    }
+    if((HAL_GetTick() - tickstart) >= SD_LINK_TIMEOUT_MS)
+    {
+      __SDIO_CLEAR_FLAG(uSdHandle.Instance, SDIO_STATIC_FLAGS);
+      return HAL_SD_ERROR_TIMEOUT;
+    }
+  }
+  while(__SDIO_GET_FLAG(uSdHandle.Instance, SDIO_FLAG_RXDAVL))
+  {
+    h = (h ^ SDIO_ReadFIFO(uSdHandle.Instance)) * 16777619U;
+  }
+  
+  if(__SDIO_GET_FLAG(uSdHandle.Instance, SDIO_FLAG_DCRCFAIL))
+  {
+    errorstate = HAL_SD_ERROR_DATA_CRC_FAIL;
+  }
+  else if(__SDIO_GET_FLAG(uSdHandle.Instance, SDIO_FLAG_DTIMEOUT))
+  {
+    errorstate = HAL_SD_ERROR_DATA_TIMEOUT;
+  }
+  else if(__SDIO_GET_FLAG(uSdHandle.Instance, SDIO_FLAG_RXOVERR))
+  {
+    errorstate = HAL_SD_ERROR_RX_OVERRUN;
+  }
+  __SDIO_CLEAR_FLAG(uSdHandle.Instance, SDIO_STATIC_FLAGS);
+  
+  *hash = h;
+  return errorstate;
+}
+
+/**
+  * @brief SD_LinkTrain
+  * @par Function Description
+  *   Reads reference hashes of the first blocks at the safe clock, then
+  *   starts at SD_LINK_FAST_CLKDIV and repeats the reads. Any CRC error,
+  *   timeout or hash mismatch steps the divider up by one; the first
+  *   divider that passes every round is kept. Default-speed timing already
+  *   allows 25 MHz, so a card that refuses CMD6 is still trained.
+  *   Writes are not exercised here (no scratch sector before FatFs is
+  *   mounted), so the write clock is capped at SD_LINK_WRITE_CLKDIV and
+  *   lowered further by SD_LinkWriteFailed at runtime.
+  */
+static void SD_LinkTrain(void)
+{
+  uint32_t ref[SD_LINK_VERIFY_BLOCKS];
+  uint32_t hash;
+  uint32_t errorstate;
+  uint32_t div;
+  uint32_t round;
+  uint32_t i;
+  uint8_t  refOk = 1U;
+  uint8_t  pass = 0U;
+  
+  sdLink.attempts    = 0U;
+  sdLink.crcErrors   = 0U;
+  sdLink.otherErrors = 0U;
+  sdLink.highSpeed   = (SD_LinkSwitchHighSpeed() == HAL_SD_ERROR_NONE) ? 1U : 0U;
+  uSdHandle.ErrorCode = HAL_SD_ERROR_NONE;
+  
+  /* 保底時鐘下讀不到參考值時不提速 */
+  for(i = 0U; refOk && (i < SD_LINK_VERIFY_BLOCKS); i++)
+  {
+    if(SD_LinkReadHash(i, &ref[i]) != HAL_SD_ERROR_NONE)
+    {
+      sdLink.otherErrors++;
+      refOk = 0U;
+    }
+  }
+  
+  for(div = SD_LINK_FAST_CLKDIV; refOk && (div < SD_LINK_SAFE_CLKDIV); div++)
+  {
+    SD_LinkSetClockDiv(div);
+    sdLink.attempts++;
+    pass = 1U;
     
-    /* Configure the DMA Channel */
-    status = HAL_DMA_Init(&hdma_tx); 
+    for(round = 0U; pass && (round < SD_LINK_VERIFY_ROUNDS); round++)
+    {
+      for(i = 0U; pass && (i < SD_LINK_VERIFY_BLOCKS); i++)
+      {
+        errorstate = SD_LinkReadHash(i, &hash);
+        if(errorstate & (HAL_SD_ERROR_DATA_CRC_FAIL | HAL_SD_ERROR_CMD_CRC_FAIL))
+        {
+          sdLink.crcErrors++;
+          pass = 0U;
+        }
+        else if((errorstate != HAL_SD_ERROR_NONE) || (hash != ref[i]))
+        {
+          sdLink.otherErrors++;
+          pass = 0U;
+        }
+      }
+    }
     
-    /* NVIC configuration for DMA transfer complete interrupt */
-    HAL_NVIC_SetPriority(SD_DMAx_Tx_IRQn, 0xD, 0);
-    HAL_NVIC_EnableIRQ(SD_DMAx_Tx_IRQn);  
+    if(pass)
+    {
+      break;
+    }
+    /* 降一級前先以保底時鐘等待卡片結束未完成的區塊 */
+    SD_LinkSetClockDiv(SD_LINK_SAFE_CLKDIV);
+    SD_LinkWaitTransfer();
   }
-  else
+  
+  if(!pass)
   {
-    status = HAL_OK;
+    div = SD_LINK_SAFE_CLKDIV;
+    SD_LinkSetClockDiv(div);
   }
+  sdLink.clockDiv = (uint8_t)div;
+  sdLink.clockKHz = HAL_RCC_GetHCLKFreq() / (div + 2U) / 1000U;
   
-  return (status != HAL_OK? MSD_ERROR : MSD_OK);
+  /* Training only proves reads; writes stay at or below the write ceiling */
+  sdLink.writeDiv = (uint8_t)((div > SD_LINK_WRITE_CLKDIV) ? div : SD_LINK_WRITE_CLKDIV);
+  sdLink.writeKHz = HAL_RCC_GetHCLKFreq() / (sdLink.writeDiv + 2U) / 1000U;
+  sdLink.writeErrors = 0U;
+}
+
+/**
+  * @brief SDIO interrupt handler: completes DMA writes (DATAEND) and reports
+  *        data-path errors to the waiting task.
+  */
+void BSP_SD_IRQHandler(void)
+{
+  uint32_t errors = uSdHandle.Instance->STA & uSdHandle.Instance->MASK &
+                    (SDIO_IT_DCRCFAIL | SDIO_IT_DTIMEOUT | SDIO_IT_RXOVERR | SDIO_IT_TXUNDERR | SDIO_IT_STBITERR);
+  
+  sdErrorSignaled = 0U;
+  HAL_SD_IRQHandler(&uSdHandle);
+  
+  if(errors != 0U)
+  {
+    if(sdWriting && (errors & (SDIO_IT_DCRCFAIL | SDIO_IT_TXUNDERR)))
+    {
+      SD_LinkWriteFailed();
+    }
+    /* HAL reports the error through HAL_SD_ErrorCallback; its DMA abort path
+       skips the callback when the card already left the data state */
+    if(sdErrorSignaled == 0U)
+    {
+      BSP_SD_ErrorCallback();
+    }
+  }
+}
+
+/**
+  * @brief DMA2 channel 4 interrupt handler: completes DMA reads.
+  */
+void SD_DMAx_Tx_IRQHandler(void)
+{
+  HAL_DMA_IRQHandler(&hdma_sdio);
 }
 
 /**
@@ -448,6 +839,26 @@ void HAL_SD_RxCpltCallback(SD_HandleTypeDef *hsd)
   BSP_SD_ReadCpltCallback();
 }
 
+/**
+  * @brief SD error callbacks (DMA error path)
+  * @param hsd: SD handle
+  * @retval None
+  */
+void HAL_SD_ErrorCallback(SD_HandleTypeDef *hsd)
+{
+  sdErrorSignaled = 1U;
+  BSP_SD_ErrorCallback();
+}
+
+/**
+  * @brief BSP SD error callbacks
+  * @retval None
+  */
+__weak void BSP_SD_ErrorCallback(void)
+{
+
+}
+
 /**
   * @brief BSP SD Abort callbacks
   * @retval None
@@ -26,6 +26,15 @@
    
 #define SD_DATATIMEOUT           100000000U
 
+/* Link training: SDIO_CK = HCLK / (CLKDIV + 2) */
+#define SD_LINK_FAST_CLKDIV      1U      /* 24 MHz, upper limit for the F103 SDIO */
+#define SD_LINK_SAFE_CLKDIV      0x20U   /* ~2 MHz, fallback when every faster divider fails */
+#define SD_LINK_WRITE_CLKDIV     4U      /* 12 MHz, write ceiling: with HW flow control the F1 SDIO
+                                            can glitch SDIO_CK on writes (errata), training only reads */
+#define SD_LINK_VERIFY_BLOCKS    4U      /* blocks read back per divider */
+#define SD_LINK_VERIFY_ROUNDS    8U      /* read-verify passes per divider */
+#define SD_LINK_TIMEOUT_MS       100U
+
 #define SD_PRESENT               ((uint8_t)0x01)
 #define SD_NOT_PRESENT           ((uint8_t)0x00)
 
@@ -39,6 +48,23 @@
 #define SD_DMAx_Tx_IRQHandler             DMA2_Channel4_5_IRQHandler
 #define SD_DMAx_Rx_IRQHandler             DMA2_Channel4_5_IRQHandler
 
+/** 
+  * @brief  Result of the link training done in BSP_SD_Init
+  */
+typedef struct
+{
+  uint8_t  busWidth;      /* 1 or 4 */
+  uint8_t  highSpeed;     /* CMD6 switched the card to high-speed timing */
+  uint8_t  clockDiv;      /* negotiated CLKDIV, used for reads */
+  uint8_t  writeDiv;      /* CLKDIV used for writes, never faster than SD_LINK_WRITE_CLKDIV */
+  uint32_t clockKHz;      /* resulting SDIO_CK for reads */
+  uint32_t writeKHz;      /* resulting SDIO_CK for writes */
+  uint32_t attempts;      /* dividers tried, including the one kept */
+  uint32_t crcErrors;     /* command/data CRC failures seen while training */
+  uint32_t otherErrors;   /* timeouts, overruns and data mismatches */
+  uint32_t writeErrors;   /* runtime write CRC/underrun errors, each one slows writes by one step */
+} BSP_SD_LinkInfo_TypeDef;
+
 /* Exported SD handle */
 extern SD_HandleTypeDef uSdHandle;
 
@@ -52,14 +78,19 @@ uint8_t BSP_SD_WriteBlocks(uint32_t *pData, uint32_t WriteAddr, uint32_t NumOfBl
 uint8_t BSP_SD_ReadBlocks_DMA(uint32_t *pData, uint32_t ReadAddr, uint32_t NumOfBlocks);
 uint8_t BSP_SD_WriteBlocks_DMA(uint32_t *pData, uint32_t WriteAddr, uint32_t NumOfBlocks);
 uint8_t BSP_SD_Erase(uint32_t StartAddr, uint32_t EndAddr);
+uint8_t BSP_SD_SetWriteEraseCount(uint32_t NumOfBlocks);
 uint8_t BSP_SD_GetCardState(void);
 void    BSP_SD_GetCardInfo(HAL_SD_CardInfoTypeDef *CardInfo);
+void    BSP_SD_GetLinkInfo(BSP_SD_LinkInfo_TypeDef *LinkInfo);
 uint8_t BSP_SD_IsDetected(void);
+void    BSP_SD_IRQHandler(void);
+void    SD_DMAx_Tx_IRQHandler(void);
    
 /* These functions can be modified in case the current settings
    need to be changed for specific application needs */
 void    BSP_SD_MspInit(void *Params);
 void    BSP_SD_AbortCallback(void);
+void    BSP_SD_ErrorCallback(void);
 void    BSP_SD_WriteCpltCallback(void);
 void    BSP_SD_ReadCpltCallback(void); 
 
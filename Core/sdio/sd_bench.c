@@ -0,0 +1,326 @@
+/**
+ * @file    sd_bench.c
+ * @brief   SD 卡效能與健康檢測，輸出格式見 sd_bench.h
+ */
+
+#include "sd_bench.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cmsis_os2.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "Fatfs_SDIO.h"
+#include "link.h"
+#include "esp32.h"
+#include "fileTask.h"
+#include "printerController.h"
+#include "storage.h"
+#include "boot.h"
+
+#define LOG_MODULE SDCARD
+#include "logger.h"
+
+#define SD_BENCH_FILE_BYTES      ((uint32_t) SD_BENCH_FILE_KB * 1024U)
+#define SD_BENCH_TEXT_BYTES      ((uint32_t) SD_BENCH_TEXT_KB * 1024U)
+#define SD_BENCH_SECTOR          512U
+#define SD_BENCH_LINE_LEN        32U    // 文字測試每行長度 (含換行)
+
+typedef struct {
+	uint16_t jobId;
+	uint32_t mask;
+	FIL fil;
+	BYTE *buf;
+	UINT bufSize;
+	FRESULT fr;          // 第一個失敗的檔案操作
+} SdBenchCtx_TypeDef;
+
+static osThreadId_t benchTaskHandle = NULL;
+static const osThreadAttr_t benchTask_attributes = {
+	.name = "SdBench_Task",
+	.stack_size = configMINIMAL_STACK_SIZE * 16,
+	.priority = (osPriority_t) osPriorityBelowNormal,
+};
+
+/**
+ * @brief 送出一行 JSON 結果，fmt 為 "job" 之後的欄位
+ */
+static void bench_emit(const SdBenchCtx_TypeDef *ctx, const char *fmt, ...) {
+	char line[160];
+	va_list ap;
+	int n = snprintf(line, sizeof(line), "{\"job\":%u,", ctx->jobId);
+
+	va_start(ap, fmt);
+	n += vsnprintf(line + n, sizeof(line) - (size_t) n, fmt, ap);
+	va_end(ap);
+	if (n > (int) sizeof(line) - 3) {
+		n = (int) sizeof(line) - 3;
+	}
+	line[n++] = '}';
+	line[n++] = '\n';
+	line[n] = '\0';
+
+	LOG_D("%s", line);
+	Link_Send(LINK_CH_EVENT, line, (uint16_t) n);
+}
+
+/**
+ * @brief 記錄第一個錯誤，之後的測試全部略過
+ */
+static bool bench_ok(SdBenchCtx_TypeDef *ctx, FRESULT fr, UINT done, UINT want) {
+	if (ctx->fr == FR_OK) {
+		if (fr != FR_OK) {
+			ctx->fr = fr;
+		} else if (done != want) {
+			ctx->fr = FR_DENIED; // 磁碟已滿
+		}
+	}
+	return ctx->fr == FR_OK;
+}
+
+static uint32_t elapsed_ms(TickType_t start) {
+	uint32_t ms = (uint32_t) ((xTaskGetTickCount() - start) * portTICK_PERIOD_MS);
+	return ms ? ms : 1U;
+}
+
+static unsigned long kbps(uint32_t bytes, uint32_t ms) {
+	return (unsigned long) ((uint64_t) bytes * 1000U / 1024U / ms);
+}
+
+static uint32_t xorshift32(uint32_t *state) {
+	uint32_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	return *state = x;
+}
+
+static int cmp_u32(const void *a, const void *b) {
+	uint32_t x = *(const uint32_t *) a;
+	uint32_t y = *(const uint32_t *) b;
+	return (x > y) - (x < y);
+}
+
+/**
+ * @brief 以各種傳輸長度 (512 B 起倍增至緩衝區大小) 覆寫再讀回整個暫存檔
+ */
+static void bench_sequential(SdBenchCtx_TypeDef *ctx) {
+	UINT n;
+
+	for (UINT size = SD_BENCH_SECTOR; size <= ctx->bufSize; size *= 2) {
+		TickType_t t0 = xTaskGetTickCount();
+		if (!bench_ok(ctx, f_lseek(&ctx->fil, 0), 0, 0)) return;
+		for (uint32_t pos = 0; pos < SD_BENCH_FILE_BYTES; pos += size) {
+			if (!bench_ok(ctx, f_write(&ctx->fil, ctx->buf, size, &n), n, size)) return;
+		}
+		if (!bench_ok(ctx, f_sync(&ctx->fil), 0, 0)) return;
+		uint32_t ms = elapsed_ms(t0);
+		bench_emit(ctx, "\"test\":\"seqWrite\",\"size\":%u,\"bytes\":%lu,\"ms\":%lu,\"kBps\":%lu",
+		           size, (unsigned long) SD_BENCH_FILE_BYTES, (unsigned long) ms, kbps(SD_BENCH_FILE_BYTES, ms));
+	}
+
+	for (UINT size = SD_BENCH_SECTOR; size <= ctx->bufSize; size *= 2) {
+		TickType_t t0 = xTaskGetTickCount();
+		if (!bench_ok(ctx, f_lseek(&ctx->fil, 0), 0, 0)) return;
+		for (uint32_t pos = 0; pos < SD_BENCH_FILE_BYTES; pos += size) {
+			if (!bench_ok(ctx, f_read(&ctx->fil, ctx->buf, size, &n), n, size)) return;
+		}
+		uint32_t ms = elapsed_ms(t0);
+		bench_emit(ctx, "\"test\":\"seqRead\",\"size\":%u,\"bytes\":%lu,\"ms\":%lu,\"kBps\":%lu",
+		           size, (unsigned long) SD_BENCH_FILE_BYTES, (unsigned long) ms, kbps(SD_BENCH_FILE_BYTES, ms));
+	}
+}
+
+/**
+ * @brief 隨機位置的單磁區讀取；位置對齊磁區時 f_read 直接讀入緩衝區，不經 FIL 視窗
+ */
+static void bench_random(SdBenchCtx_TypeDef *ctx) {
+	uint32_t seed = 0x2545F491U;
+	UINT n;
+
+	TickType_t t0 = xTaskGetTickCount();
+	for (uint32_t i = 0; i < SD_BENCH_RAND_OPS; i++) {
+		uint32_t sect = xorshift32(&seed) % (SD_BENCH_FILE_BYTES / SD_BENCH_SECTOR);
+		if (!bench_ok(ctx, f_lseek(&ctx->fil, sect * SD_BENCH_SECTOR), 0, 0)) return;
+		if (!bench_ok(ctx, f_read(&ctx->fil, ctx->buf, SD_BENCH_SECTOR, &n), n, SD_BENCH_SECTOR)) return;
+	}
+	uint32_t ms = elapsed_ms(t0);
+	bench_emit(ctx, "\"test\":\"randRead\",\"ops\":%u,\"ms\":%lu,\"iops\":%lu",
+	           SD_BENCH_RAND_OPS, (unsigned long) ms, (unsigned long) (SD_BENCH_RAND_OPS * 1000U / ms));
+}
+
+/**
+ * @brief 逐次量測循序寫入的延遲；卡片內部整理 (GC) 時單次寫入可達數百 ms，
+ *        只看平均吞吐量看不出來，因此回報百分位數與最大值
+ */
+static void bench_latency(SdBenchCtx_TypeDef *ctx) {
+	uint32_t *lat = pvPortMalloc(SD_BENCH_LAT_OPS * sizeof(uint32_t));
+	uint32_t cyclesPerUs = SystemCoreClock / 1000000U;
+	UINT size = ctx->bufSize;
+	uint32_t ops = 0;
+	UINT n;
+
+	if (lat == NULL) {
+		bench_emit(ctx, "\"test\":\"writeLat\",\"error\":\"no memory\"");
+		return;
+	}
+	if (bench_ok(ctx, f_lseek(&ctx->fil, 0), 0, 0)) {
+		for (; ops < SD_BENCH_LAT_OPS && (ops + 1) * size <= SD_BENCH_FILE_BYTES; ops++) {
+			uint32_t c0 = DWT->CYCCNT;
+			if (!bench_ok(ctx, f_write(&ctx->fil, ctx->buf, size, &n), n, size)) break;
+			lat[ops] = (DWT->CYCCNT - c0) / cyclesPerUs;
+		}
+	}
+	if (ctx->fr == FR_OK && ops > 0) {
+		qsort(lat, ops, sizeof(uint32_t), cmp_u32);
+		bench_emit(ctx, "\"test\":\"writeLat\",\"size\":%u,\"ops\":%lu,\"p50Us\":%lu,\"p90Us\":%lu,\"p99Us\":%lu,\"maxUs\":%lu",
+		           size, (unsigned long) ops,
+		           (unsigned long) lat[ops * 50 / 100], (unsigned long) lat[ops * 90 / 100],
+		           (unsigned long) lat[ops * 99 / 100], (unsigned long) lat[ops - 1]);
+	}
+	vPortFree(lat);
+}
+
+/**
+ * @brief FatFs 層的小筆寫入與 f_gets 讀取 (經 FIL 的 512 B 視窗)，接近 G-code 的存取型態
+ */
+static void bench_fs_text(SdBenchCtx_TypeDef *ctx) {
+	uint32_t lines = SD_BENCH_TEXT_BYTES / SD_BENCH_LINE_LEN;
+	uint32_t perBuf = ctx->bufSize / SD_BENCH_LINE_LEN;
+	char line[SD_BENCH_LINE_LEN * 2];
+	UINT n;
+
+	// 文字先產生在緩衝區，不計入量測時間
+	for (uint32_t i = 0; i < perBuf; i++) {
+		char *p = (char *) ctx->buf + i * SD_BENCH_LINE_LEN;
+		snprintf(line, sizeof(line), "G1 X%03lu.%03lu Y%03lu.%03lu E%lu.%05lu",
+		         (unsigned long) (i % 220), (unsigned long) (i * 7 % 1000),
+		         (unsigned long) (i * 3 % 220), (unsigned long) (i * 11 % 1000),
+		         (unsigned long) (i % 10), (unsigned long) (i * 37 % 100000));
+		memset(p, ' ', SD_BENCH_LINE_LEN);
+		memcpy(p, line, strnlen(line, SD_BENCH_LINE_LEN - 1));
+		p[SD_BENCH_LINE_LEN - 1] = '\n';
+	}
+
+	if (!bench_ok(ctx, f_lseek(&ctx->fil, 0), 0, 0)) return;
+	if (!bench_ok(ctx, f_truncate(&ctx->fil), 0, 0)) return;
+	TickType_t t0 = xTaskGetTickCount();
+	for (uint32_t i = 0; i < lines; i++) {
+		const BYTE *p = ctx->buf + (i % perBuf) * SD_BENCH_LINE_LEN;
+		if (!bench_ok(ctx, f_write(&ctx->fil, p, SD_BENCH_LINE_LEN, &n), n, SD_BENCH_LINE_LEN)) return;
+	}
+	if (!bench_ok(ctx, f_sync(&ctx->fil), 0, 0)) return;
+	uint32_t writeMs = elapsed_ms(t0);
+
+	if (!bench_ok(ctx, f_lseek(&ctx->fil, 0), 0, 0)) return;
+	uint32_t got = 0;
+	t0 = xTaskGetTickCount();
+	while (f_gets(line, sizeof(line), &ctx->fil) != NULL) {
+		got++;
+	}
+	uint32_t getsMs = elapsed_ms(t0);
+	if (!bench_ok(ctx, f_error(&ctx->fil) ? FR_DISK_ERR : FR_OK, got, lines)) return;
+
+	bench_emit(ctx, "\"test\":\"fsText\",\"lines\":%lu,\"writeKBps\":%lu,\"getsKBps\":%lu",
+	           (unsigned long) lines, kbps(SD_BENCH_TEXT_BYTES, writeMs), kbps(SD_BENCH_TEXT_BYTES, getsMs));
+}
+
+static void SdBench_Task(void *argument) {
+	SdBenchCtx_TypeDef *ctx = argument;
+	SD_IoStats_TypeDef before, after;
+	BSP_SD_CardInfo card;
+	BSP_SD_LinkInfo_TypeDef link;
+	char detail[16] = {0};
+
+	BSP_SD_GetCardInfo(&card);
+	BSP_SD_GetLinkInfo(&link);
+	bench_emit(ctx, "\"test\":\"card\",\"sectors\":%lu,\"bus\":%u,\"hs\":%u,\"kHz\":%lu,\"wkHz\":%lu",
+	           (unsigned long) card.BlockNbr, link.busWidth, link.highSpeed, (unsigned long) link.clockKHz,
+	           (unsigned long) link.writeKHz);
+	SD_GetIoStats(&before);
+
+	// 先一次配置整個暫存檔，循序與隨機測試只覆寫已配置的叢集
+	if (bench_ok(ctx, f_open(&ctx->fil, SD_BENCH_FILE, FA_CREATE_ALWAYS | FA_READ | FA_WRITE), 0, 0)) {
+		f_chmod(SD_BENCH_FILE, AM_HID | AM_SYS, AM_HID | AM_SYS);
+		bench_ok(ctx, f_lseek(&ctx->fil, SD_BENCH_FILE_BYTES), f_tell(&ctx->fil), SD_BENCH_FILE_BYTES);
+		memset(ctx->buf, 0xA5, ctx->bufSize);
+		if (ctx->fr == FR_OK && (ctx->mask & SD_BENCH_SEQ)) bench_sequential(ctx);
+		if (ctx->fr == FR_OK && (ctx->mask & SD_BENCH_RAND)) bench_random(ctx);
+		if (ctx->fr == FR_OK && (ctx->mask & SD_BENCH_LATENCY)) bench_latency(ctx);
+		if (ctx->fr == FR_OK && (ctx->mask & SD_BENCH_FS_TEXT)) bench_fs_text(ctx);
+		f_close(&ctx->fil);
+		f_unlink(SD_BENCH_FILE);
+	}
+
+	SD_GetIoStats(&after);
+	bench_emit(ctx, "\"test\":\"health\",\"timeouts\":%lu,\"errors\":%lu",
+	           (unsigned long) (after.timeouts - before.timeouts), (unsigned long) (after.errors - before.errors));
+
+	if (ctx->fr != FR_OK) {
+		snprintf(detail, sizeof(detail), "fr=%d", ctx->fr);
+	}
+	ESP32_JobComplete(ctx->jobId, ctx->fr == FR_OK, ctx->fr != FR_OK ? detail : NULL);
+
+	vPortFree(ctx->buf);
+	vPortFree(ctx);
+	benchTaskHandle = NULL;
+	vTaskDelete(NULL);
+}
+
+bool SdBench_IsRunning(void) {
+	return benchTaskHandle != NULL;
+}
+
+void SdBenchHandler(const char *args, size_t len, ResStruct_t *_resStruct) {
+	uint16_t jobId = ESP32_JobStart();
+	uint32_t mask = SD_BENCH_ALL;
+	SdBenchCtx_TypeDef *ctx;
+
+	if (benchTaskHandle != NULL || gcodeRxTaskHandle != NULL || PC_GetState() == PC_BUSY) {
+		ESP32_JobComplete(jobId, false, "busy");
+		return;
+	}
+	if (!Boot_StorageReady()) {
+		ESP32_JobComplete(jobId, false, "booting");
+		return;
+	}
+	get_uint_parameter(args, len, &mask); // 參數可省略
+	if ((mask & SD_BENCH_ALL) == 0) {
+		ESP32_JobComplete(jobId, false, "bad mask");
+		return;
+	}
+	if (Storage_CheckFits(SD_BENCH_FILE_BYTES) == STORAGE_NO_SPACE) {
+		ESP32_JobComplete(jobId, false, "no space");
+		return;
+	}
+
+	ctx = pvPortMalloc(sizeof(*ctx));
+	if (ctx == NULL) {
+		ESP32_JobComplete(jobId, false, "no memory");
+		return;
+	}
+	memset(ctx, 0, sizeof(*ctx));
+	ctx->jobId = jobId;
+	ctx->mask = mask;
+
+	// 傳輸長度上限依可配置的緩衝區而定 (4096 → 2048 → 1024)
+	for (ctx->bufSize = SD_BENCH_MAX_CHUNK; ctx->bufSize >= 1024U; ctx->bufSize /= 2) {
+		ctx->buf = pvPortMalloc(ctx->bufSize);
+		if (ctx->buf != NULL) {
+			break;
+		}
+	}
+	if (ctx->buf == NULL) {
+		vPortFree(ctx);
+		ESP32_JobComplete(jobId, false, "no memory");
+		return;
+	}
+
+	benchTaskHandle = osThreadNew(SdBench_Task, ctx, &benchTask_attributes);
+	if (benchTaskHandle == NULL) {
+		vPortFree(ctx->buf);
+		vPortFree(ctx);
+		ESP32_JobComplete(jobId, false, "no memory");
+	}
+}
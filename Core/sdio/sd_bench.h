@@ -0,0 +1,51 @@
+/**
+ * @file    sd_bench.h
+ * @brief   SD 卡效能與健康檢測
+ *
+ *          以非同步工作執行 (cSdBench)，只讀寫暫存檔 sdbench.tmp，
+ *          不碰其他檔案，結束後刪除。每項結果以一行 JSON 經
+ *          事件通道 (LINK_CH_EVENT) 送出，最後送出工作完成事件：
+ *
+ *          {"job":3,"test":"card","sectors":15523840,"bus":4,"hs":1,"kHz":24000}
+ *          {"job":3,"test":"seqWrite","size":4096,"bytes":1048576,"ms":812,"kBps":1261}
+ *          {"job":3,"test":"seqRead","size":4096,"bytes":1048576,"ms":402,"kBps":2547}
+ *          {"job":3,"test":"randRead","ops":256,"ms":310,"iops":825}
+ *          {"job":3,"test":"writeLat","size":4096,"ops":128,"p50Us":2100,"p90Us":2900,"p99Us":210000,"maxUs":254000}
+ *          {"job":3,"test":"fsText","lines":4681,"writeKBps":310,"getsKBps":420}
+ *          {"job":3,"test":"health","timeouts":0,"errors":0}
+ *          done:3:ok
+ */
+
+#ifndef _SD_BENCH_H_
+#define _SD_BENCH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cmdHandler.h"
+
+#define SD_BENCH_FILE            "sdbench.tmp"
+#define SD_BENCH_FILE_KB         1024   // 循序讀寫與隨機讀取的範圍
+#define SD_BENCH_TEXT_KB         128    // f_write/f_gets 文字測試的長度
+#define SD_BENCH_MAX_CHUNK       4096   // 最大單次傳輸長度，配置失敗時減半
+#define SD_BENCH_RAND_OPS        256    // 隨機 512 B 讀取次數
+#define SD_BENCH_LAT_OPS         128    // 寫入延遲取樣數
+
+/*            測試項目 (cSdBench<mask>，省略時全部執行)            */
+#define SD_BENCH_SEQ             (1U << 0)
+#define SD_BENCH_RAND            (1U << 1)
+#define SD_BENCH_LATENCY         (1U << 2)
+#define SD_BENCH_FS_TEXT         (1U << 3)
+#define SD_BENCH_ALL             0x0FU
+
+/**
+ * @brief SD 卡測試是否執行中；上傳與列印在測試期間不可開始 (互斥，避免與 SD 卡競爭)
+ */
+bool SdBench_IsRunning(void);
+
+/**
+ * @brief 命令：執行 SD 卡測試 cSdBench<mask>
+ * @note  列印或上傳中拒絕執行
+ */
+void SdBenchHandler(const char *args, size_t len, ResStruct_t *_resStruct);
+
+#endif /* _SD_BENCH_H_ */
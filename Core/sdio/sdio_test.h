@@ -1,11 +0,0 @@
-#ifndef __SDIO_TEST_H
-#define __SDIO_TEST_H
-
-#include "stm32f1xx.h"
-
-void SD_Test(void);
-
-#endif
-
-
-/*****************************END OF FILE**************************/
@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+"""
+gen_cmd_table.py - 由 cmdList.h 的 CMD_TABLE 產生命令分派用的完美雜湊表
+
+用法: gen_cmd_table.py <cmdList.h> <輸出 cmdTable.h>
+
+讀取 cmdList.h 中的 CMD_xxx 字串定義與 CMD_TABLE(X) 清單，為所有命令名稱
+尋找一組無碰撞的 FNV-1a 種子，輸出以雜湊槽位索引的常數命令表。
+命令名稱重複、格式錯誤或找不到定義時直接以錯誤結束，讓問題在編譯期就被發現。
+雜湊演算法必須與 cmdHandler.c 的 cmd_hash() 保持一致。
+"""
+import re
+import sys
+
+FNV_PRIME = 16777619
+MAX_SEED_TRIES = 1 << 20
+
+
+def fnv1a(name, seed):
+    h = seed
+    for ch in name.encode("ascii"):
+        h ^= ch
+        h = (h * FNV_PRIME) & 0xFFFFFFFF
+    return h
+
+
+def fail(msg):
+    sys.stderr.write("gen_cmd_table.py: error: %s\n" % msg)
+    sys.exit(1)
+
+
+def parse(path):
+    with open(path, encoding="utf-8") as f:
+        text = f.read()
+
+    defines = {}
+    for m in re.finditer(r'#define\s+(CMD_\w+)\s+\(const char\s*\*\)\s*"([^"]*)"', text):
+        defines[m.group(1)] = m.group(2)
+
+    m = re.search(r'#define\s+CMD_TABLE\(X\)((?:[^\n]*\\\n)*[^\n]*)', text)
+    if not m:
+        fail("CMD_TABLE(X) not found in %s" % path)
+    entries = re.findall(r'X\(\s*(CMD_\w+)\s*,\s*(\w+)\s*\)', m.group(1))
+    if not entries:
+        fail("CMD_TABLE(X) is empty")
+
+    table = []
+    seen = {}
+    for macro, handler in entries:
+        if macro not in defines:
+            fail("%s used in CMD_TABLE but not defined" % macro)
+        name = defines[macro]
+        if not re.fullmatch(r'[A-Za-z][A-Za-z0-9_]*', name):
+            fail("invalid command name '%s' (%s)" % (name, macro))
+        if name in seen:
+            fail("duplicate command name '%s' (%s and %s)" % (name, seen[name], macro))
+        seen[name] = macro
+        table.append((macro, name, handler))
+    return table
+
+
+def find_seed(names, bits):
+    mask = (1 << bits) - 1
+    seed = 0x811C9DC5
+    for _ in range(MAX_SEED_TRIES):
+        slots = {}
+        for name in names:
+            s = fnv1a(name, seed) & mask
+            if s in slots:
+                break
+            slots[s] = name
+        else:
+            return seed, slots
+        seed = (seed + 0x9E3779B9) & 0xFFFFFFFF
+    return None, None
+
+
+def main():
+    if len(sys.argv) != 3:
+        fail("usage: gen_cmd_table.py <cmdList.h> <cmdTable.h>")
+    table = parse(sys.argv[1])
+    names = [name for _, name, _ in table]
+
+    bits = max(1, (2 * len(names) - 1).bit_length())
+    seed, slots = find_seed(names, bits)
+    while seed is None:
+        bits += 1
+        seed, slots = find_seed(names, bits)
+
+    by_name = {name: (macro, handler) for macro, name, handler in table}
+    out = []
+    out.append("/* 由 tools/gen_cmd_table.py 依 cmdList.h 自動產生，請勿手動修改 */")
+    out.append("#ifndef _CMD_TABLE_GEN_H_")
+    out.append("#define _CMD_TABLE_GEN_H_")
+    out.append("")
+    out.append("#define CMD_COUNT      %d" % len(names))
+    out.append("#define CMD_HASH_BITS  %d" % bits)
+    out.append("#define CMD_HASH_SEED  0x%08XU" % seed)
+    out.append("")
+    out.append("static const Command_Typedef cmdHashTable[1U << CMD_HASH_BITS] = {")
+    for slot in sorted(slots):
+        name = slots[slot]
+        macro, handler = by_name[name]
+        out.append("\t[%d] = {\"%s\", %d, %s}, /* %s */" % (slot, name, len(name), handler, macro))
+    out.append("};")
+    out.append("")
+    out.append("#endif /* _CMD_TABLE_GEN_H_ */")
+    out.append("")
+
+    with open(sys.argv[2], "w", encoding="utf-8") as f:
+        f.write("\n".join(out))
+
+
+if __name__ == "__main__":
+    main()
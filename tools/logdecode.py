@@ -0,0 +1,241 @@
+#!/usr/bin/env python3
+"""
+logdecode.py - 解碼 UART1 上的 token 化日誌 (見 Core/Inc/tlog.h)
+
+用法:
+  logdecode.py table <韌體.elf> <輸出.logfmt.json>
+      從 ELF 的 .logfmt 區段產生訊息 id 表 (建置後由 CMake 自動執行)
+  logdecode.py decode <id 表.json | 韌體.elf> [擷取檔 | --port <序列埠> [--baud <鮑率>]]
+      解碼二進位日誌，未指定來源時讀取 stdin；串流中的一般文字原樣輸出
+
+.logfmt 區段中每個字串為 "檔名\\x1f行號\\x1f格式"，字串位址的低 16 位元即訊息 id。
+訊框: SYNC(0x1E) | id(2) | tick ms(4) | len(1) | 參數(len)，len 最高位元表示被截斷。
+每個參數以 1 位元組標籤開頭，標籤必須與 tlog.h 的 TLOG_TAG_xxx 一致。
+無法辨識的訊框 (id 不在表中或參數格式不符) 當作一般文字處理。
+"""
+import json
+import re
+import struct
+import sys
+
+SYNC = 0x1E
+HDR_SIZE = 8
+LEN_TRUNCATED = 0x80
+
+# C 轉換規格；長度修飾詞在 Python 中無意義，解碼時去除
+SPEC_RE = re.compile(r'%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d+))?(hh|h|ll|l|j|z|t|L)?([diouxXeEfFgGcsp%])')
+
+
+def fail(msg):
+    sys.stderr.write("logdecode.py: error: %s\n" % msg)
+    sys.exit(1)
+
+
+# ---------------------------------------------------------------- id 表
+
+def read_logfmt_section(path):
+    """回傳 (.logfmt 位址, 內容)，只解析 ELF32 小端序的區段標頭"""
+    with open(path, "rb") as f:
+        elf = f.read()
+    if elf[:4] != b"\x7fELF" or elf[4] != 1 or elf[5] != 1:
+        fail("%s is not a little-endian ELF32 file" % path)
+    shoff, = struct.unpack_from("<I", elf, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from("<HHH", elf, 0x2E)
+
+    def section(i):
+        return struct.unpack_from("<IIIIIIIIII", elf, shoff + i * shentsize)
+
+    strtab = section(shstrndx)
+    names = elf[strtab[4]:strtab[4] + strtab[5]]
+    for i in range(shnum):
+        name_off, _, _, addr, offset, size = section(i)[:6]
+        name = names[name_off:names.index(b"\0", name_off)].decode("ascii")
+        if name == ".logfmt":
+            return addr, elf[offset:offset + size]
+    fail("%s has no .logfmt section (no TLOG call sites or old linker script)" % path)
+
+
+def build_table(elf_path):
+    addr, data = read_logfmt_section(elf_path)
+    if addr + len(data) > 0x10000:
+        fail(".logfmt ends at 0x%X, ids are 16 bits" % (addr + len(data)))
+    table = {}
+    pos = 0
+    while pos < len(data):
+        if data[pos] == 0:  # 字串之間的對齊填充
+            pos += 1
+            continue
+        end = data.index(b"\0", pos)
+        parts = data[pos:end].decode("utf-8", "replace").split("\x1f", 2)
+        if len(parts) != 3:
+            fail("malformed .logfmt entry at 0x%X" % (addr + pos))
+        table[addr + pos] = {"file": parts[0], "line": int(parts[1]), "fmt": parts[2]}
+        pos = end + 1
+    return table
+
+
+def load_table(path):
+    if path.endswith(".json"):
+        with open(path, encoding="utf-8") as f:
+            return {int(k): v for k, v in json.load(f).items()}
+    return build_table(path)
+
+
+# ---------------------------------------------------------------- 解碼
+
+def parse_args(payload):
+    """依標籤取出參數，格式不符時回傳 None"""
+    args = []
+    pos = 0
+    try:
+        while pos < len(payload):
+            tag = chr(payload[pos])
+            pos += 1
+            if tag == "i" or tag == "p":
+                args.append((tag, struct.unpack_from("<I", payload, pos)[0]))
+                pos += 4
+            elif tag == "q":
+                args.append((tag, struct.unpack_from("<Q", payload, pos)[0]))
+                pos += 8
+            elif tag == "f":
+                args.append((tag, struct.unpack_from("<f", payload, pos)[0]))
+                pos += 4
+            elif tag == "s":
+                n = payload[pos]
+                if pos + 1 + n > len(payload):
+                    return None
+                args.append((tag, payload[pos + 1:pos + 1 + n].decode("utf-8", "replace")))
+                pos += 1 + n
+            else:
+                return None
+    except (struct.error, IndexError):
+        return None
+    return args
+
+
+def to_signed(tag, v):
+    bits = 64 if tag == "q" else 32
+    return v - (1 << bits) if v >> (bits - 1) else v
+
+
+def c_format(fmt, args):
+    """以 C printf 的語意套用參數；參數不足時顯示 <?>"""
+    it = iter(args)
+
+    def take():
+        return next(it, (None, None))
+
+    def repl(m):
+        flags, width, prec, _, conv = m.groups()
+        if conv == "%":
+            return "%"
+        if width == "*":
+            width = str(to_signed("i", take()[1] or 0))
+        if prec == "*":
+            prec = str(to_signed("i", take()[1] or 0))
+        tag, v = take()
+        if tag is None:
+            return "<?>"
+        spec = "%" + flags + (width or "") + ("." + prec if prec is not None else "")
+        if conv in "di":
+            return (spec + "d") % (to_signed(tag, v) if tag in "iq" else int(v))
+        if conv in "ouxX":
+            return (spec + conv.replace("u", "d")) % (int(v) if tag != "f" else 0)
+        if conv in "eEfFgG":
+            return (spec + conv) % (v if tag == "f" else float(to_signed(tag, v)))
+        if conv == "c":
+            return (spec + "c") % chr(v & 0xFF if tag == "i" else 0x3F)
+        if conv == "s":
+            return (spec + "s") % (v if tag == "s" else "<%s>" % v)
+        return (spec + "s") % ("0x%08x" % v if tag == "p" else str(v))
+
+    return SPEC_RE.sub(repl, fmt)
+
+
+class Decoder:
+    def __init__(self, table, out):
+        self.table = table
+        self.out = out
+        self.buf = bytearray()
+
+    def text(self, data):
+        self.out.write(data.decode("utf-8", "replace"))
+
+    def frame(self):
+        """buf[0] 為 SYNC；回傳消耗的位元組數，資料不足時回傳 0"""
+        if len(self.buf) < HDR_SIZE:
+            return 0
+        msg_id, tick, ln = struct.unpack_from("<HIB", self.buf, 1)
+        n = ln & ~LEN_TRUNCATED
+        entry = self.table.get(msg_id)
+        if entry is None:
+            return -1
+        if len(self.buf) < HDR_SIZE + n:
+            return 0
+        args = parse_args(bytes(self.buf[HDR_SIZE:HDR_SIZE + n]))
+        if args is None:
+            return -1
+        msg = c_format(entry["fmt"], args).rstrip("\r\n")
+        if ln & LEN_TRUNCATED:
+            msg += " <truncated>"
+        self.out.write("%8u %-20s %s\n" % (tick, "[%s:%d]" % (entry["file"], entry["line"]), msg))
+        return HDR_SIZE + n
+
+    def feed(self, data):
+        self.buf += data
+        while self.buf:
+            sync = self.buf.find(SYNC)
+            if sync < 0:
+                self.text(bytes(self.buf))
+                self.buf.clear()
+                break
+            if sync > 0:
+                self.text(bytes(self.buf[:sync]))
+                del self.buf[:sync]
+            used = self.frame()
+            if used == 0:
+                break
+            if used < 0:  # 不是訊框，SYNC 當作文字
+                self.text(bytes(self.buf[:1]))
+                used = 1
+            del self.buf[:used]
+        self.out.flush()
+
+
+def open_source(argv):
+    if not argv:
+        return sys.stdin.buffer
+    if argv[0] == "--port":
+        try:
+            import serial
+        except ImportError:
+            fail("--port needs pyserial (pip install pyserial)")
+        baud = int(argv[3]) if len(argv) >= 4 and argv[2] == "--baud" else 1000000
+        return serial.Serial(argv[1], baud, timeout=0.1)
+    return open(argv[0], "rb")
+
+
+def main():
+    if len(sys.argv) >= 2 and sys.argv[1] == "table" and len(sys.argv) == 4:
+        table = build_table(sys.argv[2])
+        with open(sys.argv[3], "w", encoding="utf-8") as f:
+            json.dump({str(k): v for k, v in sorted(table.items())}, f, ensure_ascii=False, indent=1)
+        return
+    if len(sys.argv) >= 3 and sys.argv[1] == "decode":
+        decoder = Decoder(load_table(sys.argv[2]), sys.stdout)
+        src = open_source(sys.argv[3:])
+        try:
+            while True:
+                data = src.read(256) if hasattr(src, "in_waiting") else src.read1(4096)
+                if data:
+                    decoder.feed(data)
+                elif not hasattr(src, "in_waiting"):
+                    break
+        except KeyboardInterrupt:
+            pass
+        return
+    fail("usage: logdecode.py table <elf> <json> | decode <json|elf> [capture | --port <dev> [--baud <bps>]]")
+
+
+if __name__ == "__main__":
+    main()
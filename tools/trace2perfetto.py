@@ -0,0 +1,222 @@
+#!/usr/bin/env python3
+"""
+trace2perfetto.py - 將 cTrace<dump> 的輸出轉為 Chrome/Perfetto trace JSON (見 Core/Inc/trace.h)
+
+用法:
+  trace2perfetto.py <擷取檔 | -> [輸出.json]
+      擷取檔為除錯 UART 的原始擷取或 logdecode.py 的輸出，取其中最後一段完整的 dump；
+      未指定輸出時寫到 <擷取檔>.trace.json。結果可用 https://ui.perfetto.dev 或
+      chrome://tracing 開啟。
+
+dump 格式 (每行以 "TRC " 開頭，其他內容忽略):
+  TRC H <核心時脈 Hz> <事件數> <被覆寫的事件數>
+  TRC T <任務編號> <名稱>
+  TRC O <物件編號> <ucQueueType> [名稱]
+  TRC I <中斷代號> <名稱>
+  TRC S <區段代號> <名稱>
+  TRC E <DWT 週期 hex> <種類 hex> <id hex> <arg hex>
+  TRC Z
+事件種類須與 trace.h 的 TRACE_EV_xxx 一致。週期計數為 32 位元，相鄰事件的差值取模還原
+(韌體每約 16 秒插入 tick 標記，保證間隔小於一次溢位)。
+
+時間軸：
+  "Tasks"       每個任務一條軌道，顯示執行區間，佇列/信號量操作為其上的瞬間事件
+  "Interrupts"  每個中斷一條軌道，顯示進入到離開的區間
+  "Spans"       每個任務一條軌道，顯示 TRACE_SPAN_BEGIN/END 的區段
+"""
+import json
+import re
+import sys
+
+EV_TASK_IN = 1
+EV_ISR_ENTER = 2
+EV_ISR_EXIT = 3
+EV_QUEUE_SEND = 4
+EV_QUEUE_RECV = 5
+EV_QUEUE_SEND_FAIL = 6
+EV_QUEUE_RECV_FAIL = 7
+EV_QUEUE_BLOCK_SEND = 8
+EV_QUEUE_BLOCK_RECV = 9
+EV_SPAN_BEGIN = 10
+EV_SPAN_END = 11
+EV_TICK_MARK = 12
+
+QUEUE_EVENTS = {
+    EV_QUEUE_SEND: "send",
+    EV_QUEUE_RECV: "recv",
+    EV_QUEUE_SEND_FAIL: "send failed",
+    EV_QUEUE_RECV_FAIL: "recv failed",
+    EV_QUEUE_BLOCK_SEND: "block on send",
+    EV_QUEUE_BLOCK_RECV: "block on recv",
+}
+
+# FreeRTOS queue.c 的 queueQUEUE_TYPE_xxx
+QUEUE_TYPES = {0: "queue", 1: "set", 2: "mutex", 3: "counting sem", 4: "binary sem", 5: "recursive mutex"}
+
+PID_TASKS = 1
+PID_IRQ = 2
+PID_SPANS = 3
+
+LINE_RE = re.compile(r"TRC ([HTOISEZ])((?: [^\r\n]*)?)")
+
+
+def fail(msg):
+    sys.stderr.write("trace2perfetto.py: error: %s\n" % msg)
+    sys.exit(1)
+
+
+def parse_dump(text):
+    """回傳最後一段完整 dump 的 (header, tasks, objects, irqs, spans, events)"""
+    dumps = []
+    cur = None
+    for m in LINE_RE.finditer(text):
+        kind, rest = m.group(1), m.group(2).strip()
+        if kind == "H":
+            clk, count, lost = (int(x) for x in rest.split()[:3])
+            cur = {"clk": clk, "count": count, "lost": lost, "tasks": {}, "objects": {},
+                   "irqs": {}, "spans": {}, "events": []}
+        elif cur is None:
+            continue
+        elif kind == "T":
+            num, _, name = rest.partition(" ")
+            cur["tasks"][int(num)] = name
+        elif kind == "O":
+            parts = rest.split(" ", 2)
+            num, qtype = int(parts[0]), int(parts[1])
+            name = parts[2] if len(parts) > 2 and parts[2] else "%s#%d" % (QUEUE_TYPES.get(qtype, "object"), num)
+            cur["objects"][num] = name
+        elif kind == "I":
+            num, _, name = rest.partition(" ")
+            cur["irqs"][int(num)] = name
+        elif kind == "S":
+            num, _, name = rest.partition(" ")
+            cur["spans"][int(num)] = name
+        elif kind == "E":
+            cycles, ev, ident, arg = (int(x, 16) for x in rest.split()[:4])
+            cur["events"].append((cycles, ev, ident, arg))
+        elif kind == "Z":
+            dumps.append(cur)
+            cur = None
+    if not dumps:
+        fail("no complete trace dump (TRC H ... TRC Z) found")
+    d = dumps[-1]
+    if len(d["events"]) != d["count"]:
+        sys.stderr.write("trace2perfetto.py: warning: expected %d events, got %d (capture lost lines?)\n"
+                         % (d["count"], len(d["events"])))
+    return d
+
+
+def convert(d):
+    clk = d["clk"]
+    tasks, objects, irqs, spans = d["tasks"], d["objects"], d["irqs"], d["spans"]
+    out = []
+
+    def meta(pid, tid, kind, name, sort=None):
+        out.append({"ph": "M", "pid": pid, "tid": tid, "name": kind, "args": {"name": name}})
+        if sort is not None:
+            out.append({"ph": "M", "pid": pid, "tid": tid, "name": "thread_sort_index", "args": {"sort_index": sort}})
+
+    def task_name(num):
+        return tasks.get(num, "task#%d" % num)
+
+    meta(PID_TASKS, 0, "process_name", "Tasks")
+    meta(PID_IRQ, 0, "process_name", "Interrupts")
+    meta(PID_SPANS, 0, "process_name", "Spans")
+
+    used_tasks = set()
+    used_irqs = set()
+    used_span_tasks = set()
+
+    # 週期差值取模還原為連續時間 (微秒)
+    ts = []
+    t = 0
+    prev = None
+    for cycles, _, _, _ in d["events"]:
+        if prev is not None:
+            t += (cycles - prev) & 0xFFFFFFFF
+        prev = cycles
+        ts.append(t * 1e6 / clk)
+
+    cur_task = None
+    task_start = None
+    isr_stack = []           # [(irq, 開始時間)]
+    span_open = {}           # (任務, 區段) -> [(開始時間, arg)]
+
+    for (cycles, ev, ident, arg), now in zip(d["events"], ts):
+        if ev == EV_TASK_IN:
+            if cur_task is not None:
+                out.append({"ph": "X", "pid": PID_TASKS, "tid": cur_task, "ts": task_start,
+                            "dur": now - task_start, "name": task_name(cur_task)})
+            cur_task, task_start = ident, now
+            used_tasks.add(ident)
+        elif ev == EV_ISR_ENTER:
+            isr_stack.append((ident, now))
+            used_irqs.add(ident)
+        elif ev == EV_ISR_EXIT:
+            # 從最內層找對應的進入事件；記錄開始前就已進入的中斷沒有區間
+            for i in range(len(isr_stack) - 1, -1, -1):
+                if isr_stack[i][0] == ident:
+                    start = isr_stack[i][1]
+                    del isr_stack[i:]
+                    out.append({"ph": "X", "pid": PID_IRQ, "tid": ident + 1, "ts": start,
+                                "dur": now - start, "name": irqs.get(ident, "irq#%d" % ident)})
+                    break
+        elif ev in QUEUE_EVENTS:
+            name = "%s %s" % (QUEUE_EVENTS[ev], objects.get(ident, "object#%d" % ident))
+            if isr_stack:
+                pid, tid = PID_IRQ, isr_stack[-1][0] + 1
+            else:
+                pid, tid = PID_TASKS, cur_task if cur_task is not None else 0
+            out.append({"ph": "i", "s": "t", "pid": pid, "tid": tid, "ts": now, "name": name,
+                        "args": {"waiting": arg}})
+        elif ev == EV_SPAN_BEGIN:
+            owner = cur_task if cur_task is not None else 0
+            span_open.setdefault((owner, ident), []).append((now, arg))
+        elif ev == EV_SPAN_END:
+            owner = cur_task if cur_task is not None else 0
+            stack = span_open.get((owner, ident))
+            if stack:
+                start, barg = stack.pop()
+                out.append({"ph": "X", "pid": PID_SPANS, "tid": owner, "ts": start, "dur": now - start,
+                            "name": spans.get(ident, "span#%d" % ident), "args": {"arg": barg}})
+                used_span_tasks.add(owner)
+        elif ev == EV_TICK_MARK:
+            pass
+        else:
+            sys.stderr.write("trace2perfetto.py: warning: unknown event type %d\n" % ev)
+
+    if cur_task is not None and ts:
+        out.append({"ph": "X", "pid": PID_TASKS, "tid": cur_task, "ts": task_start,
+                    "dur": ts[-1] - task_start, "name": task_name(cur_task)})
+
+    for num in sorted(used_tasks | {0}):
+        meta(PID_TASKS, num, "thread_name", task_name(num) if num else "(unknown)", num)
+    for num in sorted(used_irqs):
+        meta(PID_IRQ, num + 1, "thread_name", irqs.get(num, "irq#%d" % num), num)
+    for num in sorted(used_span_tasks):
+        meta(PID_SPANS, num, "thread_name", task_name(num) if num else "(unknown)", num)
+
+    return {"traceEvents": out, "displayTimeUnit": "ns",
+            "otherData": {"coreClockHz": clk, "events": len(d["events"]), "lostEvents": d["lost"]}}
+
+
+def main():
+    if len(sys.argv) not in (2, 3):
+        fail("usage: trace2perfetto.py <capture | -> [out.json]")
+    src = sys.argv[1]
+    if src == "-":
+        data = sys.stdin.buffer.read()
+    else:
+        with open(src, "rb") as f:
+            data = f.read()
+    trace = convert(parse_dump(data.decode("utf-8", "replace")))
+    dst = sys.argv[2] if len(sys.argv) == 3 else ("trace.json" if src == "-" else src + ".trace.json")
+    with open(dst, "w", encoding="utf-8") as f:
+        json.dump(trace, f)
+    sys.stderr.write("%s: %d events, %d lost, %.3f ms\n" % (
+        dst, len(trace["traceEvents"]), trace["otherData"]["lostEvents"],
+        max((e["ts"] + e.get("dur", 0) for e in trace["traceEvents"] if "ts" in e), default=0) / 1000))
+
+
+if __name__ == "__main__":
+    main()